@@ -0,0 +1,142 @@
+/*--------------------------------------------------------------------*/
+/* benchbatch.c                                                       */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function. */
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of times every key is looked up by each method. */
+enum {ROUNDS = 4};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, then look up
+   every key in a random order, first with SymTable_get() and then
+   with SymTable_getBatch(), and write the cost per lookup of each to
+   stdout. As always, argc is the command-line argument count and argv
+   contains the command-line arguments. argv[1] is the number of
+   bindings, and the optional argv[2] is the batch size (default 256).
+   Exit with EXIT_FAILURE if an argument is missing or not a positive
+   number, or if memory is insufficient. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   const char **apcOrder;
+   void **apvOut;
+   const char *pcTemp;
+   double dStart;
+   double dGetNs;
+   double dBatchNs;
+   size_t uCheck = 0;
+   int iBindingCount;
+   int iBatchSize = 256;
+   int iCount;
+   int iRound;
+   int i;
+   int j;
+
+   if ((argc != 2 && argc != 3) ||
+       sscanf(argv[1], "%d", &iBindingCount) != 1 ||
+       iBindingCount <= 0 ||
+       (argc == 3 && (sscanf(argv[2], "%d", &iBatchSize) != 1 ||
+                      iBatchSize <= 0)))
+   {
+      fprintf(stderr, "Usage: %s bindingcount [batchsize]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   pcKeys = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH);
+   apcOrder = (const char**)
+      malloc(sizeof(const char*) * (size_t)iBindingCount);
+   apvOut = (void**)malloc(sizeof(void*) * (size_t)iBatchSize);
+   oSymTable = SymTable_new();
+   if (pcKeys == NULL || apcOrder == NULL || apvOut == NULL ||
+       oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH, "key%d", i);
+      apcOrder[i] = pcKeys + (size_t)i * MAX_KEY_LENGTH;
+      if (! SymTable_put(oSymTable, apcOrder[i], apcOrder[i]))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   /* Shuffle the lookup order so that consecutive lookups touch
+      unrelated memory, as the symbols of a request do. */
+   srand(1);
+   for (i = iBindingCount - 1; i > 0; i--)
+   {
+      j = rand() % (i + 1);
+      pcTemp = apcOrder[i];
+      apcOrder[i] = apcOrder[j];
+      apcOrder[j] = pcTemp;
+   }
+
+   dStart = getNanoseconds();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iBindingCount; i++)
+         uCheck += (size_t)SymTable_get(oSymTable, apcOrder[i]);
+   dGetNs =
+      (getNanoseconds() - dStart) / ((double)ROUNDS * iBindingCount);
+
+   dStart = getNanoseconds();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iBindingCount; i += iCount)
+      {
+         iCount = iBindingCount - i;
+         if (iCount > iBatchSize)
+            iCount = iBatchSize;
+         SymTable_getBatch(oSymTable, apcOrder + i, (size_t)iCount,
+            apvOut);
+         for (j = 0; j < iCount; j++)
+            uCheck += (size_t)apvOut[j];
+      }
+   dBatchNs =
+      (getNanoseconds() - dStart) / ((double)ROUNDS * iBindingCount);
+
+   printf("%s: %d bindings, batches of %d\n", argv[0], iBindingCount,
+      iBatchSize);
+   printf("get       %8.1f ns/op\n", dGetNs);
+   printf("getBatch  %8.1f ns/op  (%.2fx)\n", dBatchNs,
+      dGetNs / dBatchNs);
+
+   /* Print the combined results so that no work can be skipped. */
+   printf("check %lx\n", (unsigned long)uCheck);
+
+   SymTable_free(oSymTable);
+   free(apvOut);
+   free(apcOrder);
+   free(pcKeys);
+   return 0;
+}
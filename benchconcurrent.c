@@ -0,0 +1,230 @@
+/*--------------------------------------------------------------------*/
+/* benchconcurrent.c                                                  */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() and the pthread functions are POSIX functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings that readers look up, all always present.
+   It lies just under a power of two, so that the writer's puts cross
+   the point where the table doubles. */
+enum {KEY_COUNT = 65000};
+
+/* The number of bindings that the writer puts and removes over and
+   over, which readers also look up. */
+enum {CHURN_COUNT = 1000};
+
+/* The number of lookups of each reader. */
+enum {READS = 2000000};
+
+/* The largest number of readers. */
+enum {MAX_READERS = 64};
+
+/* The longest key, with its terminating null character. */
+enum {MAX_KEY_LENGTH = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* Built with -DBENCH_GLOBAL_LOCK, every call is made under one global
+   mutex, which is how a table without its own synchronization must be
+   shared. */
+#ifdef BENCH_GLOBAL_LOCK
+static pthread_mutex_t sGlobalLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCKED(call) \
+   (pthread_mutex_lock(&sGlobalLock), (call), \
+    pthread_mutex_unlock(&sGlobalLock))
+#else
+#define LOCKED(call) ((void)(call))
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The table, its keys, and the writer's stop flag, shared by every
+   thread. */
+static SymTable_T oSymTable;
+static char acKeys[KEY_COUNT][MAX_KEY_LENGTH];
+static char acChurnKeys[CHURN_COUNT][MAX_KEY_LENGTH];
+static int iStop;
+
+/* The number of wrong lookup results, which must stay 0. */
+static long lErrors;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up READS keys, chosen pseudo-randomly from a seed at pvSeed, and
+   check every result: a key of acKeys must be bound to itself, and a
+   key of acChurnKeys must be bound to itself or unbound. Return
+   NULL. */
+
+static void *readKeys(void *pvSeed)
+{
+   unsigned long ulState = *(unsigned long*)pvSeed;
+   const char *pcKey;
+   void *pvValue;
+   long lMyErrors = 0;
+   int i;
+
+   for (i = 0; i < READS; i++)
+   {
+      ulState = ulState * 6364136223846793005UL + 1442695040888963407UL;
+      if ((ulState >> 33) % 16 == 0)
+      {
+         pcKey = acChurnKeys[(ulState >> 40) % CHURN_COUNT];
+         LOCKED(pvValue = SymTable_get(oSymTable, pcKey));
+         if (pvValue != NULL && pvValue != pcKey)
+            lMyErrors++;
+      }
+      else
+      {
+         pcKey = acKeys[(ulState >> 33) % KEY_COUNT];
+         LOCKED(pvValue = SymTable_get(oSymTable, pcKey));
+         if (pvValue != pcKey)
+            lMyErrors++;
+      }
+   }
+
+   __atomic_fetch_add(&lErrors, lMyErrors, __ATOMIC_RELAXED);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put and remove the keys of acChurnKeys until iStop is set, then
+   write the number of operations to the long at pvCount. The puts of
+   every round double the table, and SymTable_shrinkToFit after the
+   removals halves it again, so readers also race with two resizes per
+   round. Return NULL. */
+
+static void *writeKeys(void *pvCount)
+{
+   long lCount = 0;
+   int i;
+
+   while (! __atomic_load_n(&iStop, __ATOMIC_RELAXED))
+   {
+      for (i = 0; i < CHURN_COUNT; i++)
+         LOCKED(SymTable_put(oSymTable, acChurnKeys[i],
+            acChurnKeys[i]));
+      for (i = 0; i < CHURN_COUNT; i++)
+         LOCKED(SymTable_remove(oSymTable, acChurnKeys[i]));
+      LOCKED(SymTable_shrinkToFit(oSymTable));
+      lCount += 2 * CHURN_COUNT;
+   }
+
+   *(long*)pvCount = lCount;
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stdout the lookup throughput of 1, 2, 4, ... readers, up to
+   argv[1] readers, that share a SymTable with one writer, and the
+   writer's throughput meanwhile. As always, argc is the command-line
+   argument count and argv contains the command-line arguments. Exit
+   with EXIT_FAILURE if the argument is missing or out of range, if
+   memory is insufficient, or if a lookup returns a wrong value.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   pthread_t aReaders[MAX_READERS];
+   unsigned long aulSeeds[MAX_READERS];
+   pthread_t writer;
+   long lWrites;
+   int iMaxReaders;
+   int iReaders;
+   int i;
+   double dStart;
+   double dSeconds;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iMaxReaders) != 1 ||
+       iMaxReaders <= 0 || iMaxReaders > MAX_READERS)
+   {
+      fprintf(stderr, "Usage: %s readercount (1 to %d)\n", argv[0],
+         MAX_READERS);
+      exit(EXIT_FAILURE);
+   }
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKeys[i], "key%d", i);
+      if (! SymTable_put(oSymTable, acKeys[i], acKeys[i]))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   for (i = 0; i < CHURN_COUNT; i++)
+      sprintf(acChurnKeys[i], "churn%d", i);
+
+   printf("%s\n", argv[0]);
+   printf("readers  get Mops/s  put+remove Mops/s\n");
+
+   for (iReaders = 1; iReaders <= iMaxReaders; iReaders *= 2)
+   {
+      iStop = 0;
+      if (pthread_create(&writer, NULL, writeKeys, &lWrites) != 0)
+      {
+         fprintf(stderr, "Cannot create thread\n");
+         exit(EXIT_FAILURE);
+      }
+
+      dStart = getNanoseconds();
+      for (i = 0; i < iReaders; i++)
+      {
+         aulSeeds[i] = (unsigned long)i + 1;
+         if (pthread_create(&aReaders[i], NULL, readKeys, &aulSeeds[i])
+             != 0)
+         {
+            fprintf(stderr, "Cannot create thread\n");
+            exit(EXIT_FAILURE);
+         }
+      }
+      for (i = 0; i < iReaders; i++)
+         pthread_join(aReaders[i], NULL);
+      dSeconds = (getNanoseconds() - dStart) / 1e9;
+
+      __atomic_store_n(&iStop, 1, __ATOMIC_RELAXED);
+      pthread_join(writer, NULL);
+
+      printf("%7d  %10.2f  %17.2f\n", iReaders,
+         (double)iReaders * READS / dSeconds / 1e6,
+         (double)lWrites / dSeconds / 1e6);
+   }
+
+   SymTable_free(oSymTable);
+
+   if (lErrors != 0)
+   {
+      fprintf(stderr, "%ld wrong lookups\n", lErrors);
+      exit(EXIT_FAILURE);
+   }
+   return 0;
+}
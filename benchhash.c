@@ -0,0 +1,135 @@
+/*--------------------------------------------------------------------*/
+/* benchhash.c                                                        */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function. */
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#include "strhash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of distinct keys generated for each key length. */
+enum {KEY_COUNT = 4096};
+
+/* The number of times each key is hashed or looked up. */
+enum {ROUNDS = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill the KEY_COUNT strings at apcKeys with distinct keys of
+   uKeyLength characters. Like identifiers in a program, the keys share
+   a long common prefix and differ in their last characters. Return 1
+   if successful, or 0 if insufficient memory is available. */
+
+static int makeKeys(char **apcKeys, size_t uKeyLength)
+{
+   size_t uKey;
+   size_t u;
+   size_t uIndex;
+
+   for (uKey = 0; uKey < KEY_COUNT; uKey++)
+   {
+      apcKeys[uKey] = (char*)malloc(uKeyLength + 1);
+      if (apcKeys[uKey] == NULL)
+         return 0;
+      memset(apcKeys[uKey], '_', uKeyLength);
+      apcKeys[uKey][uKeyLength] = '\0';
+
+      /* Write the key's index in base 26 at the end of the key. */
+      for (u = uKeyLength, uIndex = uKey; u > 0 && uIndex > 0;
+           u--, uIndex /= 26)
+         apcKeys[uKey][u - 1] = (char)('a' + uIndex % 26);
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stdout the cost of hashing, and of looking up, keys of
+   various lengths with the hash function linked into this program. As
+   always, argc is the command-line argument count and argv contains
+   the command-line arguments. Exit with EXIT_FAILURE if memory is
+   insufficient. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   static const size_t auKeyLengths[] = {4, 8, 16, 32, 64, 128, 256,
+                                         1024};
+   char *apcKeys[KEY_COUNT];
+   SymTable_T oSymTable;
+   size_t uLengthIndex;
+   size_t uKeyLength;
+   size_t uKey;
+   size_t uCheck = 0;
+   int iRound;
+   double dStart;
+   double dHashNs;
+   double dGetNs;
+
+   (void)argc;
+
+   printf("%s\n", argv[0]);
+   printf("keylen  hash ns/key  hash GB/s  get ns/op\n");
+
+   for (uLengthIndex = 0;
+        uLengthIndex < sizeof(auKeyLengths) / sizeof(auKeyLengths[0]);
+        uLengthIndex++)
+   {
+      uKeyLength = auKeyLengths[uLengthIndex];
+      oSymTable = SymTable_new();
+      if (oSymTable == NULL || ! makeKeys(apcKeys, uKeyLength))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+
+      /* Time the hash function alone. */
+      dStart = getNanoseconds();
+      for (iRound = 0; iRound < ROUNDS; iRound++)
+         for (uKey = 0; uKey < KEY_COUNT; uKey++)
+            uCheck ^= StrHash_hash(apcKeys[uKey], (size_t)iRound);
+      dHashNs = (getNanoseconds() - dStart) / (ROUNDS * KEY_COUNT);
+
+      /* Time successful lookups, which hash and compare each key. */
+      for (uKey = 0; uKey < KEY_COUNT; uKey++)
+         if (! SymTable_put(oSymTable, apcKeys[uKey], apcKeys[uKey]))
+         {
+            fprintf(stderr, "Insufficient memory\n");
+            exit(EXIT_FAILURE);
+         }
+      dStart = getNanoseconds();
+      for (iRound = 0; iRound < ROUNDS; iRound++)
+         for (uKey = 0; uKey < KEY_COUNT; uKey++)
+            uCheck ^= (size_t)SymTable_get(oSymTable, apcKeys[uKey]);
+      dGetNs = (getNanoseconds() - dStart) / (ROUNDS * KEY_COUNT);
+
+      printf("%6lu  %11.1f  %9.2f  %9.1f\n", (unsigned long)uKeyLength,
+         dHashNs, (double)uKeyLength / dHashNs, dGetNs);
+
+      SymTable_free(oSymTable);
+      for (uKey = 0; uKey < KEY_COUNT; uKey++)
+         free(apcKeys[uKey]);
+   }
+
+   /* Print the combined results so that no work can be skipped. */
+   printf("check %lx\n", (unsigned long)uCheck);
+   return 0;
+}
@@ -0,0 +1,160 @@
+/*--------------------------------------------------------------------*/
+/* benchmap.c                                                         */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() and sysconf() are POSIX functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings walked. */
+enum {KEY_COUNT = 1000000};
+
+/* The number of walks of each configuration. */
+enum {ROUNDS = 10};
+
+/* The largest number of threads. */
+enum {MAX_THREADS = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* The per-thread state of a walk, alone on a cache line so that the
+   threads do not share the lines that they write. */
+
+struct Sum {
+   unsigned long ulSum;
+   char acPadding[64 - sizeof(unsigned long)];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the length of pcKey and the unsigned long at pvValue to the sum
+   of the calling thread at pvExtra. */
+
+static void addBinding(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   unsigned long ulLength = 0;
+   while (pcKey[ulLength] != '\0')
+      ulLength++;
+   ((struct Sum*)pvExtra)->ulSum += ulLength + *(unsigned long*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stdout the throughput of SymTable_map and of
+   SymTable_mapParallel on 1, 2, 4, ... threads, up to the number of
+   online processors or up to the optional argv[1] threads, summing
+   every binding of a table of KEY_COUNT bindings into per-thread
+   sums. As always, argc is the command-line argument count and argv
+   contains the command-line arguments. Exit with EXIT_FAILURE if the
+   argument is not a number from 1 to MAX_THREADS, if memory is
+   insufficient, or if a sum is wrong. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   static struct Sum asSums[MAX_THREADS];
+   static unsigned long aulValues[KEY_COUNT];
+   void *apvExtras[MAX_THREADS];
+   SymTable_T oSymTable;
+   char acKey[32];
+   unsigned long ulExpected = 0;
+   unsigned long ulSum;
+   int iMaxThreads;
+   int iThreads;
+   int iRound;
+   int i;
+   double dStart;
+   double dSeconds;
+
+   iMaxThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   if (iMaxThreads < 1)
+      iMaxThreads = 1;
+   if (iMaxThreads > MAX_THREADS)
+      iMaxThreads = MAX_THREADS;
+   if (argc > 2 ||
+       (argc == 2 && (sscanf(argv[1], "%d", &iMaxThreads) != 1 ||
+                      iMaxThreads <= 0 || iMaxThreads > MAX_THREADS)))
+   {
+      fprintf(stderr, "Usage: %s [threadcount (1 to %d)]\n", argv[0],
+         MAX_THREADS);
+      exit(EXIT_FAILURE);
+   }
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      aulValues[i] = (unsigned long)i;
+      ulExpected += (unsigned long)sprintf(acKey, "key%d", i)
+                    + aulValues[i];
+      if (! SymTable_put(oSymTable, acKey, &aulValues[i]))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   for (i = 0; i < MAX_THREADS; i++)
+      apvExtras[i] = &asSums[i];
+
+   printf("%s\n", argv[0]);
+   printf("threads  Mbindings/s\n");
+
+   /* Thread count 0 stands for SymTable_map. */
+   for (iThreads = 0; iThreads <= iMaxThreads;
+        iThreads = iThreads == 0 ? 1 : iThreads * 2)
+   {
+      dStart = getNanoseconds();
+      for (iRound = 0; iRound < ROUNDS; iRound++)
+      {
+         for (i = 0; i < MAX_THREADS; i++)
+            asSums[i].ulSum = 0;
+         if (iThreads == 0)
+            SymTable_map(oSymTable, addBinding, &asSums[0]);
+         else
+            SymTable_mapParallel(oSymTable, addBinding, apvExtras,
+               (size_t)iThreads);
+
+         ulSum = 0;
+         for (i = 0; i < MAX_THREADS; i++)
+            ulSum += asSums[i].ulSum;
+         if (ulSum != ulExpected)
+         {
+            fprintf(stderr, "Wrong sum\n");
+            exit(EXIT_FAILURE);
+         }
+      }
+      dSeconds = (getNanoseconds() - dStart) / 1e9;
+
+      if (iThreads == 0)
+         printf("    map");
+      else
+         printf("%7d", iThreads);
+      printf("  %11.2f\n",
+         (double)KEY_COUNT * ROUNDS / dSeconds / 1e6);
+   }
+
+   SymTable_free(oSymTable);
+   return 0;
+}
@@ -0,0 +1,164 @@
+/*--------------------------------------------------------------------*/
+/* benchordered.c                                                     */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() and getrusage() are POSIX functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings. */
+enum {KEY_COUNT = 1000000};
+
+/* The longest key, with its terminating null character. */
+enum {MAX_KEY_LENGTH = 64};
+
+/* The number of lookups of each key, and of prefix walks. */
+enum {ROUNDS = 4};
+enum {PREFIX_WALKS = 20};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the peak resident set size of the process in kilobytes. */
+
+static long getPeakKilobytes(void)
+{
+   struct rusage sUsage;
+   getrusage(RUSAGE_SELF, &sUsage);
+   return sUsage.ru_maxrss;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the long at pvExtra. pcKey and pvValue are unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(long*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stdout the put and get throughput of a table of KEY_COUNT
+   identifier-like keys that share long prefixes, the memory that the
+   table adds to the process, and the time of a SymTable_mapPrefix
+   walk of 1000 bindings. argc and argv are unused. Exit with
+   EXIT_FAILURE if memory is insufficient or a result is wrong.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   char *pcKeys;
+   size_t uKeyBytes = 0;
+   long lBaseKilobytes;
+   long lCount;
+   double dStart;
+   double dPutSeconds;
+   double dGetSeconds;
+   double dPrefixSeconds;
+   int iErrors = 0;
+   int iRound;
+   int i;
+
+   (void)argc;
+
+   pcKeys = (char*)malloc((size_t)KEY_COUNT * MAX_KEY_LENGTH);
+   if (pcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   /* 1000 bindings share each prefix up to the last dot. */
+   for (i = 0; i < KEY_COUNT; i++)
+      uKeyBytes += (size_t)sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH,
+         "compiler.frontend.module%d.function%d.local%d",
+         i / 100000, i / 1000 % 100, i % 1000) + 1;
+
+   /* The keys are touched before the baseline, so that only the
+      table's memory is measured. */
+   lBaseKilobytes = getPeakKilobytes();
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   dStart = getNanoseconds();
+   for (i = 0; i < KEY_COUNT; i++)
+      if (! SymTable_put(oSymTable, pcKeys + (size_t)i * MAX_KEY_LENGTH,
+                         pcKeys + (size_t)i * MAX_KEY_LENGTH))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   dPutSeconds = (getNanoseconds() - dStart) / 1e9;
+
+   dStart = getNanoseconds();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < KEY_COUNT; i++)
+         if (SymTable_get(oSymTable, pcKeys + (size_t)i * MAX_KEY_LENGTH)
+             != pcKeys + (size_t)i * MAX_KEY_LENGTH)
+            iErrors++;
+   dGetSeconds = (getNanoseconds() - dStart) / 1e9;
+
+   dStart = getNanoseconds();
+   for (i = 0; i < PREFIX_WALKS; i++)
+   {
+      lCount = 0;
+      if (! SymTable_mapPrefix(oSymTable,
+               "compiler.frontend.module7.function42.", countBinding,
+               &lCount))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      if (lCount != 1000)
+         iErrors++;
+   }
+   dPrefixSeconds = (getNanoseconds() - dStart) / 1e9;
+
+   if (iErrors != 0)
+   {
+      fprintf(stderr, "%d wrong results\n", iErrors);
+      exit(EXIT_FAILURE);
+   }
+
+   printf("%s\n", argv[0]);
+   printf("put Mops/s  get Mops/s  table MB  key MB  "
+          "prefix walk us\n");
+   printf("%10.2f  %10.2f  %8.1f  %6.1f  %14.1f\n",
+      KEY_COUNT / dPutSeconds / 1e6,
+      (double)KEY_COUNT * ROUNDS / dGetSeconds / 1e6,
+      (double)(getPeakKilobytes() - lBaseKilobytes) / 1024.0,
+      (double)uKeyBytes / 1048576.0,
+      dPrefixSeconds / PREFIX_WALKS * 1e6);
+
+   SymTable_free(oSymTable);
+   free(pcKeys);
+   return 0;
+}
@@ -0,0 +1,111 @@
+/*--------------------------------------------------------------------*/
+/* benchresize.c                                                      */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function. */
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the doubles at pvFirst and pvSecond for qsort(). */
+
+static int compareDoubles(const void *pvFirst, const void *pvSecond)
+{
+   double dFirst = *(const double*)pvFirst;
+   double dSecond = *(const double*)pvSecond;
+   return (dFirst > dSecond) - (dFirst < dSecond);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a new SymTable object, timing each
+   SymTable_put() call, and write the worst-case and percentile
+   per-put latencies to stdout. As always, argc is the command-line
+   argument count and argv contains the command-line arguments.
+   argv[1] is the number of bindings to put. If argv[2] is "reserve",
+   the SymTable object is created with room for all of them. Exit with
+   EXIT_FAILURE if argv[1] is missing or not a positive number, if
+   argv[2] is anything else, or if memory is insufficient. Otherwise
+   return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   double *pdLatencies;
+   double dStart;
+   double dTotal = 0.0;
+   int iBindingCount;
+   int iWorst = 0;
+   int iReserve;
+   int i;
+
+   iReserve = argc == 3 && strcmp(argv[2], "reserve") == 0;
+   if ((argc != 2 && ! iReserve) ||
+       sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s bindingcount [reserve]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   pdLatencies = (double*)malloc(sizeof(double) * (size_t)iBindingCount);
+   if (iReserve)
+      oSymTable = SymTable_newWithCapacity((size_t)iBindingCount);
+   else
+      oSymTable = SymTable_new();
+   if (pdLatencies == NULL || oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      dStart = getNanoseconds();
+      if (! SymTable_put(oSymTable, acKey, NULL))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      pdLatencies[i] = getNanoseconds() - dStart;
+      dTotal += pdLatencies[i];
+      if (pdLatencies[i] > pdLatencies[iWorst])
+         iWorst = i;
+   }
+
+   printf("%s: %d puts, worst %.0f ns (put #%d), mean %.1f ns\n",
+      argv[0], iBindingCount, pdLatencies[iWorst], iWorst,
+      dTotal / iBindingCount);
+
+   qsort(pdLatencies, (size_t)iBindingCount, sizeof(double),
+      compareDoubles);
+   printf("%s: p50 %.0f ns, p99 %.0f ns, p99.9 %.0f ns\n", argv[0],
+      pdLatencies[(size_t)(iBindingCount * 0.5)],
+      pdLatencies[(size_t)(iBindingCount * 0.99)],
+      pdLatencies[(size_t)(iBindingCount * 0.999)]);
+
+   SymTable_free(oSymTable);
+   free(pdLatencies);
+   return 0;
+}
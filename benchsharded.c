@@ -0,0 +1,233 @@
+/*--------------------------------------------------------------------*/
+/* benchsharded.c                                                     */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime(), sysconf() and the pthread functions are POSIX
+   functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings that each thread puts. */
+enum {KEYS_PER_THREAD = 200000};
+
+/* The number of times each thread looks up each of its keys. */
+enum {ROUNDS = 4};
+
+/* The largest number of threads. */
+enum {MAX_THREADS = 256};
+
+/* The longest key, with its terminating null character. */
+enum {MAX_KEY_LENGTH = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* Built with -DBENCH_GLOBAL_LOCK, every call is made under one global
+   mutex, which is how a table without its own synchronization must be
+   shared. */
+#ifdef BENCH_GLOBAL_LOCK
+static pthread_mutex_t sGlobalLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCKED(call) \
+   (pthread_mutex_lock(&sGlobalLock), (call), \
+    pthread_mutex_unlock(&sGlobalLock))
+#else
+#define LOCKED(call) ((void)(call))
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The table that every thread shares, and the keys of every thread,
+   KEYS_PER_THREAD apart. */
+static SymTable_T oSymTable;
+static char *pcKeys;
+
+/* The number of failed puts and wrong lookup results, which must stay
+   0. */
+static long lErrors;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of key number iKey of thread number iThread. */
+
+static char *getKey(int iThread, int iKey)
+{
+   return pcKeys +
+      ((size_t)iThread * KEYS_PER_THREAD + (size_t)iKey)
+      * MAX_KEY_LENGTH;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put every key of the thread whose number is at piThread, bound to
+   itself. Return NULL. */
+
+static void *putKeys(void *piThread)
+{
+   int iThread = *(int*)piThread;
+   int iSuccessful;
+   long lMyErrors = 0;
+   int i;
+
+   for (i = 0; i < KEYS_PER_THREAD; i++)
+   {
+      LOCKED(iSuccessful = SymTable_put(oSymTable, getKey(iThread, i),
+         getKey(iThread, i)));
+      if (! iSuccessful)
+         lMyErrors++;
+   }
+
+   __atomic_fetch_add(&lErrors, lMyErrors, __ATOMIC_RELAXED);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up every key of the thread whose number is at piThread ROUNDS
+   times, checking that each is bound to itself. Return NULL. */
+
+static void *getKeys(void *piThread)
+{
+   int iThread = *(int*)piThread;
+   void *pvValue;
+   long lMyErrors = 0;
+   int iRound;
+   int i;
+
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < KEYS_PER_THREAD; i++)
+      {
+         LOCKED(pvValue = SymTable_get(oSymTable, getKey(iThread, i)));
+         if (pvValue != getKey(iThread, i))
+            lMyErrors++;
+      }
+
+   __atomic_fetch_add(&lErrors, lMyErrors, __ATOMIC_RELAXED);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run pfRun in iThreads threads, numbered 0 to iThreads - 1, and
+   return the wall-clock time in seconds until all of them end. Exit
+   with EXIT_FAILURE if a thread cannot be created. */
+
+static double runThreads(void *(*pfRun)(void *), int iThreads)
+{
+   static pthread_t aThreads[MAX_THREADS];
+   static int aiNumbers[MAX_THREADS];
+   double dStart;
+   int i;
+
+   dStart = getNanoseconds();
+   for (i = 0; i < iThreads; i++)
+   {
+      aiNumbers[i] = i;
+      if (pthread_create(&aThreads[i], NULL, pfRun, &aiNumbers[i])
+          != 0)
+      {
+         fprintf(stderr, "Cannot create thread\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   for (i = 0; i < iThreads; i++)
+      pthread_join(aThreads[i], NULL);
+   return (getNanoseconds() - dStart) / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stdout the put and the get throughput of 1, 2, 3, ...
+   threads that share one SymTable, each putting and getting its own
+   keys, up to the number of online processors or up to the optional
+   argv[1] threads. As always, argc is the command-line argument count
+   and argv contains the command-line arguments. Exit with EXIT_FAILURE
+   if the argument is not a number from 1 to MAX_THREADS, if memory is
+   insufficient, or if a put fails or a lookup returns a wrong value.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iMaxThreads;
+   int iThreads;
+   int iThread;
+   int i;
+   double dPutSeconds;
+   double dGetSeconds;
+
+   iMaxThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   if (iMaxThreads < 1)
+      iMaxThreads = 1;
+   if (iMaxThreads > MAX_THREADS)
+      iMaxThreads = MAX_THREADS;
+   if (argc > 2 ||
+       (argc == 2 && (sscanf(argv[1], "%d", &iMaxThreads) != 1 ||
+                      iMaxThreads <= 0 || iMaxThreads > MAX_THREADS)))
+   {
+      fprintf(stderr, "Usage: %s [threadcount (1 to %d)]\n", argv[0],
+         MAX_THREADS);
+      exit(EXIT_FAILURE);
+   }
+
+   pcKeys = (char*)malloc((size_t)iMaxThreads * KEYS_PER_THREAD
+                          * MAX_KEY_LENGTH);
+   if (pcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (iThread = 0; iThread < iMaxThreads; iThread++)
+      for (i = 0; i < KEYS_PER_THREAD; i++)
+         sprintf(getKey(iThread, i), "t%d_%d", iThread, i);
+
+   printf("%s\n", argv[0]);
+   printf("threads  put Mops/s  get Mops/s\n");
+
+   for (iThreads = 1; iThreads <= iMaxThreads; iThreads++)
+   {
+      oSymTable = SymTable_new();
+      if (oSymTable == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+
+      dPutSeconds = runThreads(putKeys, iThreads);
+      dGetSeconds = runThreads(getKeys, iThreads);
+
+      printf("%7d  %10.2f  %10.2f\n", iThreads,
+         (double)iThreads * KEYS_PER_THREAD / dPutSeconds / 1e6,
+         (double)iThreads * KEYS_PER_THREAD * ROUNDS / dGetSeconds
+         / 1e6);
+
+      SymTable_free(oSymTable);
+   }
+
+   free(pcKeys);
+
+   if (lErrors != 0)
+   {
+      fprintf(stderr, "%ld failed puts or wrong lookups\n", lErrors);
+      exit(EXIT_FAILURE);
+   }
+   return 0;
+}
@@ -0,0 +1,132 @@
+/*--------------------------------------------------------------------*/
+/* benchsmall.c                                                       */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function. */
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The largest number of bindings measured. */
+enum {MAX_BINDINGS = 64};
+
+/* The number of tables built for each number of bindings. */
+enum {TABLES = 20000};
+
+/* The number of times every key of a table is looked up. */
+enum {ROUNDS = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build TABLES tables of various small sizes with the SymTable
+   implementation linked into this program, look up each of their keys
+   ROUNDS times, and write to stdout the cost of a build (per binding)
+   and of a successful and an unsuccessful lookup. Like the local names
+   of a function, the keys are short and differ early. Comparing the
+   output of the builds with different SYMTABLE_SMALL_CAPACITY values
+   locates the size at which hashing starts to pay. As always, argc is
+   the command-line argument count and argv contains the command-line
+   arguments. Exit with EXIT_FAILURE if memory is insufficient.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   static const int aiSizes[] = {1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64};
+   enum {MAX_KEY_LENGTH = 16};
+
+   char acKeys[MAX_BINDINGS + 1][MAX_KEY_LENGTH];
+   SymTable_T oSymTable;
+   size_t uSizeIndex;
+   size_t uCheck = 0;
+   int iSize;
+   int iTable;
+   int iRound;
+   int i;
+   double dStart;
+   double dPutNs;
+   double dHitNs;
+   double dMissNs;
+
+   (void)argc;
+
+   /* Key MAX_BINDINGS is never put, so looking it up always misses. */
+   for (i = 0; i <= MAX_BINDINGS; i++)
+      sprintf(acKeys[i], "%c%dvar", 'a' + i % 26, i);
+
+   printf("%s\n", argv[0]);
+   printf("bindings  put ns/op  hit ns/op  miss ns/op\n");
+
+   for (uSizeIndex = 0;
+        uSizeIndex < sizeof(aiSizes) / sizeof(aiSizes[0]);
+        uSizeIndex++)
+   {
+      iSize = aiSizes[uSizeIndex];
+      dPutNs = 0.0;
+      dHitNs = 0.0;
+      dMissNs = 0.0;
+
+      for (iTable = 0; iTable < TABLES; iTable++)
+      {
+         /* Time building the table, including creating and freeing
+            it, as a scope's table is. */
+         dStart = getNanoseconds();
+         oSymTable = SymTable_new();
+         if (oSymTable == NULL)
+         {
+            fprintf(stderr, "Insufficient memory\n");
+            exit(EXIT_FAILURE);
+         }
+         for (i = 0; i < iSize; i++)
+            if (! SymTable_put(oSymTable, acKeys[i], acKeys[i]))
+            {
+               fprintf(stderr, "Insufficient memory\n");
+               exit(EXIT_FAILURE);
+            }
+         dPutNs += getNanoseconds() - dStart;
+
+         dStart = getNanoseconds();
+         for (iRound = 0; iRound < ROUNDS; iRound++)
+            for (i = 0; i < iSize; i++)
+               uCheck += (size_t)SymTable_get(oSymTable, acKeys[i]);
+         dHitNs += getNanoseconds() - dStart;
+
+         dStart = getNanoseconds();
+         for (iRound = 0; iRound < ROUNDS; iRound++)
+            for (i = 0; i < iSize; i++)
+               uCheck += (size_t)SymTable_get(oSymTable,
+                  acKeys[MAX_BINDINGS]);
+         dMissNs += getNanoseconds() - dStart;
+
+         dStart = getNanoseconds();
+         SymTable_free(oSymTable);
+         dPutNs += getNanoseconds() - dStart;
+      }
+
+      printf("%8d  %9.1f  %9.1f  %10.1f\n", iSize,
+         dPutNs / ((double)TABLES * iSize),
+         dHitNs / ((double)TABLES * ROUNDS * iSize),
+         dMissNs / ((double)TABLES * ROUNDS * iSize));
+   }
+
+   /* Print the combined results so that no work can be skipped. */
+   printf("check %lx\n", (unsigned long)uCheck);
+   return 0;
+}
@@ -0,0 +1,824 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function; syscall(), through which
+   perf_event_open() is called, is not. */
+#define _POSIX_C_SOURCE 199309L
+#define _DEFAULT_SOURCE
+
+#include "symtable.h"
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The most values that one parameter can be given. */
+enum {MAX_VALUES = 16};
+
+/* The indices of the workload parameters. */
+enum {SIZE, OPS, READS, HITS, ZIPF, KEYMIN, KEYMAX, SEED,
+      PARAMETER_COUNT};
+
+/* The kinds of operation: a SymTable_get, a SymTable_replace of a
+   present key, and a SymTable_put and SymTable_remove of an absent
+   key, which leaves the table as it was. */
+enum {GET, REPLACE, PUT_REMOVE};
+
+/* The number of clock reads timed to find the cost of one. */
+enum {CLOCK_SAMPLES = 1000};
+
+/* The hardware events that perf mode counts. */
+enum {INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT};
+
+/* The phases of perf mode: a put of every key into an empty table,
+   gets of present and of absent keys, a map, and a remove of every
+   key. */
+enum {PHASE_PUT, PHASE_GET_HIT, PHASE_GET_MISS, PHASE_MAP,
+      PHASE_REMOVE, PHASE_COUNT};
+
+/*--------------------------------------------------------------------*/
+
+/* A workload parameter: its name, the values that it takes in turn,
+   and the number of them. */
+
+struct Parameter
+{
+   const char *pcName;
+   double adValues[MAX_VALUES];
+   int iCount;
+};
+
+/* The parameters, with their defaults. */
+
+static struct Parameter asParameters[PARAMETER_COUNT] =
+{
+   {"size", {10000}, 1},
+   {"ops", {1000000}, 1},
+   {"reads", {90}, 1},
+   {"hits", {90}, 1},
+   {"zipf", {0}, 1},
+   {"keymin", {8}, 1},
+   {"keymax", {24}, 1},
+   {"seed", {1}, 1}
+};
+
+/* The names of the hardware events, as perf mode reports them. */
+
+static const char *const apcCounterNames[COUNTER_COUNT] =
+{
+   "instructions", "cache-misses", "branch-misses"
+};
+
+/* The names of the phases, as perf mode writes them. */
+
+static const char *const apcPhaseNames[PHASE_COUNT] =
+{
+   "put", "get_hit", "get_miss", "map", "remove"
+};
+
+/* The file descriptors of the counters of the hardware events, or -1
+   for those that are unavailable. */
+
+static int aiCounters[COUNTER_COUNT] = {-1, -1, -1};
+
+/*--------------------------------------------------------------------*/
+
+/* One operation of a workload: its kind and its key. */
+
+struct Operation
+{
+   int iKind;
+   const char *pcKey;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The state of the random number generator. */
+
+static uint64_t uiRandomState;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the next number of a xorshift64* sequence, which is cheap
+   and, unlike rand(), covers tables of millions of keys evenly. */
+
+static uint64_t nextRandom(void)
+{
+   uiRandomState ^= uiRandomState >> 12;
+   uiRandomState ^= uiRandomState << 25;
+   uiRandomState ^= uiRandomState >> 27;
+   return uiRandomState * 2685821657736338717ULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a random number in [0, 1). */
+
+static double nextFraction(void)
+{
+   return (double)(nextRandom() >> 11) / 9007199254740992.0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0, or a positive number as the double at
+   pvFirst is less than, equal to, or greater than that at
+   pvSecond. */
+
+static int compareDoubles(const void *pvFirst, const void *pvSecond)
+{
+   double dFirst = *(const double*)pvFirst;
+   double dSecond = *(const double*)pvSecond;
+   return (dFirst > dSecond) - (dFirst < dSecond);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit with EXIT_FAILURE after writing "Insufficient memory" to
+   stderr if pv is NULL. */
+
+static void checkMemory(void *pv)
+{
+   if (pv == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to stderr how to call the program named pcProgram, and exit
+   with EXIT_FAILURE. */
+
+static void usage(const char *pcProgram)
+{
+   int i;
+
+   fprintf(stderr, "Usage: %s [name=value[,value...]]... "
+      "[header=0] [perf=1]\n", pcProgram);
+   fprintf(stderr, "Names:");
+   for (i = 0; i < PARAMETER_COUNT; i++)
+      fprintf(stderr, " %s", asParameters[i].pcName);
+   fprintf(stderr, "\n");
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set the values of the parameter named at the start of pcArgument,
+   which has the form name=value[,value...], or clear *piHeader if
+   pcArgument is "header=0", or set *piPerf if it is "perf=1". Return
+   1 if pcArgument is well formed and its values are in range, or 0
+   otherwise. */
+
+static int parseArgument(const char *pcArgument, int *piHeader,
+   int *piPerf)
+{
+   struct Parameter *psParameter = NULL;
+   const char *pcValue;
+   char *pcEnd;
+   double d;
+   int i;
+
+   if (strcmp(pcArgument, "header=0") == 0)
+   {
+      *piHeader = 0;
+      return 1;
+   }
+   if (strcmp(pcArgument, "perf=1") == 0)
+   {
+      *piPerf = 1;
+      return 1;
+   }
+
+   for (i = 0; i < PARAMETER_COUNT; i++)
+      if (strncmp(pcArgument, asParameters[i].pcName,
+                  strlen(asParameters[i].pcName)) == 0 &&
+          pcArgument[strlen(asParameters[i].pcName)] == '=')
+         psParameter = &asParameters[i];
+   if (psParameter == NULL)
+      return 0;
+
+   psParameter->iCount = 0;
+   pcValue = pcArgument + strlen(psParameter->pcName);
+   do
+   {
+      pcValue++;
+      d = strtod(pcValue, &pcEnd);
+      if (pcEnd == pcValue || (*pcEnd != ',' && *pcEnd != '\0') ||
+          psParameter->iCount == MAX_VALUES || d < 0 ||
+          d != d || d > 1e9)
+         return 0;
+      i = (int)(psParameter - asParameters);
+      if (((i == READS || i == HITS) && d > 100) ||
+          ((i == SIZE || i == OPS || i == KEYMIN || i == KEYMAX) &&
+           (d < 1 || d != floor(d))) ||
+          ((i == KEYMIN || i == KEYMAX) && d > 1000))
+         return 0;
+      psParameter->adValues[psParameter->iCount++] = d;
+      pcValue = pcEnd;
+   } while (*pcValue == ',');
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return an array of uKeyCount distinct keys, stored in a new
+   *ppcKeyBuffer, whose lengths are spread evenly over
+   [iMinLength, iMaxLength]. Key i is random lowercase letters
+   followed by i in decimal, so no two keys are equal. A key is longer
+   than iMaxLength only if i alone is. */
+
+static const char **makeKeys(size_t uKeyCount, int iMinLength,
+   int iMaxLength, char **ppcKeyBuffer)
+{
+   enum {MAX_DIGITS = 20};
+   size_t uStride = (size_t)iMaxLength + MAX_DIGITS + 1;
+   const char **ppcKeys;
+   char *pcKey;
+   size_t u;
+   int iLength;
+   int iLetters;
+   int i;
+
+   ppcKeys = (const char**)malloc(uKeyCount * sizeof(const char*));
+   checkMemory(ppcKeys);
+   *ppcKeyBuffer = (char*)malloc(uKeyCount * uStride);
+   checkMemory(*ppcKeyBuffer);
+
+   for (u = 0; u < uKeyCount; u++)
+   {
+      pcKey = *ppcKeyBuffer + u * uStride;
+      iLength = iMinLength +
+         (int)(nextRandom() % (uint64_t)(iMaxLength - iMinLength + 1));
+      iLetters = iLength - sprintf(pcKey, "%lu", (unsigned long)u);
+      for (i = 0; i < iLetters; i++)
+         pcKey[i] = (char)('a' + nextRandom() % 26);
+      sprintf(pcKey + (iLetters > 0 ? iLetters : 0), "%lu",
+         (unsigned long)u);
+      ppcKeys[u] = pcKey;
+   }
+   return ppcKeys;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return an array of uOps operations on a table whose keys are the
+   first uSize of ppcKeys, the other uSize being absent. dReads percent
+   of them are gets, and dHits percent are of present keys. Key rank r
+   is drawn with probability proportional to 1/(r+1)^dZipf, so a dZipf
+   of 0 is uniform, and ranks are shuffled among the keys so that the
+   popular keys are not the first put. */
+
+static struct Operation *makeOperations(const char **ppcKeys,
+   size_t uSize, size_t uOps, double dReads, double dHits,
+   double dZipf)
+{
+   struct Operation *psaOperations;
+   double *pdCumulative;
+   size_t *puRanks;
+   size_t uLow;
+   size_t uHigh;
+   size_t uMiddle;
+   size_t uSwap;
+   size_t u;
+   double dTotal = 0;
+   double dDraw;
+   int iHit;
+
+   pdCumulative = (double*)malloc(uSize * sizeof(double));
+   checkMemory(pdCumulative);
+   for (u = 0; u < uSize; u++)
+   {
+      dTotal += 1.0 / pow((double)(u + 1), dZipf);
+      pdCumulative[u] = dTotal;
+   }
+
+   puRanks = (size_t*)malloc(uSize * sizeof(size_t));
+   checkMemory(puRanks);
+   for (u = 0; u < uSize; u++)
+      puRanks[u] = u;
+   for (u = uSize - 1; u > 0; u--)
+   {
+      uMiddle = (size_t)(nextRandom() % (u + 1));
+      uSwap = puRanks[u];
+      puRanks[u] = puRanks[uMiddle];
+      puRanks[uMiddle] = uSwap;
+   }
+
+   psaOperations =
+      (struct Operation*)malloc(uOps * sizeof(struct Operation));
+   checkMemory(psaOperations);
+   for (u = 0; u < uOps; u++)
+   {
+      /* Find the first rank whose cumulative weight exceeds the
+         draw. */
+      dDraw = nextFraction() * dTotal;
+      uLow = 0;
+      uHigh = uSize - 1;
+      while (uLow < uHigh)
+      {
+         uMiddle = uLow + (uHigh - uLow) / 2;
+         if (pdCumulative[uMiddle] > dDraw)
+            uHigh = uMiddle;
+         else
+            uLow = uMiddle + 1;
+      }
+
+      iHit = nextFraction() * 100 < dHits;
+      psaOperations[u].pcKey =
+         ppcKeys[puRanks[uLow] + (iHit ? 0 : uSize)];
+      if (nextFraction() * 100 < dReads)
+         psaOperations[u].iKind = GET;
+      else
+         psaOperations[u].iKind = iHit ? REPLACE : PUT_REMOVE;
+   }
+
+   free(puRanks);
+   free(pdCumulative);
+   return psaOperations;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Perform the uOps operations of psaOperations on oSymTable, whose
+   present keys are bound to themselves and whose absent keys are
+   stored after ppcKeys[uSize - 1]. If pdLatencies is not NULL, store
+   the time of each operation in it, less dClockCost. Return the
+   number of wrong results. */
+
+static int runOperations(SymTable_T oSymTable,
+   const struct Operation *psaOperations, size_t uOps,
+   const char **ppcKeys, size_t uSize, double *pdLatencies,
+   double dClockCost)
+{
+   const char *pcFirstAbsent = ppcKeys[uSize];
+   const char *pcKey;
+   double dStart = 0;
+   size_t u;
+   int iErrors = 0;
+
+   for (u = 0; u < uOps; u++)
+   {
+      pcKey = psaOperations[u].pcKey;
+      if (pdLatencies != NULL)
+         dStart = getNanoseconds();
+      switch (psaOperations[u].iKind)
+      {
+         case GET:
+            if (SymTable_get(oSymTable, pcKey) !=
+                (pcKey < pcFirstAbsent ? pcKey : NULL))
+               iErrors++;
+            break;
+         case REPLACE:
+            if (SymTable_replace(oSymTable, pcKey, (void*)pcKey) !=
+                pcKey)
+               iErrors++;
+            break;
+         default:
+            if (! SymTable_put(oSymTable, pcKey, (void*)pcKey) ||
+                SymTable_remove(oSymTable, pcKey) != pcKey)
+               iErrors++;
+            break;
+      }
+      if (pdLatencies != NULL)
+      {
+         pdLatencies[u] = getNanoseconds() - dStart - dClockCost;
+         if (pdLatencies[u] < 0)
+            pdLatencies[u] = 0;
+      }
+   }
+   return iErrors;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the least time between two reads of the clock, which each
+   timed operation is charged for. */
+
+static double getClockCost(void)
+{
+   double dCost = 1e9;
+   double dStart;
+   double dTime;
+   int i;
+
+   for (i = 0; i < CLOCK_SAMPLES; i++)
+   {
+      dStart = getNanoseconds();
+      dTime = getNanoseconds() - dStart;
+      if (dTime < dCost)
+         dCost = dTime;
+   }
+   return dCost;
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef __linux__
+
+/* Return the file descriptor of a new, disabled counter of the
+   hardware event ulEvent, a PERF_COUNT_HW_ constant, that counts this
+   thread in user mode only, or -1 with errno set if the event cannot
+   be counted. */
+
+static int openCounter(unsigned long ulEvent)
+{
+   struct perf_event_attr sAttributes;
+
+   memset(&sAttributes, 0, sizeof(sAttributes));
+   sAttributes.size = sizeof(sAttributes);
+   sAttributes.type = PERF_TYPE_HARDWARE;
+   sAttributes.config = ulEvent;
+   sAttributes.disabled = 1;
+   sAttributes.exclude_kernel = 1;
+   sAttributes.exclude_hv = 1;
+   sAttributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+   return (int)syscall(SYS_perf_event_open, &sAttributes, 0, -1, -1,
+      0UL);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Open the counters of the hardware events. An event that cannot be
+   counted, because the kernel, the hardware, a virtual machine, or
+   perf_event_paranoid does not allow it, is named on stderr and keeps
+   a file descriptor of -1, and its column is left empty. */
+
+static void openCounters(void)
+{
+#ifdef __linux__
+   static const unsigned long aulEvents[COUNTER_COUNT] =
+   {
+      PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+   };
+#endif
+   int i;
+
+   for (i = 0; i < COUNTER_COUNT; i++)
+   {
+#ifdef __linux__
+      aiCounters[i] = openCounter(aulEvents[i]);
+      if (aiCounters[i] < 0)
+         fprintf(stderr, "No %s counter: %s\n", apcCounterNames[i],
+            strerror(errno));
+#else
+      fprintf(stderr, "No %s counter: not Linux\n",
+         apcCounterNames[i]);
+#endif
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Zero and start the counters that are open. */
+
+static void startCounters(void)
+{
+   int i;
+
+   for (i = 0; i < COUNTER_COUNT; i++)
+   {
+      if (aiCounters[i] < 0)
+         continue;
+#ifdef __linux__
+      ioctl(aiCounters[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(aiCounters[i], PERF_EVENT_IOC_ENABLE, 0);
+#endif
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Stop the counters that are open and store in adCounts[i] the count
+   of event i since startCounters, scaled up for any time that the
+   kernel had it switched out to share the hardware with other
+   counters, or -1 if the event was not counted. */
+
+static void stopCounters(double adCounts[])
+{
+   uint64_t auiValues[3];
+   int i;
+
+   for (i = 0; i < COUNTER_COUNT; i++)
+   {
+      adCounts[i] = -1;
+      if (aiCounters[i] < 0)
+         continue;
+#ifdef __linux__
+      ioctl(aiCounters[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(aiCounters[i], auiValues, sizeof(auiValues)) ==
+             (ssize_t)sizeof(auiValues) &&
+          auiValues[2] != 0)
+         adCounts[i] = (double)auiValues[0] *
+            ((double)auiValues[1] / (double)auiValues[2]);
+#else
+      (void)auiValues;
+#endif
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the workload whose parameters, indexed as asParameters, are
+   adWorkload, and write its row of results to stdout. pcBackend names
+   the SymTable implementation, and dClockCost is the cost of a clock
+   read. Exit with EXIT_FAILURE if memory is insufficient or a result
+   is wrong. */
+
+static void runWorkload(const char *pcBackend,
+   const double adWorkload[], double dClockCost)
+{
+   size_t uSize = (size_t)adWorkload[SIZE];
+   size_t uOps = (size_t)adWorkload[OPS];
+   int iMinLength = (int)adWorkload[KEYMIN];
+   int iMaxLength = (int)adWorkload[KEYMAX];
+   SymTable_T oSymTable;
+   struct Operation *psaOperations;
+   const char **ppcKeys;
+   char *pcKeyBuffer;
+   double *pdLatencies;
+   double dStart;
+   double dSeconds;
+   size_t u;
+   int iErrors;
+
+   if (iMaxLength < iMinLength)
+      iMaxLength = iMinLength;
+   uiRandomState = (uint64_t)adWorkload[SEED] * 2 + 1;
+
+   /* Keys 0 to uSize - 1 are put, and the next uSize are absent. */
+   ppcKeys = makeKeys(2 * uSize, iMinLength, iMaxLength, &pcKeyBuffer);
+   psaOperations = makeOperations(ppcKeys, uSize, uOps,
+      adWorkload[READS], adWorkload[HITS], adWorkload[ZIPF]);
+   pdLatencies = (double*)malloc(uOps * sizeof(double));
+   checkMemory(pdLatencies);
+
+   oSymTable = SymTable_new();
+   checkMemory(oSymTable);
+   for (u = 0; u < uSize; u++)
+      if (! SymTable_put(oSymTable, ppcKeys[u], (void*)ppcKeys[u]))
+         checkMemory(NULL);
+
+   /* The throughput is measured without the clock reads of the
+      latency pass, which also finds the table warm. */
+   dStart = getNanoseconds();
+   iErrors = runOperations(oSymTable, psaOperations, uOps, ppcKeys,
+      uSize, NULL, 0);
+   dSeconds = (getNanoseconds() - dStart) / 1e9;
+   iErrors += runOperations(oSymTable, psaOperations, uOps, ppcKeys,
+      uSize, pdLatencies, dClockCost);
+   if (iErrors != 0 || SymTable_getLength(oSymTable) != uSize)
+   {
+      fprintf(stderr, "%d wrong results\n", iErrors);
+      exit(EXIT_FAILURE);
+   }
+
+   qsort(pdLatencies, uOps, sizeof(double), compareDoubles);
+   printf("%s,%lu,%lu,%g,%g,%g,%d,%d,%g,%.3f,%.1f,%.0f,%.0f,%.0f\n",
+      pcBackend, (unsigned long)uSize, (unsigned long)uOps,
+      adWorkload[READS], adWorkload[HITS], adWorkload[ZIPF],
+      iMinLength, iMaxLength, adWorkload[SEED],
+      (double)uOps / dSeconds / 1e6, dSeconds * 1e9 / (double)uOps,
+      pdLatencies[(uOps - 1) / 2],
+      pdLatencies[(size_t)((double)(uOps - 1) * 0.99)],
+      pdLatencies[(size_t)((double)(uOps - 1) * 0.999)]);
+   fflush(stdout);
+
+   SymTable_free(oSymTable);
+   free(pdLatencies);
+   free(psaOperations);
+   free(ppcKeys);
+   free(pcKeyBuffer);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the size_t at pvCount if pvValue is a copy of pcKey, as
+   every value of the tables of perf mode is. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvCount)
+{
+   if (strcmp(pcKey, (const char*)pvValue) == 0)
+      (*(size_t*)pvCount)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the phases of perf mode on the table and keys of the workload
+   whose parameters, indexed as asParameters, are adWorkload, and write
+   a row of results per phase to stdout: the number of operations, and
+   the time, instructions, cache misses and branch misses per
+   operation. The put and remove phases cover every key and the map
+   phase every binding, which counts as one operation; each get phase
+   is ops lookups drawn as in the workload. pcBackend names the
+   SymTable implementation. Exit with EXIT_FAILURE if memory is
+   insufficient or a result is wrong. */
+
+static void runPhases(const char *pcBackend, const double adWorkload[])
+{
+   size_t uSize = (size_t)adWorkload[SIZE];
+   size_t uOps = (size_t)adWorkload[OPS];
+   int iMinLength = (int)adWorkload[KEYMIN];
+   int iMaxLength = (int)adWorkload[KEYMAX];
+   SymTable_T oSymTable;
+   struct Operation *psaHits;
+   struct Operation *psaMisses;
+   const char **ppcKeys;
+   char *pcKeyBuffer;
+   double adCounts[COUNTER_COUNT];
+   double dStart;
+   double dNanoseconds;
+   size_t uCount;
+   size_t uBindings;
+   size_t u;
+   int iErrors = 0;
+   int iPhase;
+   int i;
+
+   if (iMaxLength < iMinLength)
+      iMaxLength = iMinLength;
+   uiRandomState = (uint64_t)adWorkload[SEED] * 2 + 1;
+
+   /* Keys 0 to uSize - 1 are put, and the next uSize are absent. */
+   ppcKeys = makeKeys(2 * uSize, iMinLength, iMaxLength, &pcKeyBuffer);
+   psaHits = makeOperations(ppcKeys, uSize, uOps, 100, 100,
+      adWorkload[ZIPF]);
+   psaMisses = makeOperations(ppcKeys, uSize, uOps, 100, 0,
+      adWorkload[ZIPF]);
+   oSymTable = SymTable_new();
+   checkMemory(oSymTable);
+
+   for (iPhase = 0; iPhase < PHASE_COUNT; iPhase++)
+   {
+      uCount = uSize;
+      uBindings = 0;
+      startCounters();
+      dStart = getNanoseconds();
+      switch (iPhase)
+      {
+         case PHASE_PUT:
+            for (u = 0; u < uSize; u++)
+               if (! SymTable_put(oSymTable, ppcKeys[u],
+                                  (void*)ppcKeys[u]))
+                  iErrors++;
+            break;
+         case PHASE_GET_HIT:
+            iErrors += runOperations(oSymTable, psaHits, uOps, ppcKeys,
+               uSize, NULL, 0);
+            uCount = uOps;
+            break;
+         case PHASE_GET_MISS:
+            iErrors += runOperations(oSymTable, psaMisses, uOps,
+               ppcKeys, uSize, NULL, 0);
+            uCount = uOps;
+            break;
+         case PHASE_MAP:
+            SymTable_map(oSymTable, countBinding, &uBindings);
+            if (uBindings != uSize)
+               iErrors++;
+            break;
+         default:
+            for (u = 0; u < uSize; u++)
+               if (SymTable_remove(oSymTable, ppcKeys[u]) != ppcKeys[u])
+                  iErrors++;
+            break;
+      }
+      dNanoseconds = getNanoseconds() - dStart;
+      stopCounters(adCounts);
+
+      printf("%s,%lu,%lu,%g,%d,%d,%g,%s,%lu,%.1f", pcBackend,
+         (unsigned long)uSize, (unsigned long)uOps, adWorkload[ZIPF],
+         iMinLength, iMaxLength, adWorkload[SEED],
+         apcPhaseNames[iPhase], (unsigned long)uCount,
+         dNanoseconds / (double)uCount);
+      for (i = 0; i < COUNTER_COUNT; i++)
+      {
+         if (adCounts[i] < 0)
+            printf(",");
+         else
+            printf(",%.2f", adCounts[i] / (double)uCount);
+      }
+      printf("\n");
+      fflush(stdout);
+   }
+
+   if (iErrors != 0 || SymTable_getLength(oSymTable) != 0)
+   {
+      fprintf(stderr, "%d wrong results\n", iErrors);
+      exit(EXIT_FAILURE);
+   }
+
+   SymTable_free(oSymTable);
+   free(psaMisses);
+   free(psaHits);
+   free(ppcKeys);
+   free(pcKeyBuffer);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run a workload of gets, replaces, and puts with removes on a table
+   of the SymTable implementation linked into this program, for every
+   combination of the parameter values given as name=value[,value...]
+   arguments, and write to stdout one CSV row per workload with its
+   throughput, mean time per operation, and median, 99th and 99.9th
+   percentile latency. With perf=1, instead run the phases of perf
+   mode on each workload and write one row per phase with the hardware
+   counts per operation, leaving empty the columns of counters that
+   are unavailable. The backend column is the program name less
+   "benchsymtable". As always, argc is the command-line argument count
+   and argv contains the command-line arguments. Exit with
+   EXIT_FAILURE if an argument is malformed, memory is insufficient,
+   or a result is wrong. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   double adWorkload[PARAMETER_COUNT];
+   int aiIndexes[PARAMETER_COUNT];
+   const char *pcBackend;
+   double dClockCost = 0;
+   int iHeader = 1;
+   int iPerf = 0;
+   int i;
+
+   for (i = 1; i < argc; i++)
+      if (! parseArgument(argv[i], &iHeader, &iPerf))
+         usage(argv[0]);
+
+   pcBackend = strrchr(argv[0], '/');
+   pcBackend = pcBackend == NULL ? argv[0] : pcBackend + 1;
+   if (strncmp(pcBackend, "benchsymtable", 13) == 0 &&
+       pcBackend[13] != '\0')
+      pcBackend += 13;
+
+   if (iPerf)
+   {
+      openCounters();
+      if (iHeader)
+         printf("backend,size,ops,zipf,keymin,keymax,seed,phase,count,"
+                "ns_per_op,instructions_per_op,cache_misses_per_op,"
+                "branch_misses_per_op\n");
+   }
+   else
+   {
+      if (iHeader)
+         printf("backend,size,ops,reads,hits,zipf,keymin,keymax,seed,"
+                "mops,ns_per_op,p50_ns,p99_ns,p999_ns\n");
+      dClockCost = getClockCost();
+   }
+
+   /* Count through the combinations of values, the last parameter
+      changing fastest. */
+   for (i = 0; i < PARAMETER_COUNT; i++)
+      aiIndexes[i] = 0;
+   do
+   {
+      for (i = 0; i < PARAMETER_COUNT; i++)
+         adWorkload[i] = asParameters[i].adValues[aiIndexes[i]];
+      if (iPerf)
+         runPhases(pcBackend, adWorkload);
+      else
+         runWorkload(pcBackend, adWorkload, dClockCost);
+
+      for (i = PARAMETER_COUNT - 1; i >= 0; i--)
+      {
+         if (++aiIndexes[i] < asParameters[i].iCount)
+            break;
+         aiIndexes[i] = 0;
+      }
+   } while (i >= 0);
+
+   return 0;
+}
@@ -0,0 +1,113 @@
+/*--------------------------------------------------------------------*/
+/* keyorder.c                                                         */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "keyorder.h"
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings for which room is first made. */
+enum {INITIAL_CAPACITY = 16};
+
+/*--------------------------------------------------------------------*/
+
+void KeyOrder_init(struct KeyOrder *psOrder, const char *pcLow,
+  const char *pcHigh, const char *pcPrefix)
+{
+  assert(psOrder != NULL);
+
+  psOrder->psaBindings = NULL;
+  psOrder->uLength = 0;
+  psOrder->uCapacity = 0;
+  psOrder->pcLow = pcLow;
+  psOrder->pcHigh = pcHigh;
+  psOrder->pcPrefix = pcPrefix;
+  psOrder->uPrefixLength = pcPrefix == NULL ? 0 : strlen(pcPrefix);
+  psOrder->iFailed = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+void KeyOrder_collect(const char *pcKey, void *pvValue, void *pvOrder)
+{
+  /* The KeyOrder. */
+  struct KeyOrder *psOrder = (struct KeyOrder *)pvOrder;
+
+  /* The larger array of bindings, and the number that fit in it. */
+  struct KeyOrderBinding *psaNewBindings;
+  size_t uNewCapacity;
+
+  assert(pcKey != NULL);
+  assert(psOrder != NULL);
+
+  if (psOrder->iFailed ||
+      (psOrder->pcLow != NULL && strcmp(pcKey, psOrder->pcLow) < 0) ||
+      (psOrder->pcHigh != NULL &&
+       strcmp(pcKey, psOrder->pcHigh) >= 0) ||
+      (psOrder->pcPrefix != NULL &&
+       strncmp(pcKey, psOrder->pcPrefix, psOrder->uPrefixLength) != 0))
+    return;
+
+  if (psOrder->uLength == psOrder->uCapacity) {
+    uNewCapacity = psOrder->uCapacity == 0 ?
+      INITIAL_CAPACITY : psOrder->uCapacity * 2;
+    psaNewBindings = (struct KeyOrderBinding *)
+      realloc(psOrder->psaBindings,
+              uNewCapacity * sizeof(struct KeyOrderBinding));
+    if (psaNewBindings == NULL) {
+      psOrder->iFailed = 1;
+      return;
+    }
+    psOrder->psaBindings = psaNewBindings;
+    psOrder->uCapacity = uNewCapacity;
+  }
+
+  psOrder->psaBindings[psOrder->uLength].pcKey = pcKey;
+  psOrder->psaBindings[psOrder->uLength].pvValue = pvValue;
+  psOrder->uLength++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0, or a positive number as the key of the
+   struct KeyOrderBinding at pvFirst is less than, equal to, or greater
+   than that at pvSecond. */
+static int KeyOrder_compare(const void *pvFirst, const void *pvSecond)
+{
+  return strcmp(((const struct KeyOrderBinding *)pvFirst)->pcKey,
+                ((const struct KeyOrderBinding *)pvSecond)->pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int KeyOrder_apply(struct KeyOrder *psOrder,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* Incrementor over the bindings. */
+  size_t u;
+
+  assert(psOrder != NULL);
+  assert(pfApply != NULL);
+
+  if (psOrder->iFailed) {
+    free(psOrder->psaBindings);
+    return 0;
+  }
+
+  /* No array is allocated until a binding is gathered. */
+  if (psOrder->uLength > 1)
+    qsort(psOrder->psaBindings, psOrder->uLength,
+          sizeof(struct KeyOrderBinding), KeyOrder_compare);
+  for (u = 0; u < psOrder->uLength; u++)
+    (*pfApply)(psOrder->psaBindings[u].pcKey,
+               psOrder->psaBindings[u].pvValue, (void *)pvExtra);
+
+  free(psOrder->psaBindings);
+  return 1;
+}
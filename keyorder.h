@@ -0,0 +1,79 @@
+/*--------------------------------------------------------------------*/
+/* keyorder.h                                                         */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#ifndef KEYORDER_INCLUDED
+#define KEYORDER_INCLUDED
+
+/* A KeyOrder gives SymTable_mapPrefix and SymTable_mapRange to the
+   implementations of the SymTable ADT that keep their bindings in no
+   order. KeyOrder_collect, passed to SymTable_map or called on each
+   binding directly, gathers the bindings in range; KeyOrder_apply
+   sorts them by key and applies a function to them in order. The keys
+   are not copied, so they must stay valid until KeyOrder_apply
+   returns. A KeyOrder lives on the caller's stack, so its fields are
+   visible, but only the functions below may touch them. */
+
+/*--------------------------------------------------------------------*/
+
+/* A binding gathered by a KeyOrder. */
+
+struct KeyOrderBinding {
+  /* The key and the value of the binding. */
+  const char *pcKey;
+  void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The bindings gathered so far, and the range they must be in. */
+
+struct KeyOrder {
+  /* The gathered bindings, their number, and the number that fit. */
+  struct KeyOrderBinding *psaBindings;
+  size_t uLength;
+  size_t uCapacity;
+
+  /* The lowest key, the key above the highest, and the prefix of the
+     bindings to gather, with its length; each may be NULL. */
+  const char *pcLow;
+  const char *pcHigh;
+  const char *pcPrefix;
+  size_t uPrefixLength;
+
+  /* Whether memory ran out while gathering. */
+  int iFailed;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Initialize psOrder to gather the bindings whose keys are at least
+   pcLow, less than pcHigh, and begin with pcPrefix, where any of the
+   three may be NULL to leave out that condition. */
+
+void KeyOrder_init(struct KeyOrder *psOrder, const char *pcLow,
+  const char *pcHigh, const char *pcPrefix);
+
+/*--------------------------------------------------------------------*/
+
+/* Gather the binding with key pcKey and value pvValue into the struct
+   KeyOrder at pvOrder if the key is in its range. The parameters are
+   those of the pfApply of SymTable_map. */
+
+void KeyOrder_collect(const char *pcKey, void *pvValue, void *pvOrder);
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, with pvExtra, to the bindings gathered by psOrder in
+   increasing strcmp order of their keys, then free them. Return 1 if
+   successful, or 0 if memory ran out while gathering, in which case
+   pfApply is not called. */
+
+int KeyOrder_apply(struct KeyOrder *psOrder,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+#endif
@@ -0,0 +1,223 @@
+/*--------------------------------------------------------------------*/
+/* profile.c                                                          */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is POSIX. */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include "profile.h"
+
+#ifndef __GNUC__
+#error "profile.c needs the GCC __thread and __atomic extensions"
+#endif
+
+/* The time stamp counter, where there is one, is read in a few cycles;
+   elsewhere a tick is a nanosecond of the monotonic clock. */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_TICKS() ((unsigned long long)__rdtsc())
+#define PROFILE_UNIT "cycles"
+#else
+#define PROFILE_TICKS() Profile_clockTicks()
+#define PROFILE_UNIT "ns"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The names of the operations, as Profile_dump writes them. */
+static const char *const apcOperationNames[PROFILE_OPERATIONS] = {
+  "get", "put", "remove", "replace"
+};
+
+/*--------------------------------------------------------------------*/
+
+__thread struct ProfileCall Profile_sCall;
+
+/*--------------------------------------------------------------------*/
+
+#if !defined(__x86_64__) && !defined(__i386__)
+
+/* Return the monotonic clock in nanoseconds. */
+
+static unsigned long long Profile_clockTicks(void) {
+  /* The time now. */
+  struct timespec sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &sNow);
+  return (unsigned long long)sNow.tv_sec * 1000000000ULL
+    + (unsigned long long)sNow.tv_nsec;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the histogram bin of a sample of ullTicks ticks: the number
+   of bits of ullTicks, at most PROFILE_BINS - 1. */
+
+static size_t Profile_bin(unsigned long long ullTicks) {
+  /* The bin. */
+  size_t uBin = 0;
+
+  while (ullTicks != 0 && uBin < PROFILE_BINS - 1) {
+    ullTicks >>= 1;
+    uBin++;
+  }
+  return uBin;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest number of ticks that no sample in bin uBin or
+   below reaches. */
+
+static unsigned long long Profile_binLimit(size_t uBin) {
+  return 1ULL << uBin;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Profile_init(struct Profile *psProfile) {
+  assert(psProfile != NULL);
+
+  memset(psProfile, 0, sizeof(*psProfile));
+}
+
+/*--------------------------------------------------------------------*/
+
+void Profile_begin(int iOperation) {
+  assert(iOperation >= 0 && iOperation < PROFILE_OPERATIONS);
+
+  Profile_sCall.iOperation = iOperation;
+  Profile_sCall.uProbes = 0;
+  Profile_sCall.uCompares = 0;
+
+  /* Time the call last, so that the clock is read as close to the
+     work as possible. */
+  if (Profile_sCall.uUntilTimed == 0) {
+    Profile_sCall.uUntilTimed = SYMTABLE_PROFILE_PERIOD - 1;
+    Profile_sCall.iTimed = 1;
+    Profile_sCall.ullStart = PROFILE_TICKS();
+  }
+  else {
+    Profile_sCall.uUntilTimed--;
+    Profile_sCall.iTimed = 0;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+void Profile_end(struct Profile *psProfile, int iHit) {
+  /* The tick at which the call ended, if it is timed. */
+  unsigned long long ullEnd = 0;
+
+  /* The counts of the operation of the call. */
+  struct ProfileCounts *psCounts;
+
+  if (Profile_sCall.iTimed)
+    ullEnd = PROFILE_TICKS();
+
+  assert(psProfile != NULL);
+
+  psCounts = &psProfile->asCounts[Profile_sCall.iOperation];
+
+  /* The counts are statistics, not synchronization, so relaxed
+     atomics are enough for the tables shared between threads. */
+  __atomic_fetch_add(&psCounts->uCalls, 1, __ATOMIC_RELAXED);
+  if (iHit)
+    __atomic_fetch_add(&psCounts->uHits, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&psCounts->uProbes, Profile_sCall.uProbes,
+    __ATOMIC_RELAXED);
+  __atomic_fetch_add(&psCounts->uCompares, Profile_sCall.uCompares,
+    __ATOMIC_RELAXED);
+  if (Profile_sCall.iTimed)
+    __atomic_fetch_add(&psCounts->auLatencies[Profile_bin(
+      ullEnd - Profile_sCall.ullStart)], 1, __ATOMIC_RELAXED);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to psFile the histogram of psCounts, with the bins below which
+   half and 99% of the timed calls fall. */
+
+static void Profile_dumpLatencies(const struct ProfileCounts *psCounts,
+  FILE *psFile) {
+  /* The number of timed calls, and the number in the bins so far. */
+  size_t uSamples = 0;
+  size_t uSoFar = 0;
+
+  /* The bins below which half and 99% of the timed calls fall, or
+     PROFILE_BINS until they are found. */
+  size_t uMedianBin = PROFILE_BINS;
+  size_t uTailBin = PROFILE_BINS;
+
+  /* The bin. */
+  size_t uBin;
+
+  for (uBin = 0; uBin < PROFILE_BINS; uBin++)
+    uSamples += __atomic_load_n(&psCounts->auLatencies[uBin],
+      __ATOMIC_RELAXED);
+  if (uSamples == 0)
+    return;
+
+  for (uBin = 0; uBin < PROFILE_BINS; uBin++) {
+    uSoFar += __atomic_load_n(&psCounts->auLatencies[uBin],
+      __ATOMIC_RELAXED);
+    if (uMedianBin == PROFILE_BINS && 2 * uSoFar >= uSamples)
+      uMedianBin = uBin;
+    if (uTailBin == PROFILE_BINS && 100 * uSoFar >= 99 * uSamples)
+      uTailBin = uBin;
+  }
+
+  fprintf(psFile, "  %lu timed, p50 < %llu %s, p99 < %llu %s\n",
+    (unsigned long)uSamples, Profile_binLimit(uMedianBin),
+    PROFILE_UNIT, Profile_binLimit(uTailBin), PROFILE_UNIT);
+  for (uBin = 0; uBin < PROFILE_BINS; uBin++) {
+    /* The timed calls in the bin. */
+    size_t uCount = __atomic_load_n(&psCounts->auLatencies[uBin],
+      __ATOMIC_RELAXED);
+
+    if (uCount != 0)
+      fprintf(psFile, "  < %llu %s: %lu\n", Profile_binLimit(uBin),
+        PROFILE_UNIT, (unsigned long)uCount);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+void Profile_dump(const struct Profile *psProfile, FILE *psFile) {
+  /* The operation. */
+  int iOperation;
+
+  assert(psProfile != NULL);
+  assert(psFile != NULL);
+
+  for (iOperation = 0; iOperation < PROFILE_OPERATIONS; iOperation++) {
+    /* The counts of the operation. */
+    const struct ProfileCounts *psCounts =
+      &psProfile->asCounts[iOperation];
+
+    /* Its calls and hits. */
+    size_t uCalls = __atomic_load_n(&psCounts->uCalls,
+      __ATOMIC_RELAXED);
+    size_t uHits = __atomic_load_n(&psCounts->uHits,
+      __ATOMIC_RELAXED);
+
+    if (uCalls == 0)
+      continue;
+    fprintf(psFile, "%s: %lu calls, %lu hits, %lu misses, "
+      "%.2f probes/call, %.2f compares/call\n",
+      apcOperationNames[iOperation], (unsigned long)uCalls,
+      (unsigned long)uHits, (unsigned long)(uCalls - uHits),
+      (double)__atomic_load_n(&psCounts->uProbes, __ATOMIC_RELAXED)
+        / (double)uCalls,
+      (double)__atomic_load_n(&psCounts->uCompares, __ATOMIC_RELAXED)
+        / (double)uCalls);
+    Profile_dumpLatencies(psCounts, psFile);
+  }
+}
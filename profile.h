@@ -0,0 +1,136 @@
+/*--------------------------------------------------------------------*/
+/* profile.h                                                          */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef PROFILE_INCLUDED
+#define PROFILE_INCLUDED
+
+/* A Profile counts the calls of SymTable_get, SymTable_put,
+   SymTable_remove and SymTable_replace on one table: how many found
+   their key, how many bindings they probed and how many strcmp calls
+   they made, and, for one call in SYMTABLE_PROFILE_PERIOD, how long
+   the call took, in a histogram with a bin per power of two. An
+   implementation of the SymTable ADT keeps a struct Profile in each
+   table and marks its hot paths with the macros below, which expand
+   to nothing unless SYMTABLE_PROFILE is defined, so that a build
+   without it pays nothing. A Profile may be updated by many threads at
+   once. */
+
+/*--------------------------------------------------------------------*/
+
+/* The profiled operations. */
+enum {PROFILE_GET, PROFILE_PUT, PROFILE_REMOVE, PROFILE_REPLACE,
+  PROFILE_OPERATIONS};
+
+/* The number of bins of a latency histogram. Bin i counts the samples
+   of 2^(i-1) to 2^i - 1 ticks; bin 0 counts the samples of 0 ticks,
+   and the last bin every sample too long for the others. */
+enum {PROFILE_BINS = 40};
+
+/* By default, one call in this many is timed. */
+#ifndef SYMTABLE_PROFILE_PERIOD
+#define SYMTABLE_PROFILE_PERIOD 16
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The counts of one operation. */
+
+struct ProfileCounts {
+  /* The calls, those that found their key, the bindings they probed,
+     and the strcmp calls they made. */
+  size_t uCalls;
+  size_t uHits;
+  size_t uProbes;
+  size_t uCompares;
+
+  /* The histogram of the timed calls. */
+  size_t auLatencies[PROFILE_BINS];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The counts of every operation on one table. */
+
+struct Profile {
+  struct ProfileCounts asCounts[PROFILE_OPERATIONS];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The counts of the call in progress on this thread. A call counts
+   into its thread's struct ProfileCall, which is added to the table's
+   struct Profile once, when the call ends. It is thread-local, a GCC
+   extension, so it is declared only when SYMTABLE_PROFILE is. */
+
+struct ProfileCall {
+  /* The operation, the bindings probed and the strcmp calls made. */
+  int iOperation;
+  size_t uProbes;
+  size_t uCompares;
+
+  /* The tick at which the call began, and whether it is timed. */
+  unsigned long long ullStart;
+  int iTimed;
+
+  /* The calls to go until the next timed call. */
+  size_t uUntilTimed;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Zero the counts of psProfile. */
+
+void Profile_init(struct Profile *psProfile);
+
+/*--------------------------------------------------------------------*/
+
+/* Begin a call of operation iOperation, one of the PROFILE_
+   enumerators, on this thread. */
+
+void Profile_begin(int iOperation);
+
+/*--------------------------------------------------------------------*/
+
+/* End the call that this thread began last, adding its counts to
+   psProfile; iHit is 1 if the call found its key, or 0 if not. */
+
+void Profile_end(struct Profile *psProfile, int iHit);
+
+/*--------------------------------------------------------------------*/
+
+/* Write the counts of psProfile to psFile: a line per operation that
+   has been called, "get: C calls, H hits, M misses, P probes/call,
+   S compares/call", followed by its nonempty latency bins. */
+
+void Profile_dump(const struct Profile *psProfile, FILE *psFile);
+
+/*--------------------------------------------------------------------*/
+
+/* The hooks of the hot paths. PROFILE_BEGIN and PROFILE_END bracket a
+   call; PROFILE_PROBE marks a binding examined by the call, and
+   PROFILE_STRCMP(pc1, pc2) stands for strcmp(pc1, pc2), counting it. */
+
+#ifdef SYMTABLE_PROFILE
+extern __thread struct ProfileCall Profile_sCall;
+
+#define PROFILE_INIT(psProfile) Profile_init(psProfile)
+#define PROFILE_BEGIN(iOperation) Profile_begin(iOperation)
+#define PROFILE_END(psProfile, iHit) Profile_end(psProfile, iHit)
+#define PROFILE_PROBE() ((void)Profile_sCall.uProbes++)
+#define PROFILE_STRCMP(pc1, pc2) \
+  (Profile_sCall.uCompares++, strcmp(pc1, pc2))
+#else
+#define PROFILE_INIT(psProfile) ((void)0)
+#define PROFILE_BEGIN(iOperation) ((void)0)
+#define PROFILE_END(psProfile, iHit) ((void)0)
+#define PROFILE_PROBE() ((void)0)
+#define PROFILE_STRCMP(pc1, pc2) strcmp(pc1, pc2)
+#endif
+
+#endif
@@ -0,0 +1,810 @@
+/*--------------------------------------------------------------------*/
+/* replaysymtable.c                                                   */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is a POSIX function. */
+#define _POSIX_C_SOURCE 199309L
+
+#include "symtable.h"
+#include "symtabletrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of clock reads timed to find the cost of one. */
+enum {CLOCK_SAMPLES = 1000};
+
+/* The names of the operations of a trace, as the program writes
+   them. */
+
+static const char *const apcOperationNames[TRACE_OPERATIONS] =
+{
+   "new", "newWithCapacity", "free", "getLength", "getStats",
+   "reserve", "shrinkToFit", "put", "replace", "contains", "get",
+   "getBatch", "remove", "getOrInsert", "upsertWith", "hashKey",
+   "putHashed", "containsHashed", "getHashed", "map", "mapParallel",
+   "iterBegin", "iterNext", "iterEnd", "scan", "mapPrefix",
+   "mapRange"
+};
+
+/*--------------------------------------------------------------------*/
+
+/* One call of a trace: its operation, the number of its table, or of
+   its iterator for TRACE_ITER_NEXT and TRACE_ITER_END, its keys, and
+   its other fields in order. A record with a key also holds the index
+   of the key in ppcKeys as its first number. A TRACE_GET_BATCH record
+   holds its count and the index in ppcBatchKeys of its first key; a
+   TRACE_ITER_BEGIN record holds the number of its iterator. */
+
+struct Record
+{
+   int iOperation;
+   size_t uObject;
+   const char *pcKey;
+   const char *pcHigh;
+   size_t uFirst;
+   size_t uSecond;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The unread part of a trace. */
+
+struct Reader
+{
+   const unsigned char *pucNext;
+   const unsigned char *pucEnd;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The trace: its records, its keys, NULL first so that a key field
+   indexes them directly, the keys of its TRACE_GET_BATCH records in
+   turn, and the number of each and of the tables and iterators that
+   it makes. */
+
+static struct Record *psaRecords;
+static size_t uRecordCount;
+static const char **ppcKeys;
+static size_t uKeyCount;
+static size_t uKeyCapacity;
+static const char **ppcBatchKeys;
+static size_t uBatchKeyCount;
+static size_t uTableCount;
+static size_t uIterCount;
+
+/* The state of a replay: the tables and iterators, the table of each
+   iterator, the number of open iterators of each table, the cursor of
+   the scan of each table, the hash of each key, whether it has been
+   computed, and the outputs of SymTable_getBatch. */
+
+static SymTable_T *poTables;
+static SymTableIter_T *poIters;
+static size_t *puIterTables;
+static size_t *puOpenIters;
+static size_t *puCursors;
+static size_t *puHashes;
+static char *pcHashed;
+static void **ppvBatchValues;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current value of the monotonic clock in nanoseconds. */
+
+static double getNanoseconds(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec * 1e9 + (double)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the least time between two reads of the clock, which each
+   timed call is charged for. */
+
+static double getClockCost(void)
+{
+   double dCost = 1e9;
+   double dStart;
+   double dTime;
+   int i;
+
+   for (i = 0; i < CLOCK_SAMPLES; i++)
+   {
+      dStart = getNanoseconds();
+      dTime = getNanoseconds() - dStart;
+      if (dTime < dCost)
+         dCost = dTime;
+   }
+   return dCost;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit with EXIT_FAILURE after writing "Insufficient memory" to
+   stderr if pv is NULL. */
+
+static void checkMemory(void *pv)
+{
+   if (pv == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit with EXIT_FAILURE after writing "Malformed trace" to stderr. */
+
+static void malformed(void)
+{
+   fprintf(stderr, "Malformed trace\n");
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return pv, an array of *puCapacity elements of uSize bytes, of which
+   uCount are used, with room for one more, reallocating it and
+   updating *puCapacity if it is full. Exit with EXIT_FAILURE if
+   memory is insufficient. */
+
+static void *makeRoom(void *pv, size_t *puCapacity, size_t uCount,
+   size_t uSize)
+{
+   if (uCount < *puCapacity)
+      return pv;
+   *puCapacity = *puCapacity == 0 ? 64 : 2 * *puCapacity;
+   pv = realloc(pv, *puCapacity * uSize);
+   checkMemory(pv);
+   return pv;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the contents of the file named pcPath, and store their
+   length in *puLength. Exit with EXIT_FAILURE if the file cannot be
+   read or memory is insufficient. */
+
+static unsigned char *readFile(const char *pcPath, size_t *puLength)
+{
+   FILE *psFile;
+   unsigned char *pucContents = NULL;
+   size_t uCapacity = 0;
+   size_t uLength = 0;
+
+   psFile = fopen(pcPath, "rb");
+   if (psFile == NULL)
+   {
+      fprintf(stderr, "Cannot read %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   for (;;)
+   {
+      pucContents = makeRoom(pucContents, &uCapacity, uLength, 1);
+      uLength += fread(pucContents + uLength, 1, uCapacity - uLength,
+         psFile);
+      if (uLength < uCapacity)
+         break;
+   }
+   if (ferror(psFile))
+   {
+      fprintf(stderr, "Cannot read %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   fclose(psFile);
+
+   *puLength = uLength;
+   return pucContents;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read a number from psReader into *pu. Return 1 if successful, or 0
+   if the trace ends first. Exit with EXIT_FAILURE if the number is too
+   big for a size_t. */
+
+static int readNumber(struct Reader *psReader, size_t *pu)
+{
+   size_t u = 0;
+   unsigned uShift = 0;
+   unsigned char ucByte;
+
+   do
+   {
+      if (psReader->pucNext == psReader->pucEnd)
+         return 0;
+      ucByte = *psReader->pucNext++;
+      if (uShift >= 8 * sizeof(size_t) ||
+          ((size_t)(ucByte & 0x7f) << uShift >> uShift) !=
+          (size_t)(ucByte & 0x7f))
+         malformed();
+      u |= (size_t)(ucByte & 0x7f) << uShift;
+      uShift += 7;
+   } while (ucByte & 0x80);
+
+   *pu = u;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read a key from psReader into *ppcKey, and its index in ppcKeys
+   into *puKey unless puKey is NULL, adding it to ppcKeys if it is new.
+   Return 1 if successful, or 0 if the trace ends first. Exit with
+   EXIT_FAILURE if the key is NULL and iNullable is 0, or if the key
+   is malformed or memory is insufficient. */
+
+static int readKey(struct Reader *psReader, const char **ppcKey,
+   size_t *puKey, int iNullable)
+{
+   size_t uKey;
+   size_t uLength;
+   char *pcKey;
+
+   if (! readNumber(psReader, &uKey))
+      return 0;
+   if (uKey == 0 && ! iNullable)
+      malformed();
+   if (uKey == uKeyCount + 1)
+   {
+      if (! readNumber(psReader, &uLength))
+         return 0;
+      if (uLength > (size_t)(psReader->pucEnd - psReader->pucNext))
+         return 0;
+      pcKey = malloc(uLength + 1);
+      checkMemory(pcKey);
+      memcpy(pcKey, psReader->pucNext, uLength);
+      pcKey[uLength] = '\0';
+      psReader->pucNext += uLength;
+
+      ppcKeys = makeRoom(ppcKeys, &uKeyCapacity, uKeyCount + 1,
+         sizeof(const char*));
+      ppcKeys[++uKeyCount] = pcKey;
+   }
+   else if (uKey > uKeyCount)
+      malformed();
+
+   *ppcKey = ppcKeys[uKey];
+   if (puKey != NULL)
+      *puKey = uKey;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the number of a table or iterator from psReader into *puObject.
+   If iNew is 1, it must be *puCount, the number of those made so far,
+   which is incremented; otherwise it must be less. Return 1 if
+   successful, or 0 if the trace ends first. Exit with EXIT_FAILURE if
+   the number is wrong. */
+
+static int readObject(struct Reader *psReader, size_t *puObject,
+   size_t *puCount, int iNew)
+{
+   if (! readNumber(psReader, puObject))
+      return 0;
+   if (iNew ? *puObject != *puCount : *puObject >= *puCount)
+      malformed();
+   if (iNew)
+      (*puCount)++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the fields of a record of operation psRecord->iOperation from
+   psReader into psRecord. Return 1 if successful, or 0 if the trace
+   ends first. Exit with EXIT_FAILURE if the record is malformed or
+   memory is insufficient. */
+
+static int readRecord(struct Reader *psReader, struct Record *psRecord)
+{
+   static size_t uBatchCapacity = 0;
+   const char *pcKey;
+   size_t u;
+
+   switch (psRecord->iOperation)
+   {
+      case TRACE_NEW:
+         return readObject(psReader, &psRecord->uObject, &uTableCount,
+            1);
+      case TRACE_NEW_WITH_CAPACITY:
+         return readObject(psReader, &psRecord->uObject, &uTableCount,
+               1)
+            && readNumber(psReader, &psRecord->uFirst);
+      case TRACE_HASH_KEY:
+         return readKey(psReader, &psRecord->pcKey, &psRecord->uFirst,
+            0);
+      case TRACE_ITER_NEXT:
+      case TRACE_ITER_END:
+         return readObject(psReader, &psRecord->uObject, &uIterCount,
+            0);
+      default:
+         break;
+   }
+
+   if (! readObject(psReader, &psRecord->uObject, &uTableCount, 0))
+      return 0;
+
+   switch (psRecord->iOperation)
+   {
+      case TRACE_FREE:
+      case TRACE_GET_LENGTH:
+      case TRACE_GET_STATS:
+      case TRACE_SHRINK_TO_FIT:
+      case TRACE_MAP:
+         return 1;
+      case TRACE_RESERVE:
+      case TRACE_MAP_PARALLEL:
+         return readNumber(psReader, &psRecord->uFirst);
+      case TRACE_SCAN:
+         return readNumber(psReader, &psRecord->uFirst)
+            && readNumber(psReader, &psRecord->uSecond);
+      case TRACE_ITER_BEGIN:
+         return readObject(psReader, &psRecord->uFirst, &uIterCount,
+            1);
+      case TRACE_MAP_RANGE:
+         return readKey(psReader, &psRecord->pcKey, NULL, 1)
+            && readKey(psReader, &psRecord->pcHigh, NULL, 1);
+      case TRACE_GET_BATCH:
+         if (! readNumber(psReader, &psRecord->uFirst))
+            return 0;
+         psRecord->uSecond = uBatchKeyCount;
+         for (u = 0; u < psRecord->uFirst; u++)
+         {
+            if (! readKey(psReader, &pcKey, NULL, 0))
+               return 0;
+            ppcBatchKeys = makeRoom(ppcBatchKeys, &uBatchCapacity,
+               uBatchKeyCount, sizeof(const char*));
+            ppcBatchKeys[uBatchKeyCount++] = pcKey;
+         }
+         return 1;
+      default:
+         return readKey(psReader, &psRecord->pcKey, &psRecord->uFirst,
+            0);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the trace in the file named pcPath into psaRecords and the
+   other variables of the trace. A record cut short at the end, as
+   when the traced program was killed, ends the trace. Exit with
+   EXIT_FAILURE if the file cannot be read or is not a trace, or if
+   memory is insufficient. */
+
+static void readTrace(const char *pcPath)
+{
+   struct Reader sReader;
+   unsigned char *pucContents;
+   size_t uLength;
+   size_t uCapacity = 0;
+
+   pucContents = readFile(pcPath, &uLength);
+   if (uLength < 9 || memcmp(pucContents, "SYMTRACE", 8) != 0 ||
+       pucContents[8] != TRACE_VERSION)
+   {
+      fprintf(stderr, "%s is not a version %d trace\n", pcPath,
+         TRACE_VERSION);
+      exit(EXIT_FAILURE);
+   }
+
+   ppcKeys = makeRoom(NULL, &uKeyCapacity, 0, sizeof(const char*));
+   ppcKeys[0] = NULL;
+
+   sReader.pucNext = pucContents + 9;
+   sReader.pucEnd = pucContents + uLength;
+   while (sReader.pucNext < sReader.pucEnd)
+   {
+      psaRecords = makeRoom(psaRecords, &uCapacity, uRecordCount,
+         sizeof(struct Record));
+      psaRecords[uRecordCount].iOperation = *sReader.pucNext++;
+      psaRecords[uRecordCount].pcKey = NULL;
+      psaRecords[uRecordCount].pcHigh = NULL;
+      psaRecords[uRecordCount].uFirst = 0;
+      psaRecords[uRecordCount].uSecond = 0;
+      if (psaRecords[uRecordCount].iOperation >= TRACE_OPERATIONS)
+         malformed();
+      if (! readRecord(&sReader, &psaRecords[uRecordCount]))
+      {
+         fprintf(stderr, "Trace cut short after %lu calls\n",
+            (unsigned long)uRecordCount);
+         break;
+      }
+      uRecordCount++;
+   }
+   free(pucContents);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return pvValue as the combined value, so that SymTable_upsertWith
+   binds the key to itself as SymTable_put does. */
+
+static void *combineValues(const char *pcKey, void *pvOldValue,
+   void *pvValue, void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvOldValue;
+   (void)pvExtra;
+   return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Do nothing with a binding: the traversals are replayed for their
+   own cost. */
+
+static void visitBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (void)pvExtra;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* End the iterator of number uIter, if it is open, so that the later
+   calls of the trace on it are skipped. */
+
+static void endIterator(size_t uIter)
+{
+   if (poIters[uIter] == NULL)
+      return;
+   SymTable_iterEnd(poIters[uIter]);
+   poIters[uIter] = NULL;
+   puOpenIters[puIterTables[uIter]]--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Built with -DREPLAY_LOCKED_WALKS, for the sharded table, whose open
+   iterator holds a shard's lock between calls, a call on a table
+   first ends every open iterator of the table but uKeep, the
+   iterator that the call is on, or uIterCount for none. Otherwise the
+   call could wait forever for a lock that its own thread holds. */
+
+static void endOtherIterators(size_t uTable, size_t uKeep)
+{
+#ifdef REPLAY_LOCKED_WALKS
+   size_t uLeft = puOpenIters[uTable];
+   size_t u;
+
+   /* The iterator kept, if any, is open and of the table. */
+   if (uKeep < uIterCount)
+      uLeft--;
+   for (u = 0; u < uIterCount && uLeft > 0; u++)
+      if (u != uKeep && poIters[u] != NULL && puIterTables[u] == uTable)
+      {
+         endIterator(u);
+         uLeft--;
+      }
+#else
+   (void)uTable;
+   (void)uKeep;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash of the key of index uKey, computing it if no
+   SymTable_hashKey call of the replay has. */
+
+static size_t getHash(size_t uKey)
+{
+   if (! pcHashed[uKey])
+   {
+      puHashes[uKey] = SymTable_hashKey(ppcKeys[uKey]);
+      pcHashed[uKey] = 1;
+   }
+   return puHashes[uKey];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make the call of psRecord on the implementation linked into this
+   program, binding each key to itself. A call on a table or iterator
+   that could not be made, or has been freed or ended, is skipped. A
+   scan starts where the previous scan of its table left off, since
+   cursors differ from one implementation to another. Exit with
+   EXIT_FAILURE if a table or iterator cannot be made. */
+
+static void replayRecord(const struct Record *psRecord)
+{
+   SymTable_T oSymTable = NULL;
+   const char *pcKey = psRecord->pcKey;
+
+   switch (psRecord->iOperation)
+   {
+      case TRACE_NEW:
+         poTables[psRecord->uObject] = SymTable_new();
+         checkMemory(poTables[psRecord->uObject]);
+         return;
+      case TRACE_NEW_WITH_CAPACITY:
+         poTables[psRecord->uObject] =
+            SymTable_newWithCapacity(psRecord->uFirst);
+         checkMemory(poTables[psRecord->uObject]);
+         return;
+      case TRACE_HASH_KEY:
+         puHashes[psRecord->uFirst] = SymTable_hashKey(pcKey);
+         pcHashed[psRecord->uFirst] = 1;
+         return;
+      case TRACE_ITER_NEXT:
+         if (poIters[psRecord->uObject] == NULL)
+            return;
+         endOtherIterators(puIterTables[psRecord->uObject],
+            psRecord->uObject);
+         SymTable_iterNext(poIters[psRecord->uObject], NULL, NULL);
+         return;
+      case TRACE_ITER_END:
+         endIterator(psRecord->uObject);
+         return;
+      default:
+         oSymTable = poTables[psRecord->uObject];
+         break;
+   }
+   if (oSymTable == NULL)
+      return;
+   endOtherIterators(psRecord->uObject, uIterCount);
+
+   switch (psRecord->iOperation)
+   {
+      case TRACE_FREE:
+         SymTable_free(oSymTable);
+         poTables[psRecord->uObject] = NULL;
+         break;
+      case TRACE_GET_LENGTH:
+         SymTable_getLength(oSymTable);
+         break;
+      case TRACE_GET_STATS:
+         {
+            struct SymTableStats sStats;
+            SymTable_getStats(oSymTable, &sStats);
+         }
+         break;
+      case TRACE_RESERVE:
+         SymTable_reserve(oSymTable, psRecord->uFirst);
+         break;
+      case TRACE_SHRINK_TO_FIT:
+         SymTable_shrinkToFit(oSymTable);
+         break;
+      case TRACE_PUT:
+         SymTable_put(oSymTable, pcKey, pcKey);
+         break;
+      case TRACE_REPLACE:
+         SymTable_replace(oSymTable, pcKey, pcKey);
+         break;
+      case TRACE_CONTAINS:
+         SymTable_contains(oSymTable, pcKey);
+         break;
+      case TRACE_GET:
+         SymTable_get(oSymTable, pcKey);
+         break;
+      case TRACE_GET_BATCH:
+         SymTable_getBatch(oSymTable,
+            ppcBatchKeys + psRecord->uSecond, psRecord->uFirst,
+            ppvBatchValues);
+         break;
+      case TRACE_REMOVE:
+         SymTable_remove(oSymTable, pcKey);
+         break;
+      case TRACE_GET_OR_INSERT:
+         SymTable_getOrInsert(oSymTable, pcKey, pcKey);
+         break;
+      case TRACE_UPSERT_WITH:
+         SymTable_upsertWith(oSymTable, pcKey, pcKey, combineValues,
+            NULL);
+         break;
+      case TRACE_PUT_HASHED:
+         SymTable_putHashed(oSymTable, pcKey,
+            getHash(psRecord->uFirst), pcKey);
+         break;
+      case TRACE_CONTAINS_HASHED:
+         SymTable_containsHashed(oSymTable, pcKey,
+            getHash(psRecord->uFirst));
+         break;
+      case TRACE_GET_HASHED:
+         SymTable_getHashed(oSymTable, pcKey,
+            getHash(psRecord->uFirst));
+         break;
+      case TRACE_MAP:
+         SymTable_map(oSymTable, visitBinding, NULL);
+         break;
+      case TRACE_MAP_PARALLEL:
+         SymTable_mapParallel(oSymTable, visitBinding, NULL,
+            psRecord->uFirst);
+         break;
+      case TRACE_ITER_BEGIN:
+         poIters[psRecord->uFirst] = SymTable_iterBegin(oSymTable);
+         checkMemory(poIters[psRecord->uFirst]);
+         puIterTables[psRecord->uFirst] = psRecord->uObject;
+         puOpenIters[psRecord->uObject]++;
+         break;
+      case TRACE_SCAN:
+         if (psRecord->uFirst == 0)
+            puCursors[psRecord->uObject] = 0;
+         puCursors[psRecord->uObject] = SymTable_scan(oSymTable,
+            puCursors[psRecord->uObject], psRecord->uSecond,
+            visitBinding, NULL);
+         break;
+      case TRACE_MAP_PREFIX:
+         SymTable_mapPrefix(oSymTable, pcKey, visitBinding, NULL);
+         break;
+      default:
+         SymTable_mapRange(oSymTable, pcKey, psRecord->pcHigh,
+            visitBinding, NULL);
+         break;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the tables and iterators that the last replay left, and forget
+   the hashes that it computed. */
+
+static void resetReplay(void)
+{
+   size_t u;
+
+   for (u = 0; u < uIterCount; u++)
+      endIterator(u);
+   for (u = 0; u < uTableCount; u++)
+   {
+      if (poTables[u] != NULL)
+         SymTable_free(poTables[u]);
+      poTables[u] = NULL;
+      puCursors[u] = 0;
+   }
+   memset(pcHashed, 0, uKeyCount + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make every call of the trace in turn, and return the nanoseconds
+   that they took. If adNanoseconds is not NULL, also time each call,
+   less dClockCost, the cost of a read of the clock, and add its time
+   to adNanoseconds[i] for its operation i. */
+
+static double replayTrace(double adNanoseconds[], double dClockCost)
+{
+   double dStart;
+   double dCallStart;
+   size_t u;
+
+   resetReplay();
+   dStart = getNanoseconds();
+   if (adNanoseconds == NULL)
+      for (u = 0; u < uRecordCount; u++)
+         replayRecord(&psaRecords[u]);
+   else
+      for (u = 0; u < uRecordCount; u++)
+      {
+         dCallStart = getNanoseconds();
+         replayRecord(&psaRecords[u]);
+         adNanoseconds[psaRecords[u].iOperation] +=
+            getNanoseconds() - dCallStart - dClockCost;
+      }
+   return getNanoseconds() - dStart;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate the state of a replay of the trace. Exit with EXIT_FAILURE
+   if memory is insufficient. */
+
+static void makeReplay(void)
+{
+   size_t uBatchMax = 1;
+   size_t u;
+
+   for (u = 0; u < uRecordCount; u++)
+      if (psaRecords[u].iOperation == TRACE_GET_BATCH &&
+          psaRecords[u].uFirst > uBatchMax)
+         uBatchMax = psaRecords[u].uFirst;
+
+   poTables = calloc(uTableCount + 1, sizeof(SymTable_T));
+   poIters = calloc(uIterCount + 1, sizeof(SymTableIter_T));
+   puIterTables = calloc(uIterCount + 1, sizeof(size_t));
+   puOpenIters = calloc(uTableCount + 1, sizeof(size_t));
+   puCursors = calloc(uTableCount + 1, sizeof(size_t));
+   puHashes = calloc(uKeyCount + 1, sizeof(size_t));
+   pcHashed = calloc(uKeyCount + 1, 1);
+   ppvBatchValues = calloc(uBatchMax, sizeof(void*));
+   checkMemory(poTables);
+   checkMemory(poIters);
+   checkMemory(puIterTables);
+   checkMemory(puOpenIters);
+   checkMemory(puCursors);
+   checkMemory(puHashes);
+   checkMemory(pcHashed);
+   checkMemory(ppvBatchValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replay the calls of the SymTable ADT recorded in the trace file
+   named by the last argument on the implementation linked into this
+   program, and write to stdout a CSV row per operation of the trace
+   with its number of calls and mean time per call, and a row "all"
+   for the whole trace. The trace is read and decoded before the clock
+   starts. A first pass times the whole trace, for the "all" row; a
+   second times each call. The backend column is the program name
+   less "replaysymtable". With the argument header=0, the header row
+   is left out. As always, argc is the command-line argument count and
+   argv contains the command-line arguments. Exit with EXIT_FAILURE if
+   an argument or the trace is malformed, or memory is insufficient.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   size_t auCounts[TRACE_OPERATIONS];
+   double adNanoseconds[TRACE_OPERATIONS];
+   const char *pcBackend;
+   double dClockCost;
+   double dTotal;
+   int iHeader = 1;
+   size_t u;
+   int i;
+
+   if (argc == 3 && strcmp(argv[1], "header=0") == 0)
+      iHeader = 0;
+   else if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s [header=0] tracefile\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   pcBackend = strrchr(argv[0], '/');
+   pcBackend = pcBackend == NULL ? argv[0] : pcBackend + 1;
+   if (strncmp(pcBackend, "replaysymtable", 14) == 0 &&
+       pcBackend[14] != '\0')
+      pcBackend += 14;
+
+   readTrace(argv[argc - 1]);
+   makeReplay();
+   for (i = 0; i < TRACE_OPERATIONS; i++)
+   {
+      auCounts[i] = 0;
+      adNanoseconds[i] = 0;
+   }
+   for (u = 0; u < uRecordCount; u++)
+      auCounts[psaRecords[u].iOperation]++;
+
+   dClockCost = getClockCost();
+   dTotal = replayTrace(NULL, 0);
+   replayTrace(adNanoseconds, dClockCost);
+   resetReplay();
+
+   if (iHeader)
+      printf("backend,op,count,ns_per_op\n");
+   for (i = 0; i < TRACE_OPERATIONS; i++)
+      if (auCounts[i] != 0)
+         printf("%s,%s,%lu,%.1f\n", pcBackend, apcOperationNames[i],
+            (unsigned long)auCounts[i],
+            adNanoseconds[i] / (double)auCounts[i]);
+   printf("%s,all,%lu,%.1f\n", pcBackend, (unsigned long)uRecordCount,
+      uRecordCount == 0 ? 0.0 : dTotal / (double)uRecordCount);
+
+   for (u = 1; u <= uKeyCount; u++)
+      free((char*)ppcKeys[u]);
+   free(ppcKeys);
+   free(ppcBatchKeys);
+   free(psaRecords);
+   free(poTables);
+   free(poIters);
+   free(puIterTables);
+   free(puOpenIters);
+   free(puCursors);
+   free(puHashes);
+   free(pcHashed);
+   free(ppvBatchValues);
+   return 0;
+}
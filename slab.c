@@ -0,0 +1,178 @@
+/*--------------------------------------------------------------------*/
+/* slab.c                                                             */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "slab.h"
+
+/*--------------------------------------------------------------------*/
+
+/* The sizes in bytes of the first chunk and of the largest chunk. A
+   Slab that only ever holds a few blocks stays small, and a large one
+   allocates few chunks. */
+static const size_t uFirstChunkSize = 256;
+static const size_t uMaxChunkSize = 65536;
+
+/*--------------------------------------------------------------------*/
+
+/* The header placed before every large block. Its size is a multiple
+   of SLAB_GRANULE so the block after it stays aligned. */
+
+struct SlabLarge {
+  /* The previously and next allocated large blocks, or NULL. */
+  struct SlabLarge *psPrev;
+  struct SlabLarge *psNext;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size class of a small block of uSize bytes. */
+static size_t Slab_class(size_t uSize) {
+  assert(uSize > 0 && uSize <= SLAB_MAX_SMALL);
+  return (uSize - 1) / SLAB_GRANULE;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Slab_init(struct Slab *psSlab) {
+  /* Incrementor over the size classes. */
+  size_t i;
+
+  assert(psSlab != NULL);
+
+  psSlab->pvChunks = NULL;
+  psSlab->pcNext = NULL;
+  psSlab->pcEnd = NULL;
+  psSlab->uNextChunkSize = uFirstChunkSize;
+  psSlab->psLarge = NULL;
+  for (i = 0; i < SLAB_CLASS_COUNT; i++)
+    psSlab->apvFree[i] = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *Slab_alloc(struct Slab *psSlab, size_t uSize) {
+  /* The size class of the block and its size rounded up to it. */
+  size_t uClass, uBlockSize;
+
+  /* The block being allocated and a new chunk, if one is needed. */
+  void *pvBlock;
+  char *pcChunk;
+
+  /* The header of a large block. */
+  struct SlabLarge *psLarge;
+
+  assert(psSlab != NULL);
+
+  if (uSize == 0)
+    uSize = 1;
+
+  /* Large blocks get their own memory, linked in front of the other
+     large blocks. */
+  if (uSize > SLAB_MAX_SMALL) {
+    psLarge = (struct SlabLarge *)
+      malloc(sizeof(struct SlabLarge) + uSize);
+    if (psLarge == NULL)
+      return NULL;
+    psLarge->psPrev = NULL;
+    psLarge->psNext = psSlab->psLarge;
+    if (psSlab->psLarge != NULL)
+      psSlab->psLarge->psPrev = psLarge;
+    psSlab->psLarge = psLarge;
+    return psLarge + 1;
+  }
+
+  /* Reuse a released block of the same size class if there is one. */
+  uClass = Slab_class(uSize);
+  if (psSlab->apvFree[uClass] != NULL) {
+    pvBlock = psSlab->apvFree[uClass];
+    psSlab->apvFree[uClass] = *(void **)pvBlock;
+    return pvBlock;
+  }
+
+  /* Otherwise carve the block off the most recent chunk, first
+     allocating a new chunk if the rest of the current one is too
+     small. The rest of the old chunk is abandoned. */
+  uBlockSize = (uClass + 1) * SLAB_GRANULE;
+  if (psSlab->pcNext == NULL ||
+      (size_t)(psSlab->pcEnd - psSlab->pcNext) < uBlockSize)
+  {
+    pcChunk = (char *)malloc(psSlab->uNextChunkSize);
+    if (pcChunk == NULL)
+      return NULL;
+
+    *(void **)pcChunk = psSlab->pvChunks;
+    psSlab->pvChunks = pcChunk;
+    psSlab->pcNext = pcChunk + SLAB_GRANULE;
+    psSlab->pcEnd = pcChunk + psSlab->uNextChunkSize;
+
+    if (psSlab->uNextChunkSize < uMaxChunkSize)
+      psSlab->uNextChunkSize *= 2;
+  }
+
+  pvBlock = psSlab->pcNext;
+  psSlab->pcNext += uBlockSize;
+  return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Slab_release(struct Slab *psSlab, void *pvBlock, size_t uSize) {
+  /* The header of a large block. */
+  struct SlabLarge *psLarge;
+
+  /* The size class of a small block. */
+  size_t uClass;
+
+  assert(psSlab != NULL);
+  assert(pvBlock != NULL);
+
+  if (uSize == 0)
+    uSize = 1;
+
+  /* Unlink a large block and give its memory back right away. */
+  if (uSize > SLAB_MAX_SMALL) {
+    psLarge = (struct SlabLarge *)pvBlock - 1;
+    if (psLarge->psPrev != NULL)
+      psLarge->psPrev->psNext = psLarge->psNext;
+    else
+      psSlab->psLarge = psLarge->psNext;
+    if (psLarge->psNext != NULL)
+      psLarge->psNext->psPrev = psLarge->psPrev;
+    free(psLarge);
+    return;
+  }
+
+  /* Push a small block onto the free list of its size class. */
+  uClass = Slab_class(uSize);
+  *(void **)pvBlock = psSlab->apvFree[uClass];
+  psSlab->apvFree[uClass] = pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Slab_clear(struct Slab *psSlab) {
+  /* The chunk or large block being freed and the next one to free. */
+  void *pvCurrent, *pvNext;
+
+  assert(psSlab != NULL);
+
+  for (pvCurrent = psSlab->pvChunks; pvCurrent != NULL;
+       pvCurrent = pvNext)
+  {
+    pvNext = *(void **)pvCurrent;
+    free(pvCurrent);
+  }
+
+  for (pvCurrent = psSlab->psLarge; pvCurrent != NULL;
+       pvCurrent = pvNext)
+  {
+    pvNext = ((struct SlabLarge *)pvCurrent)->psNext;
+    free(pvCurrent);
+  }
+
+  Slab_init(psSlab);
+}
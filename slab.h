@@ -0,0 +1,77 @@
+/*--------------------------------------------------------------------*/
+/* slab.h                                                             */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#ifndef SLAB_INCLUDED
+#define SLAB_INCLUDED
+
+/* A Slab is an allocator owned by a single SymTable. Small blocks are
+   carved out of chunks that grow geometrically, and released small
+   blocks are kept on per-size free lists for reuse. Blocks larger than
+   SLAB_MAX_SMALL bytes get their own malloc'd memory. Slab_clear
+   releases everything at once, so the owner never has to walk its
+   blocks to free them. A Slab is embedded in its owner, so its fields
+   are visible, but only the functions below may touch them. */
+
+/* The largest block size, in bytes, served from chunks. */
+enum {SLAB_MAX_SMALL = 128};
+
+/* Small block sizes are rounded up to a multiple of this many bytes,
+   which is also the alignment of every block. */
+enum {SLAB_GRANULE = 16};
+
+/* The number of small size classes, one per granule multiple. */
+enum {SLAB_CLASS_COUNT = SLAB_MAX_SMALL / SLAB_GRANULE};
+
+struct Slab {
+  /* The most recently allocated chunk, whose first bytes link to the
+     previously allocated chunk, or NULL if there are no chunks. */
+  void *pvChunks;
+
+  /* The unused bytes at the end of the most recent chunk. */
+  char *pcNext;
+  char *pcEnd;
+
+  /* The size in bytes of the next chunk to allocate. */
+  size_t uNextChunkSize;
+
+  /* The header of the most recently allocated large block, or NULL.
+     Large blocks are doubly linked so that releasing one is O(1). */
+  struct SlabLarge *psLarge;
+
+  /* The first released block of each small size class, or NULL. Each
+     released block begins with a pointer to the next one. */
+  void *apvFree[SLAB_CLASS_COUNT];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Initialize psSlab to own no memory. */
+
+void Slab_init(struct Slab *psSlab);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of at least uSize bytes owned by psSlab, aligned to
+   SLAB_GRANULE bytes, or NULL if insufficient memory is available. */
+
+void *Slab_alloc(struct Slab *psSlab, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the block pvBlock, which psSlab allocated with size uSize, to
+   psSlab for reuse. */
+
+void Slab_release(struct Slab *psSlab, void *pvBlock, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory owned by psSlab, invalidating every block it has
+   allocated, and leave psSlab owning no memory. */
+
+void Slab_clear(struct Slab *psSlab);
+
+#endif
@@ -0,0 +1,244 @@
+/*--------------------------------------------------------------------*/
+/* strhash.c                                                          */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* pthread_once() is POSIX. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "strhash.h"
+
+#ifndef __GNUC__
+#error "strhash.c needs the GCC __atomic builtins"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The odd constants mixed into the state at each step. */
+static const uint64_t auSecrets[4] = {
+  0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+  0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Replace *puA and *puB with the low and high halves of the 128-bit
+   product of *puA and *puB. */
+static void StrHash_multiply(uint64_t *puA, uint64_t *puB) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 uint128;
+  uint128 uProduct = (uint128)*puA * *puB;
+
+  *puA = (uint64_t)uProduct;
+  *puB = (uint64_t)(uProduct >> 64);
+#else
+  /* Multiply the 32-bit halves and carry between them. */
+  uint64_t uHighA = *puA >> 32, uHighB = *puB >> 32;
+  uint64_t uLowA = (uint32_t)*puA, uLowB = (uint32_t)*puB;
+  uint64_t uHigh = uHighA * uHighB, uMid0 = uHighA * uLowB;
+  uint64_t uMid1 = uHighB * uLowA, uLow = uLowA * uLowB;
+  uint64_t uSum, uCarry;
+
+  uSum = uLow + (uMid0 << 32);
+  uCarry = uSum < uLow;
+  uLow = uSum + (uMid1 << 32);
+  uCarry += uLow < uSum;
+  uHigh += (uMid0 >> 32) + (uMid1 >> 32) + uCarry;
+
+  *puA = uLow;
+  *puB = uHigh;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the xor of the low and high halves of the 128-bit product of
+   uA and uB. */
+static uint64_t StrHash_mix(uint64_t uA, uint64_t uB) {
+  StrHash_multiply(&uA, &uB);
+  return uA ^ uB;
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLE_BYTEWISE_HASH
+
+/* Return the 8 bytes at pc as an integer. */
+static uint64_t StrHash_read8(const char *pc) {
+  uint64_t u;
+  memcpy(&u, pc, sizeof(u));
+  return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the 4 bytes at pc as an integer. */
+static uint64_t StrHash_read4(const char *pc) {
+  uint32_t u;
+  memcpy(&u, pc, sizeof(u));
+  return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t StrHash_hash(const char *pcKey, size_t uSeed) {
+  /* The number of bytes of pcKey, and the number left to consume. */
+  size_t uLength, uLeft;
+
+  /* The running state and the two words of the final multiply. */
+  uint64_t uState, uA, uB;
+
+  /* The two extra lanes used for keys longer than 48 bytes. */
+  uint64_t uLane1, uLane2;
+
+  /* The offset of the middle words read from keys of 4 to 16 bytes. */
+  size_t uMiddle;
+
+  /* The bytes of pcKey not consumed yet. */
+  const char *pc = pcKey;
+
+  assert(pcKey != NULL);
+
+  uLength = strlen(pcKey);
+  uState = (uint64_t)uSeed;
+  uState ^= StrHash_mix(uState ^ auSecrets[0], auSecrets[1]);
+
+  if (uLength <= 16) {
+    /* Short keys are covered by (possibly overlapping) reads from both
+       ends. */
+    if (uLength >= 4) {
+      uMiddle = (uLength >> 3) << 2;
+      uA = (StrHash_read4(pc) << 32) | StrHash_read4(pc + uMiddle);
+      uB = (StrHash_read4(pc + uLength - 4) << 32) |
+           StrHash_read4(pc + uLength - 4 - uMiddle);
+    }
+    else if (uLength > 0) {
+      uA = ((uint64_t)(unsigned char)pc[0] << 16) |
+           ((uint64_t)(unsigned char)pc[uLength >> 1] << 8) |
+           (uint64_t)(unsigned char)pc[uLength - 1];
+      uB = 0;
+    }
+    else
+      uA = uB = 0;
+  }
+  else {
+    uLeft = uLength;
+
+    /* Long keys are consumed 48 bytes at a time in three independent
+       lanes, so the multiplies of one step can overlap. */
+    if (uLeft > 48) {
+      uLane1 = uLane2 = uState;
+      do {
+        uState = StrHash_mix(StrHash_read8(pc) ^ auSecrets[1],
+                             StrHash_read8(pc + 8) ^ uState);
+        uLane1 = StrHash_mix(StrHash_read8(pc + 16) ^ auSecrets[2],
+                             StrHash_read8(pc + 24) ^ uLane1);
+        uLane2 = StrHash_mix(StrHash_read8(pc + 32) ^ auSecrets[3],
+                             StrHash_read8(pc + 40) ^ uLane2);
+        pc += 48;
+        uLeft -= 48;
+      } while (uLeft > 48);
+      uState ^= uLane1 ^ uLane2;
+    }
+
+    while (uLeft > 16) {
+      uState = StrHash_mix(StrHash_read8(pc) ^ auSecrets[1],
+                           StrHash_read8(pc + 8) ^ uState);
+      pc += 16;
+      uLeft -= 16;
+    }
+
+    /* The last 16 bytes of the key, overlapping consumed ones. */
+    uA = StrHash_read8(pc + uLeft - 16);
+    uB = StrHash_read8(pc + uLeft - 8);
+  }
+
+  uA ^= auSecrets[1];
+  uB ^= uState;
+  StrHash_multiply(&uA, &uB);
+  return (size_t)StrHash_mix(uA ^ auSecrets[0] ^ uLength,
+                             uB ^ auSecrets[1]);
+}
+
+#else
+
+size_t StrHash_hash(const char *pcKey, size_t uSeed)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = uSeed;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+
+   /* The low bits of the polynomial hash depend only on the last few
+      characters, so mix the high bits into them. */
+   uHash *= (size_t)0x9E3779B97F4A7C15ULL;
+   return uHash ^ (uHash >> 15) ^ (uHash >> 27);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The seed shared by every table of the process, drawn once by
+   StrHash_drawProcessSeed under sProcessSeedOnce. */
+static size_t uProcessSeed;
+static pthread_once_t sProcessSeedOnce = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------*/
+
+size_t StrHash_newSeed(const void *pvSalt) {
+  /* Distinguishes seeds requested with the same salt. Tables may be
+     created on many threads at once, so it is incremented atomically,
+     and each call gets a value of its own. */
+  static uint64_t uCounter = 0;
+
+  /* This call's value of uCounter. */
+  uint64_t uCount = __atomic_add_fetch(&uCounter, 1, __ATOMIC_RELAXED);
+
+  /* The clock is read only once per process, by StrHash_processSeed,
+     so that creating a table makes no system calls. Seeds stay hard to
+     predict because the process seed is. */
+  return (size_t)StrHash_mix(
+    (uint64_t)StrHash_processSeed() ^ (uint64_t)(size_t)pvSalt ^
+    auSecrets[2], uCount ^ auSecrets[3]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Draw uProcessSeed from the clock and the address space layout. */
+static void StrHash_drawProcessSeed(void) {
+  /* Sources that vary between processes. The address of uProcessSeed
+     varies between processes under ASLR. */
+  uint64_t uTime, uAddress;
+
+  uTime = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32);
+  uAddress = (uint64_t)(size_t)&uProcessSeed << 17;
+  uProcessSeed = (size_t)StrHash_mix(uTime ^ auSecrets[2],
+                                     uAddress ^ auSecrets[3]);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t StrHash_processSeed(void) {
+  /* The first call on any thread draws the seed; the others wait for
+     it, and see it drawn. */
+  pthread_once(&sProcessSeedOnce, StrHash_drawProcessSeed);
+  return uProcessSeed;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t StrHash_mixSeed(size_t uHash, size_t uSeed) {
+  return (size_t)StrHash_mix((uint64_t)uHash ^ auSecrets[0],
+                             (uint64_t)uSeed ^ auSecrets[1]);
+}
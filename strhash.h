@@ -0,0 +1,49 @@
+/*--------------------------------------------------------------------*/
+/* strhash.h                                                          */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#ifndef STRHASH_INCLUDED
+#define STRHASH_INCLUDED
+
+/* StrHash computes seeded hash codes of strings for the hash table
+   implementations of the SymTable ADT. By default it reads 8 bytes per
+   step in the style of wyhash. Compiling strhash.c with
+   -DSYMTABLE_BYTEWISE_HASH selects the original one-byte-per-step
+   65599 hash instead, for comparison. */
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for the string pcKey under the seed uSeed. Every
+   bit of the result depends on every byte of pcKey and on uSeed. */
+
+size_t StrHash_hash(const char *pcKey, size_t uSeed);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new, hard to predict seed. pvSalt, typically the address of
+   the object that will use the seed, is mixed into it along with a
+   counter, so that no two calls return the same seed. It is derived
+   from the process seed and reads no clock. */
+
+size_t StrHash_newSeed(const void *pvSalt);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the seed shared by every table of the process. It is drawn
+   from the clock and the address space layout on the first call, which
+   may be made on any thread. */
+
+size_t StrHash_processSeed(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Return uHash, a hash code under the process seed, rehashed under the
+   seed uSeed of one table. This costs one multiply, so a key hashed
+   once can be looked up in many tables with different seeds. */
+
+size_t StrHash_mixSeed(size_t uHash, size_t uSeed);
+
+#endif
@@ -13,6 +13,57 @@
 
 typedef struct SymTable *SymTable_T;
 
+/* A SymTableIter_T object is a position in a traversal of the
+   bindings of a SymTable_T object. */
+
+typedef struct SymTableIter *SymTableIter_T;
+
+/* The number of entries in the chain-length histogram of a struct
+   SymTableStats. */
+
+enum {SYMTABLE_STATS_CHAINS = 8};
+
+/* The shape and memory of a SymTable_T object, as reported by
+   SymTable_getStats. A chain is the run of bindings that a lookup may
+   compare its key with: the node chain of a bucket in the chained
+   tables, or the whole list, which counts as one bucket, as does the
+   inline array of a small chained table. In the Swiss table a bucket
+   is a group of 16 slots, and a chain is the number of full groups
+   that a lookup which starts at that group probes before it reaches a
+   group with an empty slot. The radix tree has no buckets or
+   chains. */
+
+struct SymTableStats {
+  /* The number of bindings. */
+  size_t uLength;
+
+  /* The number of buckets. */
+  size_t uBucketCount;
+
+  /* The number of bindings per bucket, or per slot in the Swiss
+     table, or 0 if there are no buckets. */
+  double dLoadFactor;
+
+  /* The length of the longest chain. */
+  size_t uLongestChain;
+
+  /* auChainCounts[i] is the number of chains of length i, except that
+     the last entry counts every chain of SYMTABLE_STATS_CHAINS - 1 or
+     more. */
+  size_t auChainCounts[SYMTABLE_STATS_CHAINS];
+
+  /* The number of times the table has resized since it was created. */
+  size_t uResizeCount;
+
+  /* The bytes taken by the nodes, less their keys; by the keys, with
+     their terminating null characters; and by the buckets arrays,
+     with the control bytes or bitmaps that go with them. Allocator
+     overhead is not counted. */
+  size_t uNodeBytes;
+  size_t uKeyBytes;
+  size_t uBucketBytes;
+};
+
 /*--------------------------------------------------------------------*/
 
 /* Return a new SymTable_T object, or NULL if insufficient memory is
@@ -22,6 +73,13 @@ SymTable_T SymTable_new(void);
 
 /*--------------------------------------------------------------------*/
 
+/* Return a new SymTable_T object sized to hold uCapacity bindings
+   without resizing, or NULL if insufficient memory is available. */
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
 /* Free oSymTable. */
 
 void SymTable_free(SymTable_T oSymTable);
@@ -34,6 +92,51 @@ size_t SymTable_getLength(SymTable_T oSymTable);
 
 /*--------------------------------------------------------------------*/
 
+/* Fills in *psStats with the shape and memory of oSymTable, taking
+   time in proportion to its bindings and buckets. Meant for
+   monitoring, such as an alert when chains grow long. */
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats);
+
+#ifdef SYMTABLE_PROFILE
+#include <stdio.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Writes to psFile the counts of the SymTable_get, SymTable_put,
+   SymTable_remove and SymTable_replace calls on oSymTable since it was
+   created: their hits and misses, the bindings they probed, the strcmp
+   calls they made, and a histogram of the latency of a sample of them.
+   Exists only in a build with SYMTABLE_PROFILE defined; see
+   profile.h. */
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile);
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Makes room in oSymTable for a total of uCapacity bindings, so that
+   putting bindings until oSymTable holds uCapacity of them never
+   resizes it. Never shrinks oSymTable. Returns 1 if successful, or 0 
+   if insufficient memory is available, in which case oSymTable is
+   unchanged. */
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Shrinks the memory held by oSymTable to about what its bindings
+   need, undoing any SymTable_reserve. Removals already shrink a table
+   whose load has fallen far, but only so far, and keep the memory of
+   removed bindings for reuse; this call returns that memory as well.
+   Returns 1 if successful, or 0 if insufficient memory is available
+   for the copies it makes, in which case oSymTable is unchanged. */
+
+int SymTable_shrinkToFit(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
 /* Put a new binding, with pcKey as its key and pvValue as its value,
    into oSymTable. Returns 1 if put was successful, or 0 if insufficient
    memory is available. */
@@ -67,6 +170,18 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
 
 /*--------------------------------------------------------------------*/
 
+/* Looks up each of the uCount keys apcKeys[0..uCount-1] in oSymTable
+   and sets apvOut[i] to the value of the binding whose key is
+   apcKeys[i], or to NULL if no such binding exists, exactly as 
+   SymTable_get would. The lookups are interleaved so that their memory
+   accesses overlap, which makes a large batch faster than uCount calls
+   of SymTable_get. */
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[]);
+
+/*--------------------------------------------------------------------*/
+
 /* Removes the binding in oSymTable which has the key pcKey. Returns the
    value of the binding if it exists in oSymTable before removal, or
    NULL if no such binding exists in oSymTable before attempting 
@@ -76,6 +191,70 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
 /*--------------------------------------------------------------------*/
 
+/* Finds the binding in oSymTable which has the key pcKey, first putting
+   a new binding with key pcKey and value pvValue into oSymTable if no
+   such binding exists. Returns the address of the binding's value, 
+   through which the value may be read or changed, or NULL if 
+   insufficient memory is available. The address is valid until the 
+   next call that puts or removes a binding of oSymTable, or that 
+   reserves or shrinks it, on any thread. In a table that threads
+   share, another thread may make such a call at any moment, so they
+   should change values with SymTable_upsertWith instead. The key is
+   hashed and looked up only once. */
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* If a binding exists in oSymTable which has the key pcKey, replaces 
+   its value with the value returned by pfCombine, which is called with
+   pcKey, the binding's current value, pvValue, and pvExtra. Otherwise 
+   puts a new binding, with pcKey as its key and pvValue as its value, 
+   into oSymTable. Returns 1 if successful, or 0 if insufficient memory
+   is available. The key is hashed and looked up only once. */
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Returns an opaque hash token for the key pcKey. The token is the 
+   same for every SymTable of the process, so a key that is looked up 
+   in many SymTables, such as nested scopes, need only be hashed once. 
+   Tokens are meaningful only within the process that computed them. */
+
+size_t SymTable_hashKey(const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Like SymTable_put, but uses uHashKey, which must be the token
+   returned by SymTable_hashKey for pcKey, instead of hashing pcKey. */
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Like SymTable_contains, but uses uHashKey, which must be the token
+   returned by SymTable_hashKey for pcKey, instead of hashing pcKey. */
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Like SymTable_get, but uses uHashKey, which must be the token
+   returned by SymTable_hashKey for pcKey, instead of hashing pcKey. */
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey);
+
+/*--------------------------------------------------------------------*/
+
 /* Applies the function pfApply, with an optional paramter pvExtra, to 
    all bindings in oSymTable. */
 
@@ -83,4 +262,90 @@ void SymTable_map(SymTable_T oSymTable,
   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
   const void *pvExtra);
 
+/*--------------------------------------------------------------------*/
+
+/* Applies the function pfApply to all bindings in oSymTable like
+   SymTable_map, but on uThreadCount threads at once, the calling
+   thread among them. Thread i, from 0 to uThreadCount - 1, passes
+   apvExtras[i] as pvExtra, so that each thread can reduce into state
+   of its own, to be combined once the call returns; apvExtras may be
+   NULL to pass NULL. pfApply runs on different bindings concurrently
+   and must not call any function on oSymTable, which must not change
+   during the call. If threads are unavailable, fewer threads apply
+   pfApply. */
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new iterator positioned before the first binding of
+   oSymTable, or NULL if insufficient memory is available. The
+   bindings come in no particular order, each once, as long as
+   oSymTable is not changed until SymTable_iterEnd. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
+/* Advance oIter to the next binding of its table and store its key in
+   *ppcKey and its value in *ppvValue, unless ppcKey or ppvValue is
+   NULL. Return 1 if there was a next binding, or 0 (storing nothing)
+   if every binding has been visited. */
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oIter, which may be stopped before its last binding. */
+
+void SymTable_iterEnd(SymTableIter_T oIter);
+
+/*--------------------------------------------------------------------*/
+
+/* Applies the function pfApply, with an optional parameter pvExtra,
+   to the bindings of the next uBudget (at least 1) buckets of
+   oSymTable, starting at uCursor: 0 to begin a scan, or the cursor
+   that the previous call of the scan returned. Returns the cursor to
+   pass to the next call, or 0 once the scan is complete. The table
+   may change between calls, even resize: every binding that is in it
+   for the whole scan is visited at least once, though it may be
+   visited more than once. Bindings put or removed during the scan may
+   or may not be visited. pfApply must not change oSymTable. */
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Applies the function pfApply, with an optional parameter pvExtra,
+   to the bindings of oSymTable whose keys begin with pcPrefix, in
+   increasing strcmp order of their keys. Returns 1 if successful, or
+   0 if insufficient memory is available to order the bindings, in
+   which case pfApply is not called. pfApply must not change
+   oSymTable. */
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Applies the function pfApply, with an optional parameter pvExtra,
+   to the bindings of oSymTable whose keys are at least pcLow and less
+   than pcHigh, in increasing strcmp order of their keys. pcLow or
+   pcHigh may be NULL to leave the range unbounded below or above.
+   Returns 1 if successful, or 0 if insufficient memory is available
+   to order the bindings, in which case pfApply is not called.
+   pfApply must not change oSymTable. */
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
 #endif
\ No newline at end of file
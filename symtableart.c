@@ -0,0 +1,2039 @@
+/*--------------------------------------------------------------------*/
+/* symtableart.c                                                      */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "slab.h"
+#include "workpool.h"
+#include "profile.h"
+
+/* An adaptive radix tree ("ART"): a trie over the bytes of the keys,
+   terminating null character included, so that no key is a prefix of
+   another. Each inner node branches on one byte, and is one of four
+   kinds sized for 4, 16, 48 or 256 children, so that sparse nodes stay
+   small and dense ones index their children directly. A chain of
+   inner nodes with one child each is compressed into the prefix bytes
+   of the node below it, and a leaf holds only the bytes of its key
+   below its parent. So keys that share long prefixes share the memory
+   of those prefixes, and no node holds a whole key. Walks visit the
+   children of each node in byte order, which is the order of strcmp
+   over the keys.
+
+   A walk rebuilds each key in a buffer of its own as it descends, so
+   the keys that SymTable_map and the other walks pass to pfApply, and
+   that an iterator stores, are valid only until the next binding is
+   visited. */
+
+/*--------------------------------------------------------------------*/
+
+/* The kinds of nodes. */
+enum {NODE_LEAF, NODE_4, NODE_16, NODE_48, NODE_256};
+
+/* The child count below which a node of each kind is copied into a
+   node of the next smaller kind, leaving room to grow again so that
+   alternating puts and removals do not copy nodes back and forth. */
+enum {SHRINK_16 = 3, SHRINK_48 = 12, SHRINK_256 = 40};
+
+/* The number of unfinished scans of a table whose next keys the table
+   remembers. */
+enum {SCAN_SLOTS = 4};
+
+/*--------------------------------------------------------------------*/
+
+/* The first member of every node, which tells its kind. */
+
+struct SymTableNode {
+  /* NODE_LEAF, NODE_4, NODE_16, NODE_48 or NODE_256. */
+  unsigned char ucType;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A binding. Each leaf is a single block that ends with the bytes of
+   its key that follow its parent's branch byte. */
+
+struct SymTableLeaf {
+  /* The node header, of kind NODE_LEAF. */
+  struct SymTableNode sNode;
+
+  /* The generic value. */
+  void *pvValue;
+
+  /* The rest of the key, or "" if the parent branched on the key's
+     terminating null character. */
+  char acSuffix[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The part that every inner node shares. Each inner node is a single
+   block that ends with its prefix: the key bytes, never null, that
+   every key below it has between its parent's branch byte and its own
+   branch byte. */
+
+struct SymTableInner {
+  /* The node header. */
+  struct SymTableNode sNode;
+
+  /* The number of children, from 1 to the capacity of the kind. */
+  unsigned short usChildCount;
+
+  /* The number of prefix bytes. */
+  size_t uPrefixLength;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* An inner node with up to 4 or up to 16 children, whose branch bytes
+   are kept in increasing order, each with its child at the same
+   index. */
+
+struct SymTableNode4 {
+  struct SymTableInner sInner;
+  unsigned char aucBytes[4];
+  struct SymTableNode *apsChildren[4];
+};
+
+struct SymTableNode16 {
+  struct SymTableInner sInner;
+  unsigned char aucBytes[16];
+  struct SymTableNode *apsChildren[16];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* An inner node with up to 48 children, kept in the first
+   usChildCount elements of apsChildren. aucIndexes maps each branch
+   byte to 1 more than the index of its child, or to 0. */
+
+struct SymTableNode48 {
+  struct SymTableInner sInner;
+  unsigned char aucIndexes[256];
+  struct SymTableNode *apsChildren[48];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* An inner node with a child, or NULL, for every branch byte. */
+
+struct SymTableNode256 {
+  struct SymTableInner sInner;
+  struct SymTableNode *apsChildren[256];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The key at which an unfinished scan goes on (see SymTable_scan). */
+
+struct SymTableScanSlot {
+  /* The key, and the size of its buffer, or NULL and 0. */
+  char *pcKey;
+  size_t uCapacity;
+
+  /* The serial number of the cursor that refers to the key, or 0. */
+  size_t uSerial;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable structure is a "manager" structure that points to the
+   root of the tree; it owns the slab from which all of its nodes are
+   allocated. */
+
+struct SymTable {
+  /* The root node, or NULL if the table is empty. */
+  struct SymTableNode *psRoot;
+
+  /* The total number of bindings in SymTable. */
+  size_t uLength;
+
+  /* The buffer in which walks rebuild keys when memory for one of
+     their own is insufficient, and its size, which is more than the
+     length of any key ever put. Since each inner node consumes at
+     least one key byte, it also bounds the depth of the tree. */
+  char *pcKeyBuffer;
+  size_t uKeyCapacity;
+
+  /* The next keys of the last SCAN_SLOTS scans that stopped, each in
+     the slot that its serial number picks, and the serial number of
+     the last one. */
+  struct SymTableScanSlot asScanSlots[SCAN_SLOTS];
+  size_t uScanSerial;
+
+  /* The allocator of this table's nodes. */
+  struct Slab sSlab;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table; see profile.h. */
+  struct Profile sProfile;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size in bytes of the fixed part of an inner node of kind
+   ucType, which its prefix follows. */
+static size_t SymTable_fixedSize(unsigned char ucType) {
+  switch (ucType) {
+    case NODE_4:
+      return sizeof(struct SymTableNode4);
+    case NODE_16:
+      return sizeof(struct SymTableNode16);
+    case NODE_48:
+      return sizeof(struct SymTableNode48);
+    default:
+      assert(ucType == NODE_256);
+      return sizeof(struct SymTableNode256);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the largest number of children of an inner node of kind
+   ucType. */
+static size_t SymTable_capacity(unsigned char ucType) {
+  switch (ucType) {
+    case NODE_4:
+      return 4;
+    case NODE_16:
+      return 16;
+    case NODE_48:
+      return 48;
+    default:
+      assert(ucType == NODE_256);
+      return 256;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size in bytes of an inner node of kind ucType with
+   uPrefixLength prefix bytes, and of a leaf whose suffix has
+   uSuffixLength characters. */
+static size_t SymTable_innerSize(unsigned char ucType,
+                                 size_t uPrefixLength)
+{
+  return SymTable_fixedSize(ucType) + uPrefixLength;
+}
+
+static size_t SymTable_leafSize(size_t uSuffixLength) {
+  return offsetof(struct SymTableLeaf, acSuffix) + uSuffixLength + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the prefix bytes of psInner. */
+static char *SymTable_prefix(struct SymTableInner *psInner) {
+  assert(psInner != NULL);
+
+  return (char *)psInner + SymTable_fixedSize(psInner->sNode.ucType);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the branch bytes of psInner, of kind NODE_4 or NODE_16. */
+static unsigned char *SymTable_bytes(struct SymTableInner *psInner) {
+  assert(psInner != NULL);
+
+  if (psInner->sNode.ucType == NODE_4)
+    return ((struct SymTableNode4 *)psInner)->aucBytes;
+  assert(psInner->sNode.ucType == NODE_16);
+  return ((struct SymTableNode16 *)psInner)->aucBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the array of children of psInner. */
+static struct SymTableNode **SymTable_children(
+  struct SymTableInner *psInner)
+{
+  assert(psInner != NULL);
+
+  switch (psInner->sNode.ucType) {
+    case NODE_4:
+      return ((struct SymTableNode4 *)psInner)->apsChildren;
+    case NODE_16:
+      return ((struct SymTableNode16 *)psInner)->apsChildren;
+    case NODE_48:
+      return ((struct SymTableNode48 *)psInner)->apsChildren;
+    default:
+      assert(psInner->sNode.ucType == NODE_256);
+      return ((struct SymTableNode256 *)psInner)->apsChildren;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new leaf of oSymTable with value pvValue and room for a
+   suffix of uSuffixLength characters, which the caller fills in, or
+   NULL if insufficient memory is available. */
+static struct SymTableLeaf *SymTable_newLeaf(SymTable_T oSymTable,
+  size_t uSuffixLength, const void *pvValue)
+{
+  /* The new leaf. */
+  struct SymTableLeaf *psLeaf;
+
+  assert(oSymTable != NULL);
+
+  psLeaf = (struct SymTableLeaf *)
+    Slab_alloc(&oSymTable->sSlab, SymTable_leafSize(uSuffixLength));
+  if (psLeaf == NULL)
+    return NULL;
+
+  psLeaf->sNode.ucType = NODE_LEAF;
+  psLeaf->pvValue = (void *)pvValue;
+  psLeaf->acSuffix[uSuffixLength] = '\0';
+  return psLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new inner node of oSymTable of kind ucType with no children
+   and room for uPrefixLength prefix bytes, which the caller fills in,
+   or NULL if insufficient memory is available. */
+static struct SymTableInner *SymTable_newInner(SymTable_T oSymTable,
+  unsigned char ucType, size_t uPrefixLength)
+{
+  /* The new node. */
+  struct SymTableInner *psInner;
+
+  /* Incrementor over the children of a NODE_256. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  psInner = (struct SymTableInner *)
+    Slab_alloc(&oSymTable->sSlab,
+               SymTable_innerSize(ucType, uPrefixLength));
+  if (psInner == NULL)
+    return NULL;
+
+  psInner->sNode.ucType = ucType;
+  psInner->usChildCount = 0;
+  psInner->uPrefixLength = uPrefixLength;
+  if (ucType == NODE_48)
+    memset(((struct SymTableNode48 *)psInner)->aucIndexes, 0, 256);
+  else if (ucType == NODE_256)
+    for (u = 0; u < 256; u++)
+      ((struct SymTableNode256 *)psInner)->apsChildren[u] = NULL;
+  return psInner;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size in bytes of psNode, a leaf or an inner node. */
+static size_t SymTable_nodeSize(struct SymTableNode *psNode) {
+  assert(psNode != NULL);
+
+  if (psNode->ucType == NODE_LEAF)
+    return SymTable_leafSize(
+      strlen(((struct SymTableLeaf *)psNode)->acSuffix));
+  return SymTable_innerSize(psNode->ucType,
+    ((struct SymTableInner *)psNode)->uPrefixLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return psNode, a leaf or an inner node, to the slab of
+   oSymTable. */
+static void SymTable_release(SymTable_T oSymTable,
+                             struct SymTableNode *psNode)
+{
+  assert(oSymTable != NULL);
+  assert(psNode != NULL);
+
+  Slab_release(&oSymTable->sSlab, psNode, SymTable_nodeSize(psNode));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link to the child of psInner on branch
+   byte ucByte, or NULL if there is no such child. */
+static struct SymTableNode **SymTable_findChild(
+  struct SymTableInner *psInner, unsigned char ucByte)
+{
+  /* The branch bytes of a NODE_4 or NODE_16, and the index of a child
+     of a NODE_48. */
+  unsigned char *pucBytes;
+  unsigned char ucIndex;
+
+  /* Incrementor over the children. */
+  size_t u;
+
+  assert(psInner != NULL);
+
+  switch (psInner->sNode.ucType) {
+    case NODE_4:
+    case NODE_16:
+      pucBytes = SymTable_bytes(psInner);
+      for (u = 0; u < psInner->usChildCount && pucBytes[u] <= ucByte;
+           u++)
+        if (pucBytes[u] == ucByte)
+          return &SymTable_children(psInner)[u];
+      return NULL;
+    case NODE_48:
+      ucIndex = ((struct SymTableNode48 *)psInner)->aucIndexes[ucByte];
+      return ucIndex == 0 ?
+        NULL : &SymTable_children(psInner)[ucIndex - 1];
+    default:
+      return SymTable_children(psInner)[ucByte] == NULL ?
+        NULL : &SymTable_children(psInner)[ucByte];
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the child of psInner with the lowest branch byte that is at
+   least uFrom, storing that byte in *pucByte, or NULL if there is no
+   such child. uFrom may be 256. */
+static struct SymTableNode *SymTable_nextChild(
+  struct SymTableInner *psInner, unsigned uFrom, unsigned char *pucByte)
+{
+  /* The branch bytes of a NODE_4 or NODE_16, and the indexes of a
+     NODE_48. */
+  unsigned char *pucBytes;
+  unsigned char *pucIndexes;
+
+  /* Incrementor over the children or the branch bytes. */
+  unsigned u;
+
+  assert(psInner != NULL);
+  assert(pucByte != NULL);
+
+  switch (psInner->sNode.ucType) {
+    case NODE_4:
+    case NODE_16:
+      pucBytes = SymTable_bytes(psInner);
+      for (u = 0; u < psInner->usChildCount; u++)
+        if (pucBytes[u] >= uFrom) {
+          *pucByte = pucBytes[u];
+          return SymTable_children(psInner)[u];
+        }
+      return NULL;
+    case NODE_48:
+      pucIndexes = ((struct SymTableNode48 *)psInner)->aucIndexes;
+      for (u = uFrom; u < 256; u++)
+        if (pucIndexes[u] != 0) {
+          *pucByte = (unsigned char)u;
+          return SymTable_children(psInner)[pucIndexes[u] - 1];
+        }
+      return NULL;
+    default:
+      for (u = uFrom; u < 256; u++)
+        if (SymTable_children(psInner)[u] != NULL) {
+          *pucByte = (unsigned char)u;
+          return SymTable_children(psInner)[u];
+        }
+      return NULL;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psChild the child of psInner on branch byte ucByte, which has
+   no child. psInner must have room for another child. */
+static void SymTable_putChild(struct SymTableInner *psInner,
+  unsigned char ucByte, struct SymTableNode *psChild)
+{
+  /* The branch bytes and the children of psInner. */
+  unsigned char *pucBytes;
+  struct SymTableNode **ppsChildren = SymTable_children(psInner);
+
+  /* The index at which the child goes. */
+  size_t u;
+
+  assert(psInner != NULL);
+  assert(psChild != NULL);
+  assert(psInner->usChildCount <
+         SymTable_capacity(psInner->sNode.ucType));
+  assert(SymTable_findChild(psInner, ucByte) == NULL);
+
+  switch (psInner->sNode.ucType) {
+    case NODE_4:
+    case NODE_16:
+      /* Keep the branch bytes in order. */
+      pucBytes = SymTable_bytes(psInner);
+      for (u = psInner->usChildCount; u > 0 && pucBytes[u - 1] > ucByte;
+           u--) {
+        pucBytes[u] = pucBytes[u - 1];
+        ppsChildren[u] = ppsChildren[u - 1];
+      }
+      pucBytes[u] = ucByte;
+      ppsChildren[u] = psChild;
+      break;
+    case NODE_48:
+      ppsChildren[psInner->usChildCount] = psChild;
+      ((struct SymTableNode48 *)psInner)->aucIndexes[ucByte] =
+        (unsigned char)(psInner->usChildCount + 1);
+      break;
+    default:
+      ppsChildren[ucByte] = psChild;
+      break;
+  }
+  psInner->usChildCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the child of psInner on branch byte ucByte, which exists,
+   without releasing it. */
+static void SymTable_dropChild(struct SymTableInner *psInner,
+                               unsigned char ucByte)
+{
+  /* The branch bytes, the indexes, and the children of psInner. */
+  unsigned char *pucBytes;
+  unsigned char *pucIndexes;
+  struct SymTableNode **ppsChildren = SymTable_children(psInner);
+
+  /* The index of the child, and the index of the last child. */
+  size_t u;
+  size_t uLast;
+
+  /* Incrementor over the branch bytes. */
+  unsigned uByte;
+
+  assert(psInner != NULL);
+  assert(SymTable_findChild(psInner, ucByte) != NULL);
+
+  uLast = (size_t)psInner->usChildCount - 1;
+  switch (psInner->sNode.ucType) {
+    case NODE_4:
+    case NODE_16:
+      pucBytes = SymTable_bytes(psInner);
+      for (u = 0; pucBytes[u] != ucByte; u++)
+        ;
+      for (; u < uLast; u++) {
+        pucBytes[u] = pucBytes[u + 1];
+        ppsChildren[u] = ppsChildren[u + 1];
+      }
+      break;
+    case NODE_48:
+      /* Keep the children packed by moving the last one into the
+         hole. */
+      pucIndexes = ((struct SymTableNode48 *)psInner)->aucIndexes;
+      u = (size_t)pucIndexes[ucByte] - 1;
+      pucIndexes[ucByte] = 0;
+      if (u != uLast) {
+        for (uByte = 0; pucIndexes[uByte] != uLast + 1; uByte++)
+          ;
+        ppsChildren[u] = ppsChildren[uLast];
+        pucIndexes[uByte] = (unsigned char)(u + 1);
+      }
+      break;
+    default:
+      ppsChildren[ucByte] = NULL;
+      break;
+  }
+  psInner->usChildCount--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new inner node of oSymTable of kind ucType, with room for
+   uPrefixLength prefix bytes, which the caller fills in, and with the
+   children of psInner, which the caller releases. Return NULL if
+   insufficient memory is available. */
+static struct SymTableInner *SymTable_copyInner(SymTable_T oSymTable,
+  struct SymTableInner *psInner, unsigned char ucType,
+  size_t uPrefixLength)
+{
+  /* The new node. */
+  struct SymTableInner *psNewInner;
+
+  /* A child, and its branch byte. */
+  struct SymTableNode *psChild;
+  unsigned char ucByte;
+
+  assert(oSymTable != NULL);
+  assert(psInner != NULL);
+  assert(psInner->usChildCount <= SymTable_capacity(ucType));
+
+  psNewInner = SymTable_newInner(oSymTable, ucType, uPrefixLength);
+  if (psNewInner == NULL)
+    return NULL;
+
+  for (psChild = SymTable_nextChild(psInner, 0, &ucByte);
+       psChild != NULL;
+       psChild = SymTable_nextChild(psInner, ucByte + 1u, &ucByte))
+    SymTable_putChild(psNewInner, ucByte, psChild);
+  return psNewInner;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psChild the child on branch byte ucByte of the inner node at
+   *ppsLink, which has no such child, first copying the node into a
+   larger kind if it is full. Return 1 if successful, or 0 if
+   insufficient memory is available, in which case the node is
+   unchanged. */
+static int SymTable_addChild(SymTable_T oSymTable,
+  struct SymTableNode **ppsLink, unsigned char ucByte,
+  struct SymTableNode *psChild)
+{
+  /* The node, and its larger copy. */
+  struct SymTableInner *psInner = (struct SymTableInner *)*ppsLink;
+  struct SymTableInner *psNewInner;
+
+  assert(oSymTable != NULL);
+  assert(psInner != NULL && psInner->sNode.ucType != NODE_LEAF);
+
+  if (psInner->usChildCount == SymTable_capacity(psInner->sNode.ucType))
+  {
+    psNewInner = SymTable_copyInner(oSymTable, psInner,
+      (unsigned char)(psInner->sNode.ucType + 1),
+      psInner->uPrefixLength);
+    if (psNewInner == NULL)
+      return 0;
+    memcpy(SymTable_prefix(psNewInner), SymTable_prefix(psInner),
+           psInner->uPrefixLength);
+    SymTable_release(oSymTable, &psInner->sNode);
+    *ppsLink = &psNewInner->sNode;
+    psInner = psNewInner;
+  }
+
+  SymTable_putChild(psInner, ucByte, psChild);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compact the inner node at *ppsLink, from which a child was just
+   dropped: if one child is left, merge the node into it, and if few
+   are left, copy the node into a smaller kind. Merging and copying are
+   skipped if memory for them is insufficient, which leaves the tree
+   larger than it need be but correct. A node with no children left,
+   which can only be one whose merge was skipped, is left to the
+   caller. */
+static void SymTable_compact(SymTable_T oSymTable,
+                             struct SymTableNode **ppsLink)
+{
+  /* The node, and its merged or smaller copy. */
+  struct SymTableInner *psInner = (struct SymTableInner *)*ppsLink;
+  struct SymTableNode *psNewNode;
+
+  /* The last child, its branch byte, and its prefix or suffix. */
+  struct SymTableNode *psChild;
+  unsigned char ucChildByte;
+  const char *pcRest;
+  size_t uRestLength;
+
+  /* The child count below which the node is copied, and the kind it
+     is copied into. */
+  size_t uShrinkBelow;
+  unsigned char ucSmallerType;
+
+  assert(oSymTable != NULL);
+  assert(psInner != NULL && psInner->sNode.ucType != NODE_LEAF);
+
+  if (psInner->usChildCount == 0)
+    return;
+
+  if (psInner->usChildCount == 1) {
+    /* The child takes the node's place, with the node's prefix and
+       its own branch byte prepended to its prefix or suffix. A leaf
+       on the null branch byte gets just the prefix. */
+    psChild = SymTable_nextChild(psInner, 0, &ucChildByte);
+    if (psChild->ucType == NODE_LEAF) {
+      pcRest = ((struct SymTableLeaf *)psChild)->acSuffix;
+      uRestLength = strlen(pcRest);
+      psNewNode = (struct SymTableNode *)SymTable_newLeaf(oSymTable,
+        psInner->uPrefixLength + (ucChildByte == '\0' ?
+                                  0 : 1 + uRestLength),
+        ((struct SymTableLeaf *)psChild)->pvValue);
+      if (psNewNode != NULL) {
+        memcpy(((struct SymTableLeaf *)psNewNode)->acSuffix,
+               SymTable_prefix(psInner), psInner->uPrefixLength);
+        if (ucChildByte != '\0') {
+          ((struct SymTableLeaf *)psNewNode)
+            ->acSuffix[psInner->uPrefixLength] = (char)ucChildByte;
+          memcpy(((struct SymTableLeaf *)psNewNode)->acSuffix
+                 + psInner->uPrefixLength + 1, pcRest, uRestLength);
+        }
+      }
+    }
+    else {
+      pcRest = SymTable_prefix((struct SymTableInner *)psChild);
+      uRestLength = ((struct SymTableInner *)psChild)->uPrefixLength;
+      psNewNode = (struct SymTableNode *)SymTable_copyInner(oSymTable,
+        (struct SymTableInner *)psChild, psChild->ucType,
+        psInner->uPrefixLength + 1 + uRestLength);
+      if (psNewNode != NULL) {
+        memcpy(SymTable_prefix((struct SymTableInner *)psNewNode),
+               SymTable_prefix(psInner), psInner->uPrefixLength);
+        SymTable_prefix((struct SymTableInner *)psNewNode)
+          [psInner->uPrefixLength] = (char)ucChildByte;
+        memcpy(SymTable_prefix((struct SymTableInner *)psNewNode)
+               + psInner->uPrefixLength + 1, pcRest, uRestLength);
+      }
+    }
+    if (psNewNode != NULL) {
+      SymTable_release(oSymTable, psChild);
+      SymTable_release(oSymTable, &psInner->sNode);
+      *ppsLink = psNewNode;
+    }
+    return;
+  }
+
+  switch (psInner->sNode.ucType) {
+    case NODE_16:
+      uShrinkBelow = SHRINK_16;
+      break;
+    case NODE_48:
+      uShrinkBelow = SHRINK_48;
+      break;
+    case NODE_256:
+      uShrinkBelow = SHRINK_256;
+      break;
+    default:
+      return;
+  }
+  if (psInner->usChildCount >= uShrinkBelow)
+    return;
+
+  ucSmallerType = (unsigned char)(psInner->sNode.ucType - 1);
+  psNewNode = (struct SymTableNode *)SymTable_copyInner(oSymTable,
+    psInner, ucSmallerType, psInner->uPrefixLength);
+  if (psNewNode != NULL) {
+    memcpy(SymTable_prefix((struct SymTableInner *)psNewNode),
+           SymTable_prefix(psInner), psInner->uPrefixLength);
+    SymTable_release(oSymTable, &psInner->sNode);
+    *ppsLink = psNewNode;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make the key buffer of oSymTable long enough for a key of
+   uKeyLength characters. Return 1 if successful, or 0 if insufficient
+   memory is available. */
+static int SymTable_fitKey(SymTable_T oSymTable, size_t uKeyLength) {
+  /* The new buffer and its size. */
+  char *pcNewBuffer;
+  size_t uNewCapacity;
+
+  assert(oSymTable != NULL);
+
+  if (uKeyLength < oSymTable->uKeyCapacity)
+    return 1;
+
+  uNewCapacity = oSymTable->uKeyCapacity * 2;
+  if (uNewCapacity <= uKeyLength)
+    uNewCapacity = uKeyLength + 1;
+  pcNewBuffer = (char *)realloc(oSymTable->pcKeyBuffer, uNewCapacity);
+  if (pcNewBuffer == NULL)
+    return 0;
+
+  oSymTable->pcKeyBuffer = pcNewBuffer;
+  oSymTable->uKeyCapacity = uNewCapacity;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable whose key is pcKey, or NULL if no such
+   leaf exists. */
+static struct SymTableLeaf *SymTable_find(SymTable_T oSymTable,
+                                          const char *pcKey)
+{
+  /* The node being visited, as a node and as an inner node. */
+  struct SymTableNode *psNode;
+  struct SymTableInner *psInner;
+
+  /* The link to the next node. */
+  struct SymTableNode **ppsLink;
+
+  /* The number of key bytes that lead to psNode. */
+  size_t uDepth = 0;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  for (psNode = oSymTable->psRoot; psNode != NULL; psNode = *ppsLink) {
+    PROFILE_PROBE();
+    if (psNode->ucType == NODE_LEAF)
+      return PROFILE_STRCMP(pcKey + uDepth,
+                    ((struct SymTableLeaf *)psNode)->acSuffix) == 0 ?
+        (struct SymTableLeaf *)psNode : NULL;
+
+    /* The prefix holds no null character, so the comparison stops
+       at the end of a short key. */
+    psInner = (struct SymTableInner *)psNode;
+    if (strncmp(pcKey + uDepth, SymTable_prefix(psInner),
+                psInner->uPrefixLength) != 0)
+      return NULL;
+    uDepth += psInner->uPrefixLength;
+
+    ppsLink = SymTable_findChild(psInner, (unsigned char)pcKey[uDepth]);
+    if (ppsLink == NULL)
+      return NULL;
+
+    /* The key ends at a leaf on the null branch byte. */
+    if (pcKey[uDepth++] == '\0')
+      return (struct SymTableLeaf *)*ppsLink;
+  }
+  return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new leaf of oSymTable with value pvValue whose suffix is
+   the key pcKey after its first uDepth characters, or "" if those
+   include its null character, or NULL if insufficient memory is
+   available. */
+static struct SymTableLeaf *SymTable_newLeafFor(SymTable_T oSymTable,
+  const char *pcKey, size_t uDepth, const void *pvValue)
+{
+  /* The new leaf, and the length of its suffix. */
+  struct SymTableLeaf *psLeaf;
+  size_t uSuffixLength;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  uSuffixLength = uDepth > 0 && pcKey[uDepth - 1] == '\0' ?
+    0 : strlen(pcKey + uDepth);
+  psLeaf = SymTable_newLeaf(oSymTable, uSuffixLength, pvValue);
+  if (psLeaf != NULL)
+    memcpy(psLeaf->acSuffix, pcKey + uDepth, uSuffixLength);
+  return psLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable whose key is pcKey, first inserting a
+   new leaf with key pcKey and value pvValue if no such leaf exists, or
+   NULL if insufficient memory is available, in which case oSymTable
+   is unchanged. Set *piInserted to 1 if a new leaf was inserted, or to
+   0 otherwise. The tree is descended only once. */
+static struct SymTableLeaf *SymTable_findOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue, int *piInserted)
+{
+  /* The link to the node being visited, and the node as a leaf and as
+     an inner node. */
+  struct SymTableNode **ppsLink = &oSymTable->psRoot;
+  struct SymTableLeaf *psLeaf;
+  struct SymTableInner *psInner;
+
+  /* The link to a child. */
+  struct SymTableNode **ppsChild;
+
+  /* The new leaf, and the node that splits off the path to it. */
+  struct SymTableLeaf *psNewLeaf;
+  struct SymTableInner *psSplit;
+
+  /* The node displaced by the split, as rebuilt below it, and its
+     branch byte. */
+  struct SymTableNode *psMoved;
+  unsigned char ucMovedByte;
+
+  /* The number of key bytes that lead to the node, and the number of
+     bytes that the key shares with the node's prefix or suffix. */
+  size_t uDepth = 0;
+  size_t uShared;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(piInserted != NULL);
+
+  *piInserted = 0;
+
+  /* A walk must have room to rebuild the key. */
+  if (! SymTable_fitKey(oSymTable, strlen(pcKey)))
+    return NULL;
+
+  for (;;) {
+    if (*ppsLink == NULL) {
+      /* Only the root of an empty tree is missing. */
+      psNewLeaf = SymTable_newLeafFor(oSymTable, pcKey, 0, pvValue);
+      if (psNewLeaf == NULL)
+        return NULL;
+      *ppsLink = &psNewLeaf->sNode;
+      break;
+    }
+
+    PROFILE_PROBE();
+    if ((*ppsLink)->ucType == NODE_LEAF) {
+      psLeaf = (struct SymTableLeaf *)*ppsLink;
+      if (PROFILE_STRCMP(pcKey + uDepth, psLeaf->acSuffix) == 0)
+        return psLeaf;
+
+      /* Split the leaf where the keys differ: a NODE_4 whose prefix is
+         the bytes they share gets the new leaf and a copy of the old
+         one with a shorter suffix. */
+      for (uShared = 0;
+           pcKey[uDepth + uShared] == psLeaf->acSuffix[uShared];
+           uShared++)
+        ;
+      psSplit = SymTable_newInner(oSymTable, NODE_4, uShared);
+      psNewLeaf = SymTable_newLeafFor(oSymTable, pcKey,
+                                      uDepth + uShared + 1, pvValue);
+      ucMovedByte = (unsigned char)psLeaf->acSuffix[uShared];
+      psMoved = (struct SymTableNode *)SymTable_newLeafFor(oSymTable,
+        psLeaf->acSuffix, uShared + 1, psLeaf->pvValue);
+    }
+    else {
+      psInner = (struct SymTableInner *)*ppsLink;
+      for (uShared = 0;
+           uShared < psInner->uPrefixLength &&
+             pcKey[uDepth + uShared] ==
+               SymTable_prefix(psInner)[uShared];
+           uShared++)
+        ;
+
+      if (uShared == psInner->uPrefixLength) {
+        uDepth += uShared;
+        ppsChild = SymTable_findChild(psInner,
+                                      (unsigned char)pcKey[uDepth]);
+        if (ppsChild != NULL) {
+          if (pcKey[uDepth] == '\0')
+            return (struct SymTableLeaf *)*ppsChild;
+          ppsLink = ppsChild;
+          uDepth++;
+          continue;
+        }
+
+        /* Hang the new leaf from this node. */
+        psNewLeaf = SymTable_newLeafFor(oSymTable, pcKey, uDepth + 1,
+                                        pvValue);
+        if (psNewLeaf == NULL)
+          return NULL;
+        if (! SymTable_addChild(oSymTable, ppsLink,
+                                (unsigned char)pcKey[uDepth],
+                                &psNewLeaf->sNode)) {
+          SymTable_release(oSymTable, &psNewLeaf->sNode);
+          return NULL;
+        }
+        break;
+      }
+
+      /* Split the prefix where the key leaves it: a NODE_4 whose
+         prefix is the bytes they share gets the new leaf and a copy of
+         the node with the rest of its prefix. */
+      psSplit = SymTable_newInner(oSymTable, NODE_4, uShared);
+      psNewLeaf = SymTable_newLeafFor(oSymTable, pcKey,
+                                      uDepth + uShared + 1, pvValue);
+      ucMovedByte = (unsigned char)SymTable_prefix(psInner)[uShared];
+      psMoved = (struct SymTableNode *)SymTable_copyInner(oSymTable,
+        psInner, psInner->sNode.ucType,
+        psInner->uPrefixLength - uShared - 1);
+      if (psMoved != NULL)
+        memcpy(SymTable_prefix((struct SymTableInner *)psMoved),
+               SymTable_prefix(psInner) + uShared + 1,
+               psInner->uPrefixLength - uShared - 1);
+    }
+
+    /* Finish either split, or undo it if memory ran out. */
+    if (psSplit == NULL || psNewLeaf == NULL || psMoved == NULL) {
+      if (psSplit != NULL)
+        SymTable_release(oSymTable, &psSplit->sNode);
+      if (psNewLeaf != NULL)
+        SymTable_release(oSymTable, &psNewLeaf->sNode);
+      if (psMoved != NULL)
+        SymTable_release(oSymTable, psMoved);
+      return NULL;
+    }
+    memcpy(SymTable_prefix(psSplit), pcKey + uDepth, uShared);
+    SymTable_putChild(psSplit, (unsigned char)pcKey[uDepth + uShared],
+                      &psNewLeaf->sNode);
+    SymTable_putChild(psSplit, ucMovedByte, psMoved);
+    SymTable_release(oSymTable, *ppsLink);
+    *ppsLink = &psSplit->sNode;
+    break;
+  }
+
+  oSymTable->uLength++;
+  *piInserted = 1;
+  return psNewLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding with key pcKey from the subtree of oSymTable at
+   *ppsLink, an inner node that the first uDepth characters of pcKey
+   lead to, and store its value in *ppvValue. Return 1 if successful,
+   or 0 if no such binding exists. Compact each node that loses a
+   child, and release each that loses its last one. */
+static int SymTable_removeBelow(SymTable_T oSymTable,
+  struct SymTableNode **ppsLink, const char *pcKey, size_t uDepth,
+  void **ppvValue)
+{
+  /* The node, and its child on the key's branch byte. */
+  struct SymTableInner *psInner = (struct SymTableInner *)*ppsLink;
+  struct SymTableNode *psChild;
+
+  /* The link to that child. */
+  struct SymTableNode **ppsChild;
+
+  /* The key's branch byte. */
+  unsigned char ucByte;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(ppvValue != NULL);
+
+  PROFILE_PROBE();
+  if (strncmp(pcKey + uDepth, SymTable_prefix(psInner),
+              psInner->uPrefixLength) != 0)
+    return 0;
+  uDepth += psInner->uPrefixLength;
+
+  ucByte = (unsigned char)pcKey[uDepth];
+  ppsChild = SymTable_findChild(psInner, ucByte);
+  if (ppsChild == NULL)
+    return 0;
+
+  if ((*ppsChild)->ucType == NODE_LEAF) {
+    PROFILE_PROBE();
+    if (ucByte != '\0' &&
+        PROFILE_STRCMP(pcKey + uDepth + 1,
+               ((struct SymTableLeaf *)*ppsChild)->acSuffix) != 0)
+      return 0;
+    *ppvValue = ((struct SymTableLeaf *)*ppsChild)->pvValue;
+  }
+  else {
+    if (! SymTable_removeBelow(oSymTable, ppsChild, pcKey, uDepth + 1,
+                               ppvValue))
+      return 0;
+    if ((*ppsChild)->ucType == NODE_LEAF ||
+        ((struct SymTableInner *)*ppsChild)->usChildCount != 0)
+      return 1;
+  }
+
+  psChild = *ppsChild;
+  SymTable_dropChild(psInner, ucByte);
+  SymTable_release(oSymTable, psChild);
+  SymTable_compact(oSymTable, ppsLink);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The state of an in-order walk of a subtree, which SymTable_map,
+   SymTable_mapPrefix, SymTable_mapRange, SymTable_mapParallel and
+   SymTable_scan share. */
+
+struct SymTableWalk {
+  /* The buffer in which the keys are rebuilt, long enough for any
+     key of the table. */
+  char *pcKey;
+
+  /* The lowest key to visit, or NULL; the key that ends the walk,
+     itself unvisited, or NULL; and the prefix that every visited key
+     has, with its length, or NULL. */
+  const char *pcLow;
+  const char *pcHigh;
+  const char *pcPrefix;
+  size_t uPrefixLength;
+
+  /* The number of bindings left to visit: for a scan, what is left of
+     its budget, and for any other walk, (size_t)-1. */
+  size_t uVisitsLeft;
+
+  /* The function to apply, and its extra parameter. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *pvExtra;
+
+  /* Whether the walk has ended, leaving in the buffer the key that
+     ended it, if any. */
+  int iStopped;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the key buffer that a walk keeps on its stack. A walk
+   of a table with longer keys allocates its buffer. */
+enum {WALK_KEY_SIZE = 128};
+
+/* The number of leading key bytes that the high half of a cursor of
+   SymTable_scan holds, and the shift of that half. The low half is
+   the serial number of a scan slot, or 0. */
+enum {SCAN_BYTES = sizeof(size_t) / 2};
+enum {SCAN_SHIFT = 8 * SCAN_BYTES};
+
+/*--------------------------------------------------------------------*/
+
+/* Visit the binding whose key is rebuilt in the buffer of psWalk and
+   whose value is pvValue, unless the key ends the walk. */
+static void SymTable_visit(struct SymTableWalk *psWalk, void *pvValue)
+{
+  assert(psWalk != NULL);
+
+  if ((psWalk->pcHigh != NULL &&
+       strcmp(psWalk->pcKey, psWalk->pcHigh) >= 0) ||
+      (psWalk->pcPrefix != NULL &&
+       strncmp(psWalk->pcKey, psWalk->pcPrefix,
+               psWalk->uPrefixLength) != 0) ||
+      psWalk->uVisitsLeft == 0) {
+    psWalk->iStopped = 1;
+    return;
+  }
+
+  psWalk->uVisitsLeft--;
+  psWalk->pfApply(psWalk->pcKey, pvValue, psWalk->pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Visit in order the bindings of the subtree at psNode, to which the
+   first uDepth bytes of the buffer of psWalk lead, skipping the keys
+   below the walk's lowest key, until the walk ends. iBounded is 1 if
+   those bytes are the first uDepth bytes of the lowest key, so that
+   the subtree may hold lower keys, or 0 if it holds none. */
+static void SymTable_walk(struct SymTableWalk *psWalk,
+  struct SymTableNode *psNode, size_t uDepth, int iBounded)
+{
+  /* psNode as a leaf and as an inner node. */
+  struct SymTableLeaf *psLeaf;
+  struct SymTableInner *psInner;
+
+  /* A child, and its branch byte. */
+  struct SymTableNode *psChild;
+  unsigned char ucByte;
+
+  /* The branch byte of the lowest key, and how the node's prefix
+     compares with the lowest key. */
+  unsigned char ucLowByte = 0;
+  int iCompare;
+
+  assert(psWalk != NULL);
+  assert(psNode != NULL);
+
+  if (psNode->ucType == NODE_LEAF) {
+    psLeaf = (struct SymTableLeaf *)psNode;
+    if (uDepth == 0 || psWalk->pcKey[uDepth - 1] != '\0')
+      strcpy(psWalk->pcKey + uDepth, psLeaf->acSuffix);
+    if (! iBounded || strcmp(psWalk->pcKey, psWalk->pcLow) >= 0)
+      SymTable_visit(psWalk, psLeaf->pvValue);
+    return;
+  }
+
+  psInner = (struct SymTableInner *)psNode;
+  memcpy(psWalk->pcKey + uDepth, SymTable_prefix(psInner),
+         psInner->uPrefixLength);
+  if (iBounded) {
+    /* The prefix holds no null character, so the comparison stops at
+       the end of the lowest key, if that comes first. */
+    iCompare = strncmp(SymTable_prefix(psInner),
+                       psWalk->pcLow + uDepth, psInner->uPrefixLength);
+    if (iCompare < 0)
+      return;
+    if (iCompare > 0)
+      iBounded = 0;
+    else
+      ucLowByte = (unsigned char)
+        psWalk->pcLow[uDepth + psInner->uPrefixLength];
+  }
+  uDepth += psInner->uPrefixLength;
+
+  for (psChild = SymTable_nextChild(psInner, ucLowByte, &ucByte);
+       psChild != NULL && ! psWalk->iStopped;
+       psChild = SymTable_nextChild(psInner, ucByte + 1u, &ucByte)) {
+    psWalk->pcKey[uDepth] = (char)ucByte;
+    SymTable_walk(psWalk, psChild, uDepth + 1,
+                  iBounded && ucByte == ucLowByte);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remember pcKey, the key at which a stopped scan of oSymTable goes
+   on, in the next scan slot, and return the cursor that refers to it:
+   the first SCAN_BYTES bytes of pcKey, padded with null characters, in
+   its high half, and the slot's serial number in its low half, or 0
+   if memory for the key is insufficient. */
+static size_t SymTable_stopScan(SymTable_T oSymTable,
+  const char *pcKey)
+{
+  /* The high half of the cursor, and the number of bytes put into
+     it. */
+  size_t uHigh = 0;
+  size_t u;
+
+  /* Whether the end of the key was reached. */
+  int iEnded = 0;
+
+  /* The serial number and its slot. */
+  size_t uSerial;
+  struct SymTableScanSlot *psSlot;
+
+  /* The size of the key, and the slot's grown buffer. */
+  size_t uKeySize;
+  char *pcNewKey;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  /* The key follows a key visited, so it is not empty, and the
+     cursor is not 0. */
+  assert(pcKey[0] != '\0');
+  for (u = 0; u < SCAN_BYTES; u++) {
+    if (! iEnded && pcKey[u] == '\0')
+      iEnded = 1;
+    uHigh = uHigh << 8 |
+      (iEnded ? 0 : (size_t)(unsigned char)pcKey[u]);
+  }
+
+  /* Serial numbers wrap within the low half, skipping 0. */
+  uSerial = (oSymTable->uScanSerial + 1)
+            & (((size_t)1 << SCAN_SHIFT) - 1);
+  if (uSerial == 0)
+    uSerial = 1;
+  oSymTable->uScanSerial = uSerial;
+  psSlot = &oSymTable->asScanSlots[uSerial % SCAN_SLOTS];
+
+  uKeySize = strlen(pcKey) + 1;
+  if (uKeySize > psSlot->uCapacity) {
+    pcNewKey = (char *)realloc(psSlot->pcKey, uKeySize);
+    if (pcNewKey == NULL) {
+      psSlot->uSerial = 0;
+      return uHigh << SCAN_SHIFT;
+    }
+    psSlot->pcKey = pcNewKey;
+    psSlot->uCapacity = uKeySize;
+  }
+  strcpy(psSlot->pcKey, pcKey);
+  psSlot->uSerial = uSerial;
+  return uHigh << SCAN_SHIFT | uSerial;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Visit in order the bindings of oSymTable with pfApply and pvExtra,
+   from pcLow up to but not including pcHigh, and only those with the
+   prefix pcPrefix, where any of the three may be NULL, but no more
+   than uBudget of them. Return the cursor of SymTable_scan at which
+   the walk goes on if the budget stopped it, or 0 otherwise. */
+static size_t SymTable_walkTable(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh, const char *pcPrefix,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The walk, and the key buffer that it keeps on the stack. */
+  struct SymTableWalk sWalk;
+  char acKey[WALK_KEY_SIZE];
+
+  /* The cursor to return. */
+  size_t uCursor = 0;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  if (oSymTable->psRoot == NULL)
+    return 0;
+
+  /* A buffer of the walk's own lets pfApply start another walk of the
+     table. */
+  sWalk.pcKey = acKey;
+  if (oSymTable->uKeyCapacity > WALK_KEY_SIZE) {
+    sWalk.pcKey = (char *)malloc(oSymTable->uKeyCapacity);
+    if (sWalk.pcKey == NULL)
+      sWalk.pcKey = oSymTable->pcKeyBuffer;
+  }
+
+  sWalk.pcLow = pcLow;
+  sWalk.pcHigh = pcHigh;
+  sWalk.pcPrefix = pcPrefix;
+  sWalk.uPrefixLength = pcPrefix == NULL ? 0 : strlen(pcPrefix);
+  sWalk.uVisitsLeft = uBudget;
+  sWalk.pfApply = pfApply;
+  sWalk.pvExtra = (void *)pvExtra;
+  sWalk.iStopped = 0;
+  SymTable_walk(&sWalk, oSymTable->psRoot, 0, pcLow != NULL);
+
+  /* The key that stopped the walk is still in the buffer. */
+  if (sWalk.iStopped && sWalk.uVisitsLeft == 0)
+    uCursor = SymTable_stopScan(oSymTable, sWalk.pcKey);
+
+  if (sWalk.pcKey != acKey && sWalk.pcKey != oSymTable->pcKeyBuffer)
+    free(sWalk.pcKey);
+  return uCursor;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void) {
+  /* Allocate memory for SymTable struct, but store/pass a 
+     reference to it, not a copy. */
+  SymTable_T oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+
+  /* Check that memory allocation was successful. */
+  if (oSymTable == NULL) {
+    return NULL;
+  }
+
+  /* Initialize values of the new, empty SymTable. The key buffer is
+     allocated by the first put. */
+  oSymTable->psRoot = NULL;
+  oSymTable->uLength = 0;
+  oSymTable->pcKeyBuffer = NULL;
+  oSymTable->uKeyCapacity = 0;
+  memset(oSymTable->asScanSlots, 0, sizeof(oSymTable->asScanSlots));
+  oSymTable->uScanSerial = 0;
+  Slab_init(&oSymTable->sSlab);
+  PROFILE_INIT(&oSymTable->sProfile);
+
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* A tree has no buckets to size in advance. */
+  (void)uCapacity;
+  return SymTable_new();
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable) {
+  /* Incrementor over the scan slots. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  /* Free all nodes chunk by chunk rather than node by node. */
+  Slab_clear(&oSymTable->sSlab);
+
+  for (u = 0; u < SCAN_SLOTS; u++)
+    free(oSymTable->asScanSlots[u].pcKey);
+  free(oSymTable->pcKeyBuffer);
+  free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the bytes of the subtree at psNode to *psStats. The prefixes of
+   inner nodes and the suffixes of leaves are the key bytes, which
+   shared prefixes make fewer than those of the keys put. */
+static void SymTable_addNodes(struct SymTableStats *psStats,
+                              struct SymTableNode *psNode)
+{
+  /* The key bytes of psNode. */
+  size_t uKeyBytes;
+
+  /* A child of psNode, and its branch byte. */
+  struct SymTableNode *psChild;
+  unsigned char ucByte;
+
+  assert(psStats != NULL);
+  assert(psNode != NULL);
+
+  if (psNode->ucType == NODE_LEAF)
+    uKeyBytes = strlen(((struct SymTableLeaf *)psNode)->acSuffix) + 1;
+  else {
+    uKeyBytes = ((struct SymTableInner *)psNode)->uPrefixLength;
+    for (psChild = SymTable_nextChild((struct SymTableInner *)psNode,
+                                      0, &ucByte);
+         psChild != NULL;
+         psChild = SymTable_nextChild((struct SymTableInner *)psNode,
+                                      ucByte + 1u, &ucByte))
+      SymTable_addNodes(psStats, psChild);
+  }
+
+  psStats->uKeyBytes += uKeyBytes;
+  psStats->uNodeBytes += SymTable_nodeSize(psNode) - uKeyBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
+
+  /* A tree has no buckets to fill, nor chains to grow, and its nodes
+     change kind one at a time rather than resizing the table. */
+  memset(psStats, 0, sizeof(struct SymTableStats));
+  psStats->uLength = oSymTable->uLength;
+  if (oSymTable->psRoot != NULL)
+    SymTable_addNodes(psStats, oSymTable->psRoot);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
+  assert(oSymTable != NULL);
+  assert(psFile != NULL);
+
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  assert(oSymTable != NULL);
+
+  /* A tree never resizes, so there is nothing to reserve. */
+  (void)uCapacity;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
+  const void *pvValue) 
+{
+  /* Whether a new leaf was inserted. */
+  int iInserted;
+
+  /* The leaf with key pcKey, found or inserted. */
+  struct SymTableLeaf *psLeaf;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  psLeaf = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  PROFILE_END(&oSymTable->sProfile, psLeaf != NULL && ! iInserted);
+
+  /* If a binding with the same key already exists, put fails, as it
+     does if memory for the new leaf is insufficient. */
+  return psLeaf != NULL && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue) 
+{
+  /* The leaf of the binding. */
+  struct SymTableLeaf *psLeaf;
+
+  /* The binding's previous value. */
+  void *pvOldValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REPLACE);
+  psLeaf = SymTable_find(oSymTable, pcKey);
+  PROFILE_END(&oSymTable->sProfile, psLeaf != NULL);
+  if (psLeaf == NULL)
+    return NULL;
+
+  pvOldValue = psLeaf->pvValue;
+  psLeaf->pvValue = (void *)pvValue;
+  return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_find(oSymTable, pcKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  /* The leaf of the binding. */
+  struct SymTableLeaf *psLeaf;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+  psLeaf = SymTable_find(oSymTable, pcKey);
+  PROFILE_END(&oSymTable->sProfile, psLeaf != NULL);
+  return psLeaf == NULL ? NULL : psLeaf->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* Incrementor over the keys. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  /* Each lookup depends on the node before, so there is nothing to
+     overlap. */
+  for (u = 0; u < uCount; u++)
+    apvOut[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  /* The root, and the value of the binding removed. */
+  struct SymTableNode *psRoot;
+  void *pvValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REMOVE);
+  psRoot = oSymTable->psRoot;
+  if (psRoot == NULL) {
+    PROFILE_END(&oSymTable->sProfile, 0);
+    return NULL;
+  }
+
+  /* A root leaf has no parent to remove it from. */
+  if (psRoot->ucType == NODE_LEAF) {
+    PROFILE_PROBE();
+    if (PROFILE_STRCMP(pcKey, ((struct SymTableLeaf *)psRoot)->acSuffix)
+        != 0) {
+      PROFILE_END(&oSymTable->sProfile, 0);
+      return NULL;
+    }
+    pvValue = ((struct SymTableLeaf *)psRoot)->pvValue;
+    SymTable_release(oSymTable, psRoot);
+    oSymTable->psRoot = NULL;
+  }
+  else {
+    if (! SymTable_removeBelow(oSymTable, &oSymTable->psRoot, pcKey, 0,
+                               &pvValue)) {
+      PROFILE_END(&oSymTable->sProfile, 0);
+      return NULL;
+    }
+    psRoot = oSymTable->psRoot;
+    if (psRoot->ucType != NODE_LEAF &&
+        ((struct SymTableInner *)psRoot)->usChildCount == 0) {
+      SymTable_release(oSymTable, psRoot);
+      oSymTable->psRoot = NULL;
+    }
+  }
+
+  oSymTable->uLength--;
+  PROFILE_END(&oSymTable->sProfile, 1);
+  return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The leaf of the binding, found or inserted. */
+  struct SymTableLeaf *psLeaf;
+
+  /* Whether a new leaf was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  psLeaf = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  if (psLeaf == NULL)
+    return NULL;
+
+  /* Give the address of the binding's value. */
+  return &psLeaf->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The leaf of the binding, found or inserted. */
+  struct SymTableLeaf *psLeaf;
+
+  /* Whether a new leaf was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  psLeaf = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  if (psLeaf == NULL)
+    return 0;
+
+  /* An existing binding's value is combined with pvValue. The leaf
+     holds only the end of the key, so pcKey is passed on. */
+  if (! iInserted)
+    psLeaf->pvValue = pfCombine(pcKey, psLeaf->pvValue,
+                                (void *)pvValue, (void *)pvExtra);
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  /* The tree branches on the bytes of keys, so there is nothing to
+     hash. */
+  return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  (void)uHashKey;
+  return SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  (void)uHashKey;
+  return SymTable_contains(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  (void)uHashKey;
+  return SymTable_get(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a copy of the subtree at psNode, allocated from psSlab, or
+   NULL if insufficient memory is available. */
+static struct SymTableNode *SymTable_copyTree(struct Slab *psSlab,
+  struct SymTableNode *psNode)
+{
+  /* The copy, and its children. */
+  struct SymTableNode *psNewNode;
+  struct SymTableNode **ppsChildren;
+
+  /* The size of the node. */
+  size_t uNodeSize;
+
+  /* Incrementor over the children. */
+  size_t u;
+
+  assert(psSlab != NULL);
+  assert(psNode != NULL);
+
+  uNodeSize = SymTable_nodeSize(psNode);
+  psNewNode = (struct SymTableNode *)Slab_alloc(psSlab, uNodeSize);
+  if (psNewNode == NULL)
+    return NULL;
+  memcpy(psNewNode, psNode, uNodeSize);
+  if (psNode->ucType == NODE_LEAF)
+    return psNewNode;
+
+  /* The children of a NODE_256 are spread out, and those of the other
+     kinds packed. */
+  ppsChildren = SymTable_children((struct SymTableInner *)psNewNode);
+  for (u = 0; u < SymTable_capacity(psNode->ucType); u++) {
+    if (ppsChildren[u] == NULL ||
+        (psNode->ucType != NODE_256 &&
+         u >= ((struct SymTableInner *)psNode)->usChildCount))
+      continue;
+    ppsChildren[u] = SymTable_copyTree(psSlab, ppsChildren[u]);
+    if (ppsChildren[u] == NULL)
+      return NULL;
+  }
+  return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The allocator of the copied nodes. */
+  struct Slab sNewSlab;
+
+  /* The copied root. */
+  struct SymTableNode *psNewRoot = NULL;
+
+  assert(oSymTable != NULL);
+
+  /* Copy the tree into a fresh slab, so the chunks that removals left
+     mostly empty are freed along with the old slab. Leave the table
+     as it was if the copy cannot be finished. */
+  Slab_init(&sNewSlab);
+  if (oSymTable->psRoot != NULL) {
+    psNewRoot = SymTable_copyTree(&sNewSlab, oSymTable->psRoot);
+    if (psNewRoot == NULL) {
+      Slab_clear(&sNewSlab);
+      return 0;
+    }
+  }
+
+  Slab_clear(&oSymTable->sSlab);
+  oSymTable->sSlab = sNewSlab;
+  oSymTable->psRoot = psNewRoot;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra) 
+{
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  (void)SymTable_walkTable(oSymTable, NULL, NULL, NULL, (size_t)-1,
+                           pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  /* The keys with the prefix are the keys from the prefix on, up to
+     the first key without it. */
+  (void)SymTable_walkTable(oSymTable, pcPrefix, NULL, pcPrefix,
+                           (size_t)-1, pfApply, pvExtra);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  (void)SymTable_walkTable(oSymTable, pcLow, pcHigh, NULL, (size_t)-1,
+                           pfApply, pvExtra);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks, each
+   of which walks one child of the root. */
+
+struct SymTableMapping {
+  /* The root, its children in order, and their branch bytes. */
+  struct SymTableInner *psRoot;
+  struct SymTableNode *apsChildren[256];
+  unsigned char aucBytes[256];
+
+  /* The key buffer of each worker, uKeyCapacity bytes apart. */
+  char *pcKeys;
+  size_t uKeyCapacity;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the bindings below child uTask of the root, passing the pvExtra of
+   worker uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+
+  /* The walk of the child. */
+  struct SymTableWalk sWalk;
+
+  /* The length of the root's prefix. */
+  size_t uPrefixLength;
+
+  assert(psMapping != NULL);
+
+  uPrefixLength = psMapping->psRoot->uPrefixLength;
+  sWalk.pcKey = psMapping->pcKeys + uWorker * psMapping->uKeyCapacity;
+  memcpy(sWalk.pcKey, SymTable_prefix(psMapping->psRoot),
+         uPrefixLength);
+  sWalk.pcKey[uPrefixLength] = (char)psMapping->aucBytes[uTask];
+  sWalk.pcLow = NULL;
+  sWalk.pcHigh = NULL;
+  sWalk.pcPrefix = NULL;
+  sWalk.uPrefixLength = 0;
+  sWalk.uVisitsLeft = (size_t)-1;
+  sWalk.pfApply = psMapping->pfApply;
+  sWalk.pvExtra = psMapping->apvExtras == NULL ?
+    NULL : psMapping->apvExtras[uWorker];
+  sWalk.iStopped = 0;
+  SymTable_walk(&sWalk, psMapping->apsChildren[uTask],
+                uPrefixLength + 1, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks, and their number. */
+  struct SymTableMapping sMapping;
+  size_t uTaskCount = 0;
+
+  /* A child of the root, and its branch byte. */
+  struct SymTableNode *psChild;
+  unsigned char ucByte;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  /* Each child of the root is a task, and each worker rebuilds keys
+     in a buffer of its own. A root leaf, or no memory for the
+     buffers, leaves a serial walk. */
+  if (oSymTable->psRoot == NULL ||
+      oSymTable->psRoot->ucType == NODE_LEAF) {
+    SymTable_map(oSymTable, pfApply,
+                 apvExtras == NULL ? NULL : apvExtras[0]);
+    return;
+  }
+  sMapping.psRoot = (struct SymTableInner *)oSymTable->psRoot;
+  sMapping.uKeyCapacity = oSymTable->uKeyCapacity;
+  sMapping.pcKeys = (char *)malloc(uThreadCount
+                                   * sMapping.uKeyCapacity);
+  if (sMapping.pcKeys == NULL) {
+    SymTable_map(oSymTable, pfApply,
+                 apvExtras == NULL ? NULL : apvExtras[0]);
+    return;
+  }
+
+  for (psChild = SymTable_nextChild(sMapping.psRoot, 0, &ucByte);
+       psChild != NULL;
+       psChild = SymTable_nextChild(sMapping.psRoot, ucByte + 1u,
+                                    &ucByte)) {
+    sMapping.apsChildren[uTaskCount] = psChild;
+    sMapping.aucBytes[uTaskCount] = ucByte;
+    uTaskCount++;
+  }
+
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  WorkPool_run(uTaskCount, uThreadCount, SymTable_mapTask, &sMapping);
+
+  free(sMapping.pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A position in the in-order walk of an inner node by an iterator. */
+
+struct SymTableFrame {
+  /* The node. */
+  struct SymTableInner *psInner;
+
+  /* The lowest branch byte not yet visited, up to 256. */
+  unsigned uNextByte;
+
+  /* The number of key bytes that lead to the node's children. */
+  size_t uDepth;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator walks the tree in order with an explicit stack of
+   frames, rebuilding keys in a buffer of its own. */
+
+struct SymTableIter {
+  /* A root leaf not yet visited, or NULL. */
+  struct SymTableLeaf *psRootLeaf;
+
+  /* The frames of the inner nodes on the path to the last binding
+     visited, and their number; the path is never longer than the
+     buffer. */
+  struct SymTableFrame *psaFrames;
+  size_t uFrameCount;
+
+  /* The buffer in which the keys are rebuilt. */
+  char *pcKey;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  /* The root as an inner node. */
+  struct SymTableInner *psRoot;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+  oIter->psaFrames = (struct SymTableFrame *)
+    malloc((oSymTable->uKeyCapacity + 1)
+           * sizeof(struct SymTableFrame));
+  oIter->pcKey = (char *)malloc(oSymTable->uKeyCapacity + 1);
+  if (oIter->psaFrames == NULL || oIter->pcKey == NULL) {
+    free(oIter->psaFrames);
+    free(oIter->pcKey);
+    free(oIter);
+    return NULL;
+  }
+
+  oIter->psRootLeaf = NULL;
+  oIter->uFrameCount = 0;
+  if (oSymTable->psRoot != NULL &&
+      oSymTable->psRoot->ucType == NODE_LEAF)
+    oIter->psRootLeaf = (struct SymTableLeaf *)oSymTable->psRoot;
+  else if (oSymTable->psRoot != NULL) {
+    psRoot = (struct SymTableInner *)oSymTable->psRoot;
+    memcpy(oIter->pcKey, SymTable_prefix(psRoot),
+           psRoot->uPrefixLength);
+    oIter->psaFrames[0].psInner = psRoot;
+    oIter->psaFrames[0].uNextByte = 0;
+    oIter->psaFrames[0].uDepth = psRoot->uPrefixLength;
+    oIter->uFrameCount = 1;
+  }
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The leaf visited. */
+  struct SymTableLeaf *psLeaf = NULL;
+
+  /* The innermost frame, and the child it visits next with its branch
+     byte. */
+  struct SymTableFrame *psFrame;
+  struct SymTableNode *psChild;
+  unsigned char ucByte;
+
+  /* The child as an inner node, and the depth of its branch byte. */
+  struct SymTableInner *psInner;
+  size_t uDepth;
+
+  assert(oIter != NULL);
+
+  if (oIter->psRootLeaf != NULL) {
+    psLeaf = oIter->psRootLeaf;
+    oIter->psRootLeaf = NULL;
+    strcpy(oIter->pcKey, psLeaf->acSuffix);
+  }
+
+  while (psLeaf == NULL && oIter->uFrameCount > 0) {
+    psFrame = &oIter->psaFrames[oIter->uFrameCount - 1];
+    psChild = SymTable_nextChild(psFrame->psInner, psFrame->uNextByte,
+                                 &ucByte);
+    if (psChild == NULL) {
+      oIter->uFrameCount--;
+      continue;
+    }
+    psFrame->uNextByte = ucByte + 1u;
+    uDepth = psFrame->uDepth;
+    oIter->pcKey[uDepth] = (char)ucByte;
+
+    if (psChild->ucType == NODE_LEAF) {
+      psLeaf = (struct SymTableLeaf *)psChild;
+      if (ucByte != '\0')
+        strcpy(oIter->pcKey + uDepth + 1, psLeaf->acSuffix);
+    }
+    else {
+      psInner = (struct SymTableInner *)psChild;
+      memcpy(oIter->pcKey + uDepth + 1, SymTable_prefix(psInner),
+             psInner->uPrefixLength);
+      psFrame++;
+      psFrame->psInner = psInner;
+      psFrame->uNextByte = 0;
+      psFrame->uDepth = uDepth + 1 + psInner->uPrefixLength;
+      oIter->uFrameCount++;
+    }
+  }
+
+  if (psLeaf == NULL)
+    return 0;
+  if (ppcKey != NULL)
+    *ppcKey = oIter->pcKey;
+  if (ppvValue != NULL)
+    *ppvValue = psLeaf->pvValue;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  free(oIter->psaFrames);
+  free(oIter->pcKey);
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The first bytes of the key at which the scan goes on. */
+  char acLow[SCAN_BYTES + 1];
+
+  /* Incrementor over the bytes of the cursor. */
+  size_t u;
+
+  /* The serial number of the cursor, and its slot. */
+  size_t uSerial;
+  struct SymTableScanSlot *psSlot;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* A tree has no buckets, so the budget counts bindings, which are
+     visited in key order. A nonzero cursor refers to the key at which
+     the scan goes on, kept in a scan slot. If later scans have taken
+     the slot, the scan goes on from the first key that begins with
+     the bytes in the cursor's high half, and may visit some keys
+     again. The keys put and removed since do not move the others. */
+  if (uCursor == 0)
+    return SymTable_walkTable(oSymTable, NULL, NULL, NULL, uBudget,
+                              pfApply, pvExtra);
+
+  uSerial = uCursor & (((size_t)1 << SCAN_SHIFT) - 1);
+  psSlot = &oSymTable->asScanSlots[uSerial % SCAN_SLOTS];
+  if (uSerial != 0 && psSlot->uSerial == uSerial)
+    return SymTable_walkTable(oSymTable, psSlot->pcKey, NULL, NULL,
+                              uBudget, pfApply, pvExtra);
+
+  for (u = 0; u < SCAN_BYTES; u++)
+    acLow[u] = (char)(uCursor >> (SCAN_SHIFT + 8 * (SCAN_BYTES - 1 - u))
+                      & 0xff);
+  acLow[SCAN_BYTES] = '\0';
+  return SymTable_walkTable(oSymTable, acLow, NULL, NULL, uBudget,
+                            pfApply, pvExtra);
+}
@@ -0,0 +1,1623 @@
+/*--------------------------------------------------------------------*/
+/* symtableconcurrent.c                                               */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* pthread mutexes, sched_yield() and posix_memalign() are POSIX
+   functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "symtable.h"
+#include "strhash.h"
+#include "slab.h"
+#include "workpool.h"
+#include "keyorder.h"
+#include "profile.h"
+
+/* A chained hash table that many threads may share. Readers
+   (SymTable_get, SymTable_contains, their Hashed forms,
+   SymTable_getBatch, SymTable_getLength and SymTable_map) take no
+   lock: writers publish every node and buckets array with an atomic
+   release store, so a reader that reaches one with an acquire load
+   sees it fully built. Writers (every other function) hold the
+   table's mutex. A node or buckets array that a writer unlinks may
+   still be read by readers that reached it earlier, so it is retired
+   instead of freed, and freed once every reader that began before it
+   was unlinked has finished. Readers announce themselves in one of
+   two counters of an epoch; see SymTable_readBegin. SymTable_new and
+   SymTable_free must not overlap any other call on the table. */
+
+#ifndef __GNUC__
+#error "symtableconcurrent.c needs the GCC __atomic builtins"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Load the pointer or size at p with acquire semantics, and store v
+   at p with release semantics. Every field that a reader may read
+   while a writer changes it is accessed only through these, or
+   through the __atomic builtins directly. */
+#define SYMTABLE_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define SYMTABLE_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+/*--------------------------------------------------------------------*/
+
+/* The number of reader counters of each table. Each thread uses one,
+   chosen round-robin when it first reads, so up to this many reading
+   threads never write to the same cache line. */
+enum {READER_SLOTS = 32};
+
+/* The size in bytes of a cache line, to which reader counters are
+   padded and aligned. */
+enum {CACHE_LINE = 64};
+
+/* The number of buckets that each task of SymTable_mapParallel
+   walks. */
+enum {MAP_CHUNK = 256};
+
+/*--------------------------------------------------------------------*/
+
+/* The smallest bucket count, and the bucket count of a new table.
+   Bucket counts are always powers of two, so a hash code is reduced
+   to a bucket index with a mask instead of a division. */
+static const size_t uInitialBucketCount = 16;
+
+/*--------------------------------------------------------------------*/
+
+/* Each item stored in a SymTable. SymTableNodes are linked to form a
+   chain connected to a bucket element in an array of buckets. Each
+   node is a single block that ends with the defensive copy of its
+   key. A node is never changed once published, except for its value
+   and link. */
+
+struct SymTableNode {
+  /* The full (unreduced) hash code of acKey. */
+  size_t uHash;
+
+  /* The generic value, read and written atomically. */
+  void *pvValue;
+
+  /* A reference to the next node in the list, read and written
+     atomically. */
+  struct SymTableNode *psNextNode;
+
+  /* The string key, stored inline. */
+  char acKey[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A buckets array, published as a whole. A resize builds a new one,
+   with copies of the nodes, and replaces the old one in one store. */
+
+struct SymTableBuckets {
+  /* The number of buckets, a power of two. */
+  size_t uBucketCount;
+
+  /* The first node of each bucket's chain, or NULL, read and written
+     atomically. */
+  struct SymTableNode *apsChains[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A block that writers have unlinked but readers may still read. */
+
+struct SymTableRetired {
+  /* The block. */
+  void *pvBlock;
+
+  /* The size of the block if it is a node owned by the table's slab,
+     or 0 if it is a buckets array to be freed with free(). */
+  size_t uSize;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A growable array of retired blocks. */
+
+struct SymTableRetiredList {
+  /* The blocks, or NULL if no memory has been allocated for them. */
+  struct SymTableRetired *psaBlocks;
+
+  /* The number of blocks and the number of elements of psaBlocks. */
+  size_t uLength;
+  size_t uCapacity;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The counters of the readers of one slot, alone on a cache line. */
+
+struct SymTableReaderSlot {
+  /* The number of readers of this slot inside a read section that
+     began in an even or in an odd epoch, read and written
+     atomically. */
+  size_t auReaders[2];
+
+  /* Padding up to a whole cache line. */
+  char acPadding[CACHE_LINE - 2 * sizeof(size_t)];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable structure is a "manager" structure that points to the
+   current buckets array. */
+
+struct SymTable {
+  /* The reader counters. They come first, so that the alignment of
+     the structure aligns them to cache lines. */
+  struct SymTableReaderSlot asReaderSlots[READER_SLOTS];
+
+  /* The current buckets array, read and written atomically. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The total number of bindings in SymTable, read and written
+     atomically. */
+  size_t uLength;
+
+  /* The bucket count below which removals never shrink the table, as
+     reserved by SymTable_newWithCapacity or SymTable_reserve. */
+  size_t uMinBucketCount;
+
+  /* The number of times the bucket count has changed, read and
+     written atomically for SymTable_getStats. Only writers change
+     it. */
+  size_t uResizeCount;
+
+  /* The seed of this table's hash function, chosen at random when the
+     table is created so that colliding keys cannot be precomputed. */
+  size_t uSeed;
+
+  /* The current epoch, read and written atomically. Only writers
+     advance it. */
+  size_t uEpoch;
+
+  /* The blocks retired during even and during odd epochs. */
+  struct SymTableRetiredList asRetired[2];
+
+  /* The lock that every writer holds. */
+  pthread_mutex_t sWriteLock;
+
+  /* The allocator of this table's nodes. Only writers use it. */
+  struct Slab sSlab;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table; see profile.h. */
+  struct Profile sProfile;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The index plus one of the reader slot of the calling thread, or 0
+   if it has not read any table yet, and the number of slots handed out
+   so far by all threads. */
+static __thread size_t uThreadReaderSlot;
+static size_t uReaderSlotsTaken;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the full hash code under the seed of oSymTable of the key
+   whose token from SymTable_hashKey is uHashKey. */
+static size_t SymTable_seedHash(SymTable_T oSymTable, size_t uHashKey) {
+  assert(oSymTable != NULL);
+
+  return StrHash_mixSeed(uHashKey, oSymTable->uSeed);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the full hash code for pcKey under the seed of oSymTable.
+   Mask it with a bucket count minus one to find the bucket of pcKey. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_seedHash(oSymTable, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size in bytes of a node whose key has uKeyLength
+   characters. */
+static size_t SymTable_nodeSize(size_t uKeyLength) {
+  return offsetof(struct SymTableNode, acKey) + uKeyLength + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Enter a read section of oSymTable, during which no node or buckets
+   array that the calling thread can reach is freed. Return the
+   counter to pass to SymTable_readEnd.
+
+   The thread counts itself in the counter of the current epoch's
+   parity, then checks that the epoch has not advanced meanwhile. A
+   writer frees the blocks retired during an epoch only after the
+   epoch has advanced past it and the counters of its parity have
+   drained, and every reader that entered later saw those blocks
+   already unlinked. Readers therefore never wait, and writers never
+   wait either, since they merely free later if readers remain. */
+static size_t *SymTable_readBegin(SymTable_T oSymTable) {
+  /* The reader slot of the calling thread. */
+  struct SymTableReaderSlot *psSlot;
+
+  /* The epoch in which the read section begins, and its counter. */
+  size_t uEpoch;
+  size_t *puReaders;
+
+  assert(oSymTable != NULL);
+
+  if (uThreadReaderSlot == 0)
+    uThreadReaderSlot = __atomic_fetch_add(&uReaderSlotsTaken, 1,
+                                           __ATOMIC_RELAXED)
+                        % READER_SLOTS + 1;
+  psSlot = &oSymTable->asReaderSlots[uThreadReaderSlot - 1];
+
+  for (;;) {
+    uEpoch = __atomic_load_n(&oSymTable->uEpoch, __ATOMIC_SEQ_CST);
+    puReaders = &psSlot->auReaders[uEpoch & 1];
+    __atomic_fetch_add(puReaders, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&oSymTable->uEpoch, __ATOMIC_SEQ_CST) == uEpoch)
+      return puReaders;
+
+    /* The epoch advanced before the count was seen, so count again in
+       the new epoch. */
+    __atomic_fetch_sub(puReaders, 1, __ATOMIC_RELEASE);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Leave the read section that SymTable_readBegin entered and that
+   counted itself in *puReaders. */
+static void SymTable_readEnd(size_t *puReaders) {
+  assert(puReaders != NULL);
+
+  __atomic_fetch_sub(puReaders, 1, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free every block of *psList, whose blocks belong to oSymTable, and
+   empty the list. The caller must hold the write lock. */
+static void SymTable_freeRetired(SymTable_T oSymTable,
+  struct SymTableRetiredList *psList)
+{
+  /* Incrementor over the retired blocks. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(psList != NULL);
+
+  for (u = 0; u < psList->uLength; u++) {
+    if (psList->psaBlocks[u].uSize == 0)
+      free(psList->psaBlocks[u].pvBlock);
+    else
+      Slab_release(&oSymTable->sSlab, psList->psaBlocks[u].pvBlock,
+                   psList->psaBlocks[u].uSize);
+  }
+  psList->uLength = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Advance the epoch of oSymTable if no reader of the previous epoch
+   remains, first freeing the blocks retired during it. Return 1 if the
+   epoch advanced, or 0 otherwise. The caller must hold the write
+   lock. */
+static int SymTable_advanceEpoch(SymTable_T oSymTable) {
+  /* The current epoch and the parity of the previous one. */
+  size_t uEpoch, uOldParity;
+
+  /* Incrementor over the reader slots. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  uEpoch = __atomic_load_n(&oSymTable->uEpoch, __ATOMIC_RELAXED);
+  uOldParity = (uEpoch + 1) & 1;
+
+  /* Order the stores that unlinked the retired blocks before the loads
+     of the counters. Otherwise a reader's increment and a writer's
+     unlink could each miss the other, and a reader that still sees a
+     block would not be counted. */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  for (u = 0; u < READER_SLOTS; u++)
+    if (SYMTABLE_LOAD(
+          &oSymTable->asReaderSlots[u].auReaders[uOldParity]) != 0)
+      return 0;
+
+  /* Every reader that could reach a block retired during the previous
+     epoch has left, since the readers of the current epoch entered
+     after the blocks were unlinked. */
+  SymTable_freeRetired(oSymTable, &oSymTable->asRetired[uOldParity]);
+
+  __atomic_store_n(&oSymTable->uEpoch, uEpoch + 1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Wait until every reader of oSymTable that is inside a read section
+   now has left it, freeing every retired block on the way. The caller
+   must hold the write lock, and must not be inside a read section. */
+static void SymTable_synchronize(SymTable_T oSymTable) {
+  /* The epoch at which the wait ends. */
+  size_t uTargetEpoch;
+
+  assert(oSymTable != NULL);
+
+  /* Two advances drain the readers of both parities. */
+  uTargetEpoch =
+    __atomic_load_n(&oSymTable->uEpoch, __ATOMIC_RELAXED) + 2;
+  while (__atomic_load_n(&oSymTable->uEpoch, __ATOMIC_RELAXED)
+         != uTargetEpoch)
+    if (! SymTable_advanceEpoch(oSymTable))
+      sched_yield();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Retire the block pvBlock of oSymTable, which writers have unlinked,
+   where uSize is the size of a node, or 0 for a buckets array. If
+   memory for the retired list is insufficient, wait for the readers
+   and free the block right away instead. The caller must hold the
+   write lock. */
+static void SymTable_retire(SymTable_T oSymTable, void *pvBlock,
+  size_t uSize)
+{
+  /* The list of the current epoch. */
+  struct SymTableRetiredList *psList;
+
+  /* The list's grown array and its number of elements. */
+  struct SymTableRetired *psaNewBlocks;
+  size_t uNewCapacity;
+
+  assert(oSymTable != NULL);
+  assert(pvBlock != NULL);
+
+  psList = &oSymTable->asRetired[
+    __atomic_load_n(&oSymTable->uEpoch, __ATOMIC_RELAXED) & 1];
+
+  if (psList->uLength == psList->uCapacity) {
+    uNewCapacity = psList->uCapacity == 0 ? 16 : psList->uCapacity * 2;
+    psaNewBlocks = (struct SymTableRetired *)
+      realloc(psList->psaBlocks,
+              uNewCapacity * sizeof(struct SymTableRetired));
+    if (psaNewBlocks == NULL) {
+      SymTable_synchronize(oSymTable);
+      if (uSize == 0)
+        free(pvBlock);
+      else
+        Slab_release(&oSymTable->sSlab, pvBlock, uSize);
+      return;
+    }
+    psList->psaBlocks = psaNewBlocks;
+    psList->uCapacity = uNewCapacity;
+  }
+
+  psList->psaBlocks[psList->uLength].pvBlock = pvBlock;
+  psList->psaBlocks[psList->uLength].uSize = uSize;
+  psList->uLength++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free what retired blocks of oSymTable can be freed without waiting.
+   Every writer calls this before releasing the write lock, so memory
+   is reclaimed within a couple of writes once readers move on. */
+static void SymTable_reclaim(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  if (oSymTable->asRetired[0].uLength != 0 ||
+      oSymTable->asRetired[1].uLength != 0)
+    (void)SymTable_advanceEpoch(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest bucket count, a power of two that is at least
+   uInitialBucketCount, at which a SymTable holding uLength bindings
+   does not resize. */
+static size_t SymTable_bucketCountFor(size_t uLength) {
+  /* The candidate bucket count. */
+  size_t uBucketCount = uInitialBucketCount;
+
+  /* Stop doubling before the count overflows; allocating that many
+     buckets fails anyway. */
+  while (uBucketCount <= uLength && uBucketCount <= (size_t)-1 / 4)
+    uBucketCount *= 2;
+
+  return uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new, empty buckets array of uBucketCount buckets, or NULL
+   if insufficient memory is available. */
+static struct SymTableBuckets *SymTable_newBuckets(size_t uBucketCount)
+{
+  /* The new buckets array. */
+  struct SymTableBuckets *psBuckets;
+
+  if (uBucketCount >
+      ((size_t)-1 - sizeof(struct SymTableBuckets))
+      / sizeof(struct SymTableNode *))
+    return NULL;
+
+  psBuckets = (struct SymTableBuckets *)
+    calloc(1, sizeof(struct SymTableBuckets)
+              + uBucketCount * sizeof(struct SymTableNode *));
+  if (psBuckets == NULL)
+    return NULL;
+
+  psBuckets->uBucketCount = uBucketCount;
+  return psBuckets;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new buckets array of uBucketCount buckets holding copies,
+   allocated from psSlab, of the nodes of oSymTable, or NULL if
+   insufficient memory is available, in which case psSlab owns no more
+   memory in use than before. The array is not yet published, so it is
+   filled with plain stores. The caller must hold the write lock. */
+static struct SymTableBuckets *SymTable_copyBuckets(
+  SymTable_T oSymTable, size_t uBucketCount, struct Slab *psSlab)
+{
+  /* The current and the new buckets arrays. */
+  struct SymTableBuckets *psOldBuckets, *psNewBuckets;
+
+  /* The bucket being copied, and the new bucket index of a copy. */
+  size_t uBucket, uHashValue;
+
+  /* The node being copied, its size, and its copy. */
+  struct SymTableNode *psCurrentNode;
+  size_t uNodeSize;
+  struct SymTableNode *psNewNode;
+
+  assert(oSymTable != NULL);
+  assert(psSlab != NULL);
+
+  psNewBuckets = SymTable_newBuckets(uBucketCount);
+  if (psNewBuckets == NULL)
+    return NULL;
+
+  psOldBuckets = oSymTable->psBuckets;
+  for (uBucket = 0; uBucket < psOldBuckets->uBucketCount; uBucket++)
+    for (psCurrentNode = psOldBuckets->apsChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psCurrentNode->psNextNode)
+    {
+      uNodeSize = SymTable_nodeSize(strlen(psCurrentNode->acKey));
+      psNewNode = (struct SymTableNode *)Slab_alloc(psSlab, uNodeSize);
+      if (psNewNode == NULL) {
+        /* Give back the copies made so far. */
+        for (uBucket = 0; uBucket < uBucketCount; uBucket++)
+          while (psNewBuckets->apsChains[uBucket] != NULL) {
+            psNewNode = psNewBuckets->apsChains[uBucket];
+            psNewBuckets->apsChains[uBucket] = psNewNode->psNextNode;
+            Slab_release(psSlab, psNewNode,
+                         SymTable_nodeSize(strlen(psNewNode->acKey)));
+          }
+        free(psNewBuckets);
+        return NULL;
+      }
+
+      /* Nodes keep their hash codes, so copying them hashes nothing. */
+      memcpy(psNewNode, psCurrentNode, uNodeSize);
+      uHashValue = psNewNode->uHash & (uBucketCount - 1);
+      psNewNode->psNextNode = psNewBuckets->apsChains[uHashValue];
+      psNewBuckets->apsChains[uHashValue] = psNewNode;
+    }
+
+  return psNewBuckets;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count a resize of oSymTable if psNewBuckets, which replaces
+   psOldBuckets, has a different number of buckets. The caller must
+   hold the write lock. */
+static void SymTable_countResize(SymTable_T oSymTable,
+  const struct SymTableBuckets *psOldBuckets,
+  const struct SymTableBuckets *psNewBuckets)
+{
+  assert(oSymTable != NULL);
+  assert(psOldBuckets != NULL);
+  assert(psNewBuckets != NULL);
+
+  if (psNewBuckets->uBucketCount != psOldBuckets->uBucketCount)
+    __atomic_store_n(&oSymTable->uResizeCount,
+                     oSymTable->uResizeCount + 1, __ATOMIC_RELAXED);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the buckets array of oSymTable with one of uBucketCount
+   buckets. Readers that began earlier keep reading the old array and
+   its nodes, which are retired. Return 1 if successful, or 0 if
+   insufficient memory is available, in which case the buckets are
+   unchanged. The caller must hold the write lock. */
+static int SymTable_rebucket(SymTable_T oSymTable, size_t uBucketCount)
+{
+  /* The old and the new buckets arrays. */
+  struct SymTableBuckets *psOldBuckets, *psNewBuckets;
+
+  /* The bucket being retired. */
+  size_t uBucket;
+
+  /* The node being retired and the next node to be retired. */
+  struct SymTableNode *psCurrentNode, *psNextNode;
+
+  assert(oSymTable != NULL);
+
+  psNewBuckets =
+    SymTable_copyBuckets(oSymTable, uBucketCount, &oSymTable->sSlab);
+  if (psNewBuckets == NULL)
+    return 0;
+
+  psOldBuckets = oSymTable->psBuckets;
+  SYMTABLE_STORE(&oSymTable->psBuckets, psNewBuckets);
+  SymTable_countResize(oSymTable, psOldBuckets, psNewBuckets);
+
+  for (uBucket = 0; uBucket < psOldBuckets->uBucketCount; uBucket++)
+    for (psCurrentNode = psOldBuckets->apsChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psNextNode)
+    {
+      psNextNode = psCurrentNode->psNextNode;
+      SymTable_retire(oSymTable, psCurrentNode,
+                      SymTable_nodeSize(strlen(psCurrentNode->acKey)));
+    }
+  SymTable_retire(oSymTable, psOldBuckets, 0);
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Double the buckets of oSymTable once its number of bindings reaches
+   its number of buckets. If memory is insufficient the table keeps its
+   buckets, and works on with longer chains. The caller must hold the
+   write lock. */
+static void SymTable_resizeIfNecessary(SymTable_T oSymTable) {
+  /* The current bucket count. */
+  size_t uBucketCount;
+
+  assert(oSymTable != NULL);
+
+  uBucketCount = oSymTable->psBuckets->uBucketCount;
+  if (oSymTable->uLength < uBucketCount ||
+      uBucketCount > (size_t)-1 / 4)
+    return;
+
+  (void)SymTable_rebucket(oSymTable, uBucketCount * 2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Shrink the buckets of oSymTable once its load falls below 1/8, down
+   to a load of about 1/2, but never below uMinBucketCount. If memory
+   is insufficient the table keeps its buckets. The caller must hold
+   the write lock. */
+static void SymTable_shrinkIfNecessary(SymTable_T oSymTable) {
+  /* The current and the shrunken bucket counts. */
+  size_t uBucketCount, uNewBucketCount;
+
+  assert(oSymTable != NULL);
+
+  uBucketCount = oSymTable->psBuckets->uBucketCount;
+  if (oSymTable->uLength >= uBucketCount / 8)
+    return;
+
+  uNewBucketCount = SymTable_bucketCountFor(oSymTable->uLength * 2);
+  if (uNewBucketCount < oSymTable->uMinBucketCount)
+    uNewBucketCount = oSymTable->uMinBucketCount;
+  if (uNewBucketCount >= uBucketCount)
+    return;
+
+  (void)SymTable_rebucket(oSymTable, uNewBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link (a bucket or some node's psNextNode
+   field) of psBuckets that refers to the node whose key is pcKey,
+   where uHash is the full hash code of pcKey, or NULL if no such node
+   exists. Only writers, which hold the write lock, may call this, so
+   the links cannot change under it. */
+static struct SymTableNode **SymTable_findLink(
+  struct SymTableBuckets *psBuckets, const char *pcKey, size_t uHash)
+{
+  /* The link referring to the current node. */
+  struct SymTableNode **ppsLink;
+
+  /* The current node being examined. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(psBuckets != NULL);
+  assert(pcKey != NULL);
+
+  ppsLink =
+    &psBuckets->apsChains[uHash & (psBuckets->uBucketCount - 1)];
+  while ((psCurrentNode = *ppsLink) != NULL) {
+    PROFILE_PROBE();
+    if (psCurrentNode->uHash == uHash &&
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0)
+      return ppsLink;
+    ppsLink = &psCurrentNode->psNextNode;
+  }
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of psBuckets whose key is pcKey, where uHash is the
+   full hash code of pcKey, or NULL if no such node exists. Readers
+   call this inside a read section. Each link is loaded once, since a
+   writer may change it meanwhile. */
+static struct SymTableNode *SymTable_findNode(
+  struct SymTableBuckets *psBuckets, const char *pcKey, size_t uHash)
+{
+  /* The current node being examined. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(psBuckets != NULL);
+  assert(pcKey != NULL);
+
+  for (psCurrentNode = SYMTABLE_LOAD(
+         &psBuckets->apsChains[uHash & (psBuckets->uBucketCount - 1)]);
+       psCurrentNode != NULL;
+       psCurrentNode = SYMTABLE_LOAD(&psCurrentNode->psNextNode)) {
+    PROFILE_PROBE();
+    if (psCurrentNode->uHash == uHash &&
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0)
+      return psCurrentNode;
+  }
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding of oSymTable whose key is pcKey,
+   where uHash is the full hash code of pcKey, or NULL if no such
+   binding exists. Set *piFound to 1 if the binding exists, or to 0
+   otherwise. Takes no lock. */
+static void *SymTable_read(SymTable_T oSymTable, const char *pcKey,
+  size_t uHash, int *piFound)
+{
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The target node. */
+  struct SymTableNode *psNode;
+
+  /* The value of the target binding. */
+  void *pvValue = NULL;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(piFound != NULL);
+
+  puReaders = SymTable_readBegin(oSymTable);
+  psNode = SymTable_findNode(SYMTABLE_LOAD(&oSymTable->psBuckets),
+                             pcKey, uHash);
+  *piFound = psNode != NULL;
+  if (psNode != NULL)
+    pvValue = SYMTABLE_LOAD(&psNode->pvValue);
+  SymTable_readEnd(puReaders);
+
+  return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oSymTable whose key is pcKey, where uHash is the
+   full hash code of pcKey, first inserting a new node with key pcKey
+   and value pvValue if no such node exists, or NULL if insufficient
+   memory is available. Set *piInserted to 1 if a new node was
+   inserted, or to 0 otherwise. The caller must hold the write lock. */
+static struct SymTableNode *SymTable_findOrInsert(SymTable_T oSymTable,
+  const char *pcKey, size_t uHash, const void *pvValue, int *piInserted)
+{
+  /* The buckets array. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The link referring to an existing node with key pcKey. */
+  struct SymTableNode **ppsLink;
+
+  /* The bucket to add the new node to. */
+  size_t uHashValue;
+
+  /* The length of the new binding's key. */
+  size_t uKeyLength;
+
+  /* The node corresponding to the new binding. */
+  struct SymTableNode *psNewNode;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(piInserted != NULL);
+
+  *piInserted = 0;
+
+  psBuckets = oSymTable->psBuckets;
+  ppsLink = SymTable_findLink(psBuckets, pcKey, uHash);
+  if (ppsLink != NULL)
+    return *ppsLink;
+
+  uKeyLength = strlen(pcKey);
+  psNewNode = (struct SymTableNode *)
+    Slab_alloc(&oSymTable->sSlab, SymTable_nodeSize(uKeyLength));
+  if (psNewNode == NULL)
+    return NULL;
+
+  /* Build the whole node before publishing it. */
+  memcpy(psNewNode->acKey, pcKey, uKeyLength + 1);
+  psNewNode->uHash = uHash;
+  psNewNode->pvValue = (void *)pvValue;
+  uHashValue = uHash & (psBuckets->uBucketCount - 1);
+  psNewNode->psNextNode = psBuckets->apsChains[uHashValue];
+
+  /* Publish it at the front of its chain. */
+  SYMTABLE_STORE(&psBuckets->apsChains[uHashValue], psNewNode);
+  __atomic_store_n(&oSymTable->uLength, oSymTable->uLength + 1,
+                   __ATOMIC_RELAXED);
+  *piInserted = 1;
+
+  /* A resize copies the nodes, so find the new node again. */
+  SymTable_resizeIfNecessary(oSymTable);
+  if (oSymTable->psBuckets != psBuckets)
+    psNewNode = *SymTable_findLink(oSymTable->psBuckets, pcKey, uHash);
+
+  return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void) {
+  return SymTable_newWithCapacity(0);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* Reference to struct SymTable "manager" of given SymTable
+     instance. */
+  SymTable_T oSymTable;
+
+  /* The memory of the "manager", aligned to a cache line. */
+  void *pvMemory;
+
+  /* Incrementor over the reader slots. */
+  size_t u;
+
+  if (posix_memalign(&pvMemory, CACHE_LINE, sizeof(struct SymTable))
+      != 0)
+    return NULL;
+  oSymTable = (SymTable_T)pvMemory;
+
+  oSymTable->psBuckets =
+    SymTable_newBuckets(SymTable_bucketCountFor(uCapacity));
+  if (oSymTable->psBuckets == NULL) {
+    free(oSymTable);
+    return NULL;
+  }
+
+  if (pthread_mutex_init(&oSymTable->sWriteLock, NULL) != 0) {
+    free(oSymTable->psBuckets);
+    free(oSymTable);
+    return NULL;
+  }
+
+  for (u = 0; u < READER_SLOTS; u++) {
+    oSymTable->asReaderSlots[u].auReaders[0] = 0;
+    oSymTable->asReaderSlots[u].auReaders[1] = 0;
+  }
+  for (u = 0; u < 2; u++) {
+    oSymTable->asRetired[u].psaBlocks = NULL;
+    oSymTable->asRetired[u].uLength = 0;
+    oSymTable->asRetired[u].uCapacity = 0;
+  }
+
+  oSymTable->uLength = 0;
+  oSymTable->uResizeCount = 0;
+  oSymTable->uEpoch = 0;
+
+  /* Removals never shrink the table below its initial size. */
+  oSymTable->uMinBucketCount = oSymTable->psBuckets->uBucketCount;
+
+  /* Choose this table's hash seed. This also draws the process seed,
+     if it has not been drawn yet. */
+  oSymTable->uSeed = StrHash_newSeed(oSymTable);
+
+  /* The table owns no nodes yet. */
+  Slab_init(&oSymTable->sSlab);
+  PROFILE_INIT(&oSymTable->sProfile);
+
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable) {
+  /* Incrementors over the retired lists and their blocks. */
+  size_t u, uBlock;
+
+  assert(oSymTable != NULL);
+
+  /* No reader remains, so free the retired buckets arrays now. The
+     retired nodes go with the slab. */
+  for (u = 0; u < 2; u++) {
+    for (uBlock = 0; uBlock < oSymTable->asRetired[u].uLength; uBlock++)
+      if (oSymTable->asRetired[u].psaBlocks[uBlock].uSize == 0)
+        free(oSymTable->asRetired[u].psaBlocks[uBlock].pvBlock);
+    free(oSymTable->asRetired[u].psaBlocks);
+  }
+
+  /* Free all nodes, with their key copies, chunk by chunk rather than
+     walking every node chain. */
+  Slab_clear(&oSymTable->sSlab);
+
+  pthread_mutex_destroy(&oSymTable->sWriteLock);
+  free(oSymTable->psBuckets);
+  free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  return __atomic_load_n(&oSymTable->uLength, __ATOMIC_RELAXED);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The buckets array being measured. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The bucket being measured, and the length of its chain. */
+  size_t uBucket, uChainLength;
+
+  /* The node being counted. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
+
+  memset(psStats, 0, sizeof(struct SymTableStats));
+
+  /* Like SymTable_map, measure the buckets array that was current at
+     the start, counting its nodes rather than reading uLength, so that
+     the figures agree with one another. */
+  puReaders = SymTable_readBegin(oSymTable);
+  psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  for (uBucket = 0; uBucket < psBuckets->uBucketCount; uBucket++) {
+    uChainLength = 0;
+    for (psCurrentNode = SYMTABLE_LOAD(&psBuckets->apsChains[uBucket]);
+         psCurrentNode != NULL;
+         psCurrentNode = SYMTABLE_LOAD(&psCurrentNode->psNextNode))
+    {
+      psStats->uKeyBytes += strlen(psCurrentNode->acKey) + 1;
+      uChainLength++;
+    }
+
+    psStats->uLength += uChainLength;
+    if (uChainLength > psStats->uLongestChain)
+      psStats->uLongestChain = uChainLength;
+    psStats->auChainCounts[uChainLength < SYMTABLE_STATS_CHAINS ?
+                           uChainLength : SYMTABLE_STATS_CHAINS - 1]++;
+  }
+  psStats->uBucketCount = psBuckets->uBucketCount;
+  psStats->uResizeCount =
+    __atomic_load_n(&oSymTable->uResizeCount, __ATOMIC_RELAXED);
+  SymTable_readEnd(puReaders);
+
+  psStats->dLoadFactor =
+    (double)psStats->uLength / (double)psStats->uBucketCount;
+  psStats->uNodeBytes =
+    psStats->uLength * offsetof(struct SymTableNode, acKey);
+  psStats->uBucketBytes = offsetof(struct SymTableBuckets, apsChains)
+    + psStats->uBucketCount * sizeof(struct SymTableNode *);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
+  assert(oSymTable != NULL);
+  assert(psFile != NULL);
+
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  /* The bucket count that holds uCapacity bindings. */
+  size_t uBucketCount;
+
+  /* Whether the reservation succeeded. */
+  int iSuccessful = 1;
+
+  assert(oSymTable != NULL);
+
+  uBucketCount = SymTable_bucketCountFor(uCapacity);
+
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+
+  /* Jump straight to the final bucket count, copying each node once. */
+  if (uBucketCount > oSymTable->psBuckets->uBucketCount)
+    iSuccessful = SymTable_rebucket(oSymTable, uBucketCount);
+
+  /* Removals never shrink the table below the reservation. */
+  if (iSuccessful && uBucketCount > oSymTable->uMinBucketCount)
+    oSymTable->uMinBucketCount = uBucketCount;
+
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+
+  return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The slab of the copies. */
+  struct Slab sNewSlab;
+
+  /* The old and the new buckets arrays. */
+  struct SymTableBuckets *psOldBuckets, *psNewBuckets;
+
+  assert(oSymTable != NULL);
+
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+
+  /* Copy the nodes into a fresh slab, so the chunks left sparse by
+     removals go back to the system. */
+  Slab_init(&sNewSlab);
+  psNewBuckets = SymTable_copyBuckets(oSymTable,
+    SymTable_bucketCountFor(oSymTable->uLength), &sNewSlab);
+  if (psNewBuckets == NULL) {
+    Slab_clear(&sNewSlab);
+    pthread_mutex_unlock(&oSymTable->sWriteLock);
+    return 0;
+  }
+
+  psOldBuckets = oSymTable->psBuckets;
+  SYMTABLE_STORE(&oSymTable->psBuckets, psNewBuckets);
+  SymTable_countResize(oSymTable, psOldBuckets, psNewBuckets);
+
+  /* The whole old slab is freed at once, so wait for every reader that
+     may still read it, which also frees every retired block. */
+  SymTable_synchronize(oSymTable);
+  free(psOldBuckets);
+  Slab_clear(&oSymTable->sSlab);
+  oSymTable->sSlab = sNewSlab;
+
+  /* Drop any reservation. */
+  oSymTable->uMinBucketCount = 0;
+
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+  const void *pvValue)
+{
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_putHashed(oSymTable, pcKey, SymTable_hashKey(pcKey),
+                            pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The previous value of the target binding before replacing. */
+  void *pvOldValue = NULL;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REPLACE);
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+
+  ppsLink = SymTable_findLink(oSymTable->psBuckets, pcKey,
+                              SymTable_hash(oSymTable, pcKey));
+  if (ppsLink != NULL) {
+    pvOldValue = (*ppsLink)->pvValue;
+    SYMTABLE_STORE(&(*ppsLink)->pvValue, (void *)pvValue);
+  }
+
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_containsHashed(oSymTable, pcKey,
+                                 SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_getHashed(oSymTable, pcKey, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The buckets array that every lookup of the batch searches. */
+  struct SymTableBuckets *psBuckets;
+
+  /* A target node. */
+  struct SymTableNode *psNode;
+
+  /* Incrementor over the keys. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  /* One read section covers the whole batch. */
+  puReaders = SymTable_readBegin(oSymTable);
+  psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  for (u = 0; u < uCount; u++) {
+    assert(apcKeys[u] != NULL);
+    psNode = SymTable_findNode(psBuckets, apcKeys[u],
+                               SymTable_hash(oSymTable, apcKeys[u]));
+    apvOut[u] =
+      psNode == NULL ? NULL : SYMTABLE_LOAD(&psNode->pvValue);
+  }
+  SymTable_readEnd(puReaders);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The node being removed. */
+  struct SymTableNode *psCurrentNode;
+
+  /* The value of the target binding before removing. */
+  void *pvReturnValue = NULL;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REMOVE);
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+
+  ppsLink = SymTable_findLink(oSymTable->psBuckets, pcKey,
+                              SymTable_hash(oSymTable, pcKey));
+  if (ppsLink != NULL) {
+    /* Unlink the node. Readers standing on it still find the rest of
+       its chain through its own link, which is left intact. */
+    psCurrentNode = *ppsLink;
+    SYMTABLE_STORE(ppsLink, psCurrentNode->psNextNode);
+    __atomic_store_n(&oSymTable->uLength, oSymTable->uLength - 1,
+                     __ATOMIC_RELAXED);
+
+    pvReturnValue = psCurrentNode->pvValue;
+    SymTable_retire(oSymTable, psCurrentNode,
+                    SymTable_nodeSize(strlen(psCurrentNode->acKey)));
+
+    /* Give memory back after mass removals. */
+    SymTable_shrinkIfNecessary(oSymTable);
+  }
+
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  return pvReturnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey,
+                                 SymTable_hash(oSymTable, pcKey),
+                                 pvValue, &iInserted);
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+
+  if (psNode == NULL)
+    return NULL;
+
+  /* Give the address of the binding's value. It is valid only until
+     the next write by any thread, since a resize copies the node and
+     retires this one; threads that share the table update values with
+     SymTable_upsertWith. Readers load the value atomically, so a store
+     through this address must be made with __atomic_store_n while
+     readers run. */
+  return &psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  /* pfCombine runs under the write lock, so combining is atomic with
+     respect to other writers. */
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey,
+                                 SymTable_hash(oSymTable, pcKey),
+                                 pvValue, &iInserted);
+  if (psNode != NULL && ! iInserted)
+    SYMTABLE_STORE(&psNode->pvValue,
+                   pfCombine(psNode->acKey, psNode->pvValue,
+                             (void *)pvValue, (void *)pvExtra));
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+
+  return psNode != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  return StrHash_hash(pcKey, StrHash_processSeed());
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  pthread_mutex_lock(&oSymTable->sWriteLock);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey,
+                                 SymTable_seedHash(oSymTable, uHashKey),
+                                 pvValue, &iInserted);
+  SymTable_reclaim(oSymTable);
+  pthread_mutex_unlock(&oSymTable->sWriteLock);
+  PROFILE_END(&oSymTable->sProfile, psNode != NULL && ! iInserted);
+
+  /* If a binding with the same key does exist, put fails and SymTable
+     is unchanged. Put also fails if memory for the new node is
+     insufficient. */
+  return psNode != NULL && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* Whether the binding exists. */
+  int iFound;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  (void)SymTable_read(oSymTable, pcKey,
+                      SymTable_seedHash(oSymTable, uHashKey), &iFound);
+  return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* Whether the binding exists. */
+  int iFound;
+
+  /* The value of the target binding. */
+  void *pvValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+  pvValue = SymTable_read(oSymTable, pcKey,
+                          SymTable_seedHash(oSymTable, uHashKey),
+                          &iFound);
+  PROFILE_END(&oSymTable->sProfile, iFound);
+
+  return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The buckets array being walked. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The bucket being walked. */
+  size_t uBucket;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  /* map is a reader, so it walks the buckets array that was current
+     when it began, while writers may go on. pfApply should call no
+     writer of oSymTable: SymTable_shrinkToFit, and a writer short of
+     memory for its retired blocks, wait for every read section to end,
+     this one included. */
+  puReaders = SymTable_readBegin(oSymTable);
+  psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  for (uBucket = 0; uBucket < psBuckets->uBucketCount; uBucket++)
+    for (psCurrentNode = SYMTABLE_LOAD(&psBuckets->apsChains[uBucket]);
+         psCurrentNode != NULL;
+         psCurrentNode = SYMTABLE_LOAD(&psCurrentNode->psNextNode))
+      (*pfApply)(psCurrentNode->acKey,
+                 SYMTABLE_LOAD(&psCurrentNode->pvValue),
+                 (void *)pvExtra);
+  SymTable_readEnd(puReaders);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks. */
+
+struct SymTableMapping {
+  /* The buckets array being walked. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the chains of the MAP_CHUNK buckets of task uTask, passing the
+   pvExtra of worker uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+
+  /* The pvExtra of the worker. */
+  void *pvExtra;
+
+  /* The bucket being walked, and the end of the task. */
+  size_t uBucket;
+  size_t uEnd;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(psMapping != NULL);
+
+  pvExtra = psMapping->apvExtras == NULL ?
+    NULL : psMapping->apvExtras[uWorker];
+  uEnd = (uTask + 1) * MAP_CHUNK;
+  if (uEnd > psMapping->psBuckets->uBucketCount)
+    uEnd = psMapping->psBuckets->uBucketCount;
+
+  for (uBucket = uTask * MAP_CHUNK; uBucket < uEnd; uBucket++)
+    for (psCurrentNode =
+           SYMTABLE_LOAD(&psMapping->psBuckets->apsChains[uBucket]);
+         psCurrentNode != NULL;
+         psCurrentNode = SYMTABLE_LOAD(&psCurrentNode->psNextNode))
+      (*psMapping->pfApply)(psCurrentNode->acKey,
+                            SYMTABLE_LOAD(&psCurrentNode->pvValue),
+                            pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks. */
+  struct SymTableMapping sMapping;
+
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  /* As in SymTable_map, writers may go on. The one read section of
+     the calling thread keeps the walked nodes and buckets array from
+     being freed until every worker is done with them. */
+  puReaders = SymTable_readBegin(oSymTable);
+  sMapping.psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  WorkPool_run((sMapping.psBuckets->uBucketCount + MAP_CHUNK - 1)
+               / MAP_CHUNK, uThreadCount, SymTable_mapTask, &sMapping);
+  SymTable_readEnd(puReaders);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator is a reader that stays inside one read section from
+   SymTable_iterBegin to SymTable_iterEnd, walking the buckets array
+   that was current when it began while writers go on. Until it ends,
+   blocks that writers retire are not reclaimed, and the iterating
+   thread must call no writer of the table that may wait for readers
+   (SymTable_shrinkToFit, or any writer short of memory). */
+
+struct SymTableIter {
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The buckets array walked. */
+  struct SymTableBuckets *psBuckets;
+
+  /* The next bucket to walk. */
+  size_t uNextBucket;
+
+  /* The next node of the current chain, or NULL at its end. */
+  struct SymTableNode *psNextNode;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+
+  oIter->puReaders = SymTable_readBegin(oSymTable);
+  oIter->psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  oIter->uNextBucket = 0;
+  oIter->psNextNode = NULL;
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The node visited. */
+  struct SymTableNode *psNode;
+
+  assert(oIter != NULL);
+
+  /* The length changes under writers, so every bucket is walked. */
+  while (oIter->psNextNode == NULL) {
+    if (oIter->uNextBucket == oIter->psBuckets->uBucketCount)
+      return 0;
+    oIter->psNextNode = SYMTABLE_LOAD(
+      &oIter->psBuckets->apsChains[oIter->uNextBucket++]);
+  }
+  psNode = oIter->psNextNode;
+  oIter->psNextNode = SYMTABLE_LOAD(&psNode->psNextNode);
+
+  if (ppcKey != NULL)
+    *ppcKey = psNode->acKey;
+  if (ppvValue != NULL)
+    *ppvValue = SYMTABLE_LOAD(&psNode->pvValue);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  SymTable_readEnd(oIter->puReaders);
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the cursor that follows uCursor in a scan of the buckets
+   whose indices are masked by uMask, one less than a power of two, or
+   0 after the last bucket. Cursors count in reverse binary, carrying
+   from the highest bit of uMask down, so the buckets that a bucket
+   splits into when the bucket count doubles, or merges with when it
+   halves, come next to one another in the order of the scan. */
+static size_t SymTable_nextCursor(size_t uCursor, size_t uMask) {
+  /* The bit being incremented. */
+  size_t uBit = uMask - (uMask >> 1);
+
+  uCursor &= uMask;
+  while ((uCursor & uBit) != 0) {
+    uCursor &= ~uBit;
+    uBit >>= 1;
+  }
+  return uCursor | uBit;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* The buckets array walked, and the mask of its bucket indices. */
+  struct SymTableBuckets *psBuckets;
+  size_t uMask;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* Each call is a reader of the buckets array current when it
+     began, so writers go on meanwhile and between calls. */
+  puReaders = SymTable_readBegin(oSymTable);
+  psBuckets = SYMTABLE_LOAD(&oSymTable->psBuckets);
+  uMask = psBuckets->uBucketCount - 1;
+  do {
+    for (psCurrentNode =
+           SYMTABLE_LOAD(&psBuckets->apsChains[uCursor & uMask]);
+         psCurrentNode != NULL;
+         psCurrentNode = SYMTABLE_LOAD(&psCurrentNode->psNextNode))
+      (*pfApply)(psCurrentNode->acKey,
+                 SYMTABLE_LOAD(&psCurrentNode->pvValue),
+                 (void *)pvExtra);
+    uCursor = SymTable_nextCursor(uCursor, uMask);
+  } while (--uBudget > 0 && uCursor != 0);
+  SymTable_readEnd(puReaders);
+
+  return uCursor;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings with the prefix. */
+  struct KeyOrder sOrder;
+
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* Return value. */
+  int iSuccessful;
+
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  /* Hashing scatters the keys, so the bindings are gathered and sorted
+     by key. The gathered keys are those of nodes that writers may
+     retire, so one read section spans the gathering and the applying;
+     the section of SymTable_map nests within it. */
+  puReaders = SymTable_readBegin(oSymTable);
+  KeyOrder_init(&sOrder, NULL, NULL, pcPrefix);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  iSuccessful = KeyOrder_apply(&sOrder, pfApply, pvExtra);
+  SymTable_readEnd(puReaders);
+  return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings in the range. */
+  struct KeyOrder sOrder;
+
+  /* The counter of the read section. */
+  size_t *puReaders;
+
+  /* Return value. */
+  int iSuccessful;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  /* As for SymTable_mapPrefix. */
+  puReaders = SymTable_readBegin(oSymTable);
+  KeyOrder_init(&sOrder, pcLow, pcHigh, NULL);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  iSuccessful = KeyOrder_apply(&sOrder, pfApply, pvExtra);
+  SymTable_readEnd(puReaders);
+  return iSuccessful;
+}
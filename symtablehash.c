@@ -5,545 +5,1917 @@
 
 #include <stddef.h>
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include "symtable.h"
+#include "strhash.h"
+#include "slab.h"
+#include "workpool.h"
+#include "keyorder.h"
+#include "profile.h"
 
 /*--------------------------------------------------------------------*/
 
-/* The different bucket counts that the hash table can have as it 
-   grows. */
-static const size_t auBucketCounts[8] = {509, 1021, 2039, 4093, 8191, 
-                                         16381, 32749, 65521};
+/* The number of old buckets that each operation moves into the new
+   buckets array while an incremental resize is in progress. Defining
+   it as 0 selects a stop-the-world resize, which moves every bucket
+   inside the put that triggers the resize. */
+#ifndef SYMTABLE_REHASH_STEP
+#define SYMTABLE_REHASH_STEP 4
+#endif
 
 /*--------------------------------------------------------------------*/
 
-/* The total number of bucket sizes in hash table. */
-static const size_t numBucketCounts = sizeof(auBucketCounts) / 
-                                      sizeof(auBucketCounts[0]);
+/* The number of lookups that SymTable_getBatch interleaves. Each stage
+   of a lookup issues its memory access for every key of the group
+   before the next stage uses any of them. */
+enum {BATCH_GROUP = 16};
+
+/* The number of buckets that each task of SymTable_mapParallel
+   walks. */
+enum {MAP_CHUNK = 256};
+
+/* Hint that the memory at p will be read soon, if the compiler
+   supports it. */
+#ifdef __GNUC__
+#define SYMTABLE_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define SYMTABLE_PREFETCH(p) ((void)(p))
+#endif
+
+/* The number of buckets whose occupancy one word of a bitmap
+   records. */
+enum {OCCUPANCY_BITS = sizeof(size_t) * CHAR_BIT};
+
+/* Return the index of the lowest set bit of u, which is not 0, with
+   one instruction if the compiler supports it. */
+#ifdef __GNUC__
+#define SYMTABLE_CTZ(u) \
+  ((size_t)__builtin_ctzll((unsigned long long)(u)))
+#else
+#define SYMTABLE_CTZ(u) SymTable_ctz(u)
+static size_t SymTable_ctz(size_t u) {
+  /* The number of zero bits below the lowest set bit. */
+  size_t uZeros = 0;
+
+  assert(u != 0);
+
+  for (; (u & 1) == 0; u >>= 1)
+    uZeros++;
+  return uZeros;
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bindings a SymTable holds in its inline array before
+   it allocates a buckets array. Most tables of a program, such as
+   those of small scopes, never grow past it. */
+#ifndef SYMTABLE_SMALL_CAPACITY
+#define SYMTABLE_SMALL_CAPACITY 16
+#endif
+
+#if SYMTABLE_SMALL_CAPACITY < 1
+#error "SYMTABLE_SMALL_CAPACITY must be at least 1"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The smallest bucket count, which is also the bucket count of a table
+   that has just outgrown its inline array. Bucket counts are always
+   powers of two, so a hash code is reduced to a bucket index with a
+   mask instead of a division, and the table doubles without limit. */
+static const size_t uInitialBucketCount = 16;
 
 /*--------------------------------------------------------------------*/
 
 /* Each item stored in a SymTable. SymTableNodes are linked to form a 
-   chain connected to a bucket element in an array of buckets. */
+   chain connected to a bucket element in an array of buckets. Each
+   node is a single block that ends with the defensive copy of its
+   key. */
 
 struct SymTableNode {
-  /* The string key. */
-  char *pcKey; 
+  /* The full (unreduced) hash code of acKey, so that rehashing never
+     reads key bytes and most mismatching nodes are rejected without a
+     strcmp. A small table compares keys without hashing them, so the
+     field is meaningful only while the node's table has buckets. */
+  size_t uHash;
 
   /* The generic value. */
   void *pvValue; 
 
   /* A reference to the next node in the list. */
   struct SymTableNode *psNextNode; 
+
+  /* The string key, stored inline. */
+  char acKey[];
 };
 
 /*--------------------------------------------------------------------*/
 
 /* A SymTable structure is a "manager" structure which tracks the first
-   SymTableNode in each chain associated with each bucket; it stores an 
-   index for accessing the current bucket size from auBucketCounts; it 
-   tracks the total number of elements (length) in the SymTable. */
+   SymTableNode in each chain associated with each bucket; it stores
+   the current bucket count; it tracks the total number of elements
+   (length) in the SymTable. While an incremental resize is in
+   progress, it also tracks the previous buckets array, whose chains
+   have not all been moved yet. A small table has no buckets array and
+   keeps its nodes in an inline array instead. */
 
 struct SymTable {
-  /* Array of "buckets" which each have an associated chain of nodes. */
+  /* Array of "buckets" which each have an associated chain of nodes,
+     or NULL while the table is small. Each buckets array is followed,
+     in the same block, by its occupancy bitmap; see
+     SymTable_newChains. */
   struct SymTableNode **psaNodeChains;
 
-  /* The index of the current bucket size in auBucketCounts. */
-  size_t iBucketSizeIndex;
+  /* The number of buckets in psaNodeChains, a power of two, or 0 while
+     the table is small. */
+  size_t uBucketCount;
+
+  /* While the table is small, its nodes are the first uLength
+     elements, in no particular order, and are scanned linearly. Their
+     psNextNode fields are unused. */
+  struct SymTableNode *apsSmallNodes[SYMTABLE_SMALL_CAPACITY];
+
+  /* The buckets array being migrated into psaNodeChains, which has
+     uBucketCount / 2 buckets, or NULL if no resize is in progress. */
+  struct SymTableNode **psaOldNodeChains;
+
+  /* The index of the next bucket of psaOldNodeChains to migrate. All
+     buckets before it are empty. */
+  size_t uMigrateIndex;
+
+  /* The bucket count below which removals never shrink the table, as
+     reserved by SymTable_newWithCapacity or SymTable_reserve. */
+  size_t uMinBucketCount;
 
   /* The total number of bindings in SymTable. */
   size_t uLength;
+
+  /* The number of times the bucket count has changed, promotions and
+     demotions included, for SymTable_getStats. */
+  size_t uResizeCount;
+
+  /* The seed of this table's hash function, chosen at random when the
+     table is created so that colliding keys cannot be precomputed. */
+  size_t uSeed;
+
+  /* The allocator of this table's nodes. */
+  struct Slab sSlab;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table; see profile.h. */
+  struct Profile sProfile;
+#endif
 };
 
 /*--------------------------------------------------------------------*/
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-  inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+/* Return the size in bytes of the occupancy bitmap of a buckets array
+   of uBucketCount buckets. */
+static size_t SymTable_bitmapSize(size_t uBucketCount) {
+  return (uBucketCount + OCCUPANCY_BITS - 1) / OCCUPANCY_BITS
+         * sizeof(size_t);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new buckets array of uBucketCount empty buckets, or NULL if
+   insufficient memory is available. The array is followed, in the same
+   block, by its occupancy bitmap, whose bit i is set exactly when
+   bucket i is nonempty, so that walks jump from one nonempty bucket to
+   the next instead of reading every bucket of a sparse table. The
+   whole block is freed with free(). */
+static struct SymTableNode **SymTable_newChains(size_t uBucketCount) {
+  /* The size in bytes of the bitmap. */
+  size_t uBitmapSize;
+
+  assert(uBucketCount > 0);
+
+  uBitmapSize = SymTable_bitmapSize(uBucketCount);
+  if (uBucketCount > ((size_t)-1 - uBitmapSize)
+                     / sizeof(struct SymTableNode *))
+    return NULL;
+  return (struct SymTableNode **)
+    calloc(1, uBucketCount * sizeof(struct SymTableNode *)
+              + uBitmapSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the occupancy bitmap of psaNodeChains, a buckets array of
+   uBucketCount buckets. */
+static size_t *SymTable_occupancy(struct SymTableNode **psaNodeChains,
+                                  size_t uBucketCount)
 {
-   const size_t HASH_MULTIPLIER = 65599;
-   size_t u;
-   size_t uHash = 0;
+  assert(psaNodeChains != NULL);
 
-   assert(pcKey != NULL);
+  return (size_t *)(psaNodeChains + uBucketCount);
+}
 
-   for (u = 0; pcKey[u] != '\0'; u++)
-      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+/*--------------------------------------------------------------------*/
 
-   return uHash % uBucketCount;
+/* Put psNode at the start of the chain of bucket uBucket of
+   psaNodeChains, a buckets array of uBucketCount buckets, marking the
+   bucket nonempty. */
+static void SymTable_pushNode(struct SymTableNode **psaNodeChains,
+  size_t uBucketCount, size_t uBucket, struct SymTableNode *psNode)
+{
+  assert(psaNodeChains != NULL);
+  assert(uBucket < uBucketCount);
+  assert(psNode != NULL);
+
+  psNode->psNextNode = psaNodeChains[uBucket];
+  psaNodeChains[uBucket] = psNode;
+  SymTable_occupancy(psaNodeChains, uBucketCount)
+    [uBucket / OCCUPANCY_BITS] |= (size_t)1 << uBucket % OCCUPANCY_BITS;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Resizes the hash table associated with the SymTable ADT referenced 
-   by oSymTable. If the hash table is already maximally sized (maxed 
-   number of buckets), then no resize will occur. */
-static void SymTable_resizeIfNecessary(SymTable_T oSymTable) {
-  /* The resized buckets array. */
-  struct SymTableNode **psNewBucketList;
+/* Mark bucket uBucket of psaNodeChains, a buckets array of
+   uBucketCount buckets, empty if its chain is. */
+static void SymTable_noteIfEmpty(struct SymTableNode **psaNodeChains,
+  size_t uBucketCount, size_t uBucket)
+{
+  assert(psaNodeChains != NULL);
+  assert(uBucket < uBucketCount);
 
-  /* The current bucket count and new/expanded bucket count. */
-  size_t uCurrentBucketCount, uNewBucketCount;
+  if (psaNodeChains[uBucket] == NULL)
+    SymTable_occupancy(psaNodeChains, uBucketCount)
+      [uBucket / OCCUPANCY_BITS] &=
+        ~((size_t)1 << uBucket % OCCUPANCY_BITS);
+}
 
-  /* The current node being rehashed into new buckets array and the next
-     node to be rehashed into new buckets array. */
-  struct SymTableNode *psCurrentNode, *psNextNode;
+/*--------------------------------------------------------------------*/
 
-  /* The new hash index of the current node. */
-  size_t uHashValue;
+/* Return the index of the first nonempty bucket of psaNodeChains, a
+   buckets array of uBucketCount buckets, from uBucket up to but not
+   including uEnd, or uEnd if they are all empty. Each word of the
+   bitmap skips OCCUPANCY_BITS buckets at once. */
+static size_t SymTable_nextOccupied(struct SymTableNode **psaNodeChains,
+  size_t uBucketCount, size_t uBucket, size_t uEnd)
+{
+  /* The bitmap, the index of the word being read, and the bits of
+     that word from uBucket on. */
+  size_t *puOccupancy;
+  size_t uWord;
+  size_t uBits;
+
+  assert(psaNodeChains != NULL);
+  assert(uEnd <= uBucketCount);
+
+  if (uBucket >= uEnd)
+    return uEnd;
+
+  puOccupancy = SymTable_occupancy(psaNodeChains, uBucketCount);
+  uWord = uBucket / OCCUPANCY_BITS;
+  uBits = puOccupancy[uWord] & ((size_t)-1 << uBucket % OCCUPANCY_BITS);
+  while (uBits == 0) {
+    uWord++;
+    if (uWord * OCCUPANCY_BITS >= uEnd)
+      return uEnd;
+    uBits = puOccupancy[uWord];
+  }
 
-  /* The index correpsonding to current and next bucket size in 
-     SymTable's bucket size array. */
-  size_t iBucketSizeIndex; 
+  uBucket = uWord * OCCUPANCY_BITS + SYMTABLE_CTZ(uBits);
+  return uBucket < uEnd ? uBucket : uEnd;
+}
 
-  /* Iterator variable to access each bucket in both the original and 
-     new bucket arrays. */
-  size_t i;
+/*--------------------------------------------------------------------*/
 
+/* Return the full hash code under the seed of oSymTable of the key
+   whose token from SymTable_hashKey is uHashKey. */
+static size_t SymTable_seedHash(SymTable_T oSymTable, size_t uHashKey) {
   assert(oSymTable != NULL);
 
-  /* Determine the current bucket count. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
-  uCurrentBucketCount = auBucketCounts[iBucketSizeIndex];
-
-  /* Proceed with the resize iff the number of bindings equals the 
-     current number of buckets or the bucket count is maxed. Otherwise, 
-     stop the function call. */
-  if (SymTable_getLength(oSymTable) != uCurrentBucketCount || 
-      iBucketSizeIndex == numBucketCounts - 1) 
-    return;
+  return StrHash_mixSeed(uHashKey, oSymTable->uSeed);
+}
 
-  /* Determine the new bucket count by incrementing to the next highest 
-     bucket count. */
-  uNewBucketCount = auBucketCounts[++iBucketSizeIndex];
+/*--------------------------------------------------------------------*/
 
-  /* Allocate memory for the new buckets array according to the new 
-     bucket count. */
-  psNewBucketList = calloc(uNewBucketCount, 
-                      sizeof(struct SymTableNode *));
+/* Return the full hash code for pcKey under the seed of oSymTable.
+   Mask it with a bucket count minus one to find the bucket of pcKey. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
 
-  /* Check that memory was allocated successfully. */
-  if (psNewBucketList == NULL) {
+  return SymTable_seedHash(oSymTable, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move up to uBucketCount chains of the old buckets array of the
+   SymTable ADT referenced by oSymTable into its current buckets array,
+   or every remaining chain if uBucketCount is 0. Free the old buckets
+   array once it is empty. Do nothing if no resize is in progress. */
+static void SymTable_migrate(SymTable_T oSymTable, size_t uBucketCount)
+{
+  /* The bucket counts of the old and current buckets arrays. */
+  size_t uOldBucketCount, uNewBucketCount;
+
+  /* The old bucket index after which migration stops this call. */
+  size_t uStopIndex;
+
+  /* The current node being moved into the current buckets array and
+     the next node to be moved. */
+  struct SymTableNode *psCurrentNode, *psNextNode;
+
+  /* The new bucket index of the current node. */
+  size_t uHashValue;
+
+  assert(oSymTable != NULL);
+
+  if (oSymTable->psaOldNodeChains == NULL)
     return;
-  }
 
-  /* Iterate through all bindings by iterating through each of the 
-     original buckets, then iterating through each of those buckets' 
-     node chains. Rehash each of the nodes and place them into the new 
-     buckets array accordingly. */
-  for (i = 0; i < uCurrentBucketCount; i++) {
-    for (psCurrentNode = oSymTable->psaNodeChains[i]; 
+  uOldBucketCount = oSymTable->uBucketCount / 2;
+  uNewBucketCount = oSymTable->uBucketCount;
+
+  uStopIndex = uOldBucketCount;
+  if (uBucketCount != 0 &&
+      uOldBucketCount - oSymTable->uMigrateIndex > uBucketCount)
+    uStopIndex = oSymTable->uMigrateIndex + uBucketCount;
+
+  /* Move every node of each old bucket to the start of its bucket's
+     node chain in the current buckets array. Empty old buckets are
+     skipped. */
+  for (oSymTable->uMigrateIndex =
+         SymTable_nextOccupied(oSymTable->psaOldNodeChains,
+                               uOldBucketCount,
+                               oSymTable->uMigrateIndex, uStopIndex);
+       oSymTable->uMigrateIndex < uStopIndex;
+       oSymTable->uMigrateIndex =
+         SymTable_nextOccupied(oSymTable->psaOldNodeChains,
+                               uOldBucketCount,
+                               oSymTable->uMigrateIndex + 1,
+                               uStopIndex))
+  {
+    for (psCurrentNode =
+           oSymTable->psaOldNodeChains[oSymTable->uMigrateIndex];
          psCurrentNode != NULL; 
          psCurrentNode = psNextNode) 
     {
-      /* Update the next node to be rehashed.  */
       psNextNode = psCurrentNode->psNextNode;
 
-      /* Calculate the new hash value of the current node using the 
-         resized bucket count. */
-      uHashValue = SymTable_hash(psCurrentNode->pcKey, uNewBucketCount);
+      /* Calculate the new bucket of the current node from its stored
+         hash code using the resized bucket count. */
+      uHashValue = psCurrentNode->uHash & (uNewBucketCount - 1);
 
-      /* Insert the node into the new buckets array by placing it
-         at the start of its rehashed buckets' node chain. */
-      psCurrentNode->psNextNode = psNewBucketList[uHashValue];
-      psNewBucketList[uHashValue] = psCurrentNode;
+      SymTable_pushNode(oSymTable->psaNodeChains, uNewBucketCount,
+                        uHashValue, psCurrentNode);
     }
+    oSymTable->psaOldNodeChains[oSymTable->uMigrateIndex] = NULL;
+    SymTable_noteIfEmpty(oSymTable->psaOldNodeChains, uOldBucketCount,
+                         oSymTable->uMigrateIndex);
   }
 
-    /* Free the previous buckets array and update the SymTable's buckets
-       array to be the new one. */
-    free(oSymTable->psaNodeChains);
-    oSymTable->psaNodeChains = psNewBucketList;
-
-    /* Increment the bucket size of SymTable to be the next greatest 
-       size allowed. */
-    oSymTable->iBucketSizeIndex++;
-}
-
-
-SymTable_T SymTable_new(void) {
-  /* Reference to struct SymTable "manager" of given SymTable 
-     instance. */
-  SymTable_T oSymTable;
-
-  /* Allocate memory for SymTable "manager". */
-  oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
-
-  /* Check that memory allocation was successful. */
-  if (oSymTable == NULL) {
-    return NULL;
+  /* Once every old bucket has been moved, the resize is complete. */
+  if (oSymTable->uMigrateIndex == uOldBucketCount) {
+    free(oSymTable->psaOldNodeChains);
+    oSymTable->psaOldNodeChains = NULL;
   }
+}
 
-  /* Allocate memory for buckets array and initialize buckets count to 
-     be the smallest possible bucket count. */
-  oSymTable->psaNodeChains = calloc(sizeof(struct SymTableNode *), 
-                                    auBucketCounts[0]);
-
-  /* Check that memory allocation for buckets array was successful. If 
-     not, SymTable cannot be created either. */
-  if (oSymTable->psaNodeChains == NULL) {
-    free(oSymTable);
-    return NULL;
-  }
+/*--------------------------------------------------------------------*/
 
-  /* Initialize the length of the new, empty SymTable to be 0. */
-  oSymTable->uLength = 0;
+/* Starts resizing the hash table associated with the SymTable ADT
+   referenced by oSymTable if its number of bindings has reached its
+   number of buckets. The new buckets array, with twice as many buckets,
+   becomes current immediately and the old one is migrated
+   SYMTABLE_REHASH_STEP buckets at a time by later operations (or all at
+   once if SYMTABLE_REHASH_STEP is 0). If the new buckets array cannot
+   be allocated, no resize will occur until the next put. */
+static void SymTable_resizeIfNecessary(SymTable_T oSymTable) {
+  /* The resized buckets array. */
+  struct SymTableNode **psNewBucketList;
 
-  /* Initialize the current size of the bucket count to be the smallest
-  possible. */
-  oSymTable->iBucketSizeIndex = 0;
+  /* The current bucket count and new/expanded bucket count. */
+  size_t uCurrentBucketCount, uNewBucketCount;
 
-  return oSymTable;
-}
+  assert(oSymTable != NULL);
 
-/*--------------------------------------------------------------------*/
+  /* Determine the current bucket count. */
+  uCurrentBucketCount = oSymTable->uBucketCount;
 
-void SymTable_free(SymTable_T oSymTable) {
-  /* Reference to current node to free and to the next node to free. */
-  struct SymTableNode *psCurrentNode, *psNextNode;
+  /* Proceed with the resize iff the number of bindings has reached the
+     current number of buckets. Otherwise, stop the function call. */
+  if (SymTable_getLength(oSymTable) < uCurrentBucketCount)
+    return;
 
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+  /* Each operation migrates at least one bucket and the bindings must
+     double before the next resize, so the previous resize has normally
+     finished by now. Finish it regardless, since only two buckets
+     arrays can coexist. */
+  SymTable_migrate(oSymTable, 0);
 
-  /* Incrementor to iterate through each bucket to free each node 
-     chain. */
-  size_t i;
+  /* Determine the new bucket count by doubling the current one. */
+  uNewBucketCount = uCurrentBucketCount * 2;
 
-  assert(oSymTable != NULL);
+  /* Allocate memory for the new buckets array according to the new 
+     bucket count. */
+  psNewBucketList = SymTable_newChains(uNewBucketCount);
 
-  /* Get the index corresponding to bucket count. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  /* Check that memory was allocated successfully. */
+  if (psNewBucketList == NULL) {
+    return;
+  }
 
-  /* Iterate through each bucket to free each node chain. */
-  for(i = 0; i < auBucketCounts[iBucketSizeIndex]; i++) {
-    /* Iterate through the current bucket's node chain to free the 
-       chain. */
-    for (psCurrentNode = oSymTable->psaNodeChains[i];
-      psCurrentNode != NULL;
-      psCurrentNode = psNextNode)
-    {
-      /* Find the next node to free. */
-      psNextNode = psCurrentNode->psNextNode;
+  /* The current buckets array becomes the old one, to be migrated into
+     the new buckets array. */
+  oSymTable->psaOldNodeChains = oSymTable->psaNodeChains;
+  oSymTable->uMigrateIndex = 0;
+  oSymTable->psaNodeChains = psNewBucketList;
 
-      /* Free node's defensive key copy and node itself. */
-      free(psCurrentNode->pcKey);
-      free(psCurrentNode);
-    }
-  }
+  /* Record the doubled bucket count of SymTable. */
+  oSymTable->uBucketCount = uNewBucketCount;
+  oSymTable->uResizeCount++;
 
-  /* All nodes/bindings are freed, so free the buckets and free the 
-     "mananger" struct. */
-  free(oSymTable->psaNodeChains);
-  free(oSymTable);
+  /* A stop-the-world resize migrates every bucket right away. */
+  if (SYMTABLE_REHASH_STEP == 0)
+    SymTable_migrate(oSymTable, 0);
 }
 
 /*--------------------------------------------------------------------*/
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
-  assert(oSymTable != NULL);
+/* Return the smallest bucket count, a power of two that is at least
+   uInitialBucketCount, at which a SymTable holding uLength bindings
+   does not resize. */
+static size_t SymTable_bucketCountFor(size_t uLength) {
+  /* The candidate bucket count. */
+  size_t uBucketCount = uInitialBucketCount;
 
-  /* Return the uLength field tracked by the "manager" SymTable 
-     structure. */
-  return oSymTable->uLength;
+  /* Stop doubling before the count overflows; allocating that many
+     buckets fails anyway. */
+  while (uBucketCount <= uLength && uBucketCount <= (size_t)-1 / 4)
+    uBucketCount *= 2;
+
+  return uBucketCount;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
-  const void *pvValue) 
+/* Move every node of the SymTable ADT referenced by oSymTable into a
+   new buckets array of uBucketCount buckets at once, finishing any
+   resize in progress first. Return 1 if successful, or 0 if
+   insufficient memory is available, in which case the buckets are
+   unchanged. */
+static int SymTable_rebucket(SymTable_T oSymTable, size_t uBucketCount)
 {
-  /* The hash value corresponding to which bucket to add node to. */
-  size_t uHashValue;
+  /* The new buckets array. */
+  struct SymTableNode **psaNewNodeChains;
 
-  /* Defensive copy of the new binding's key. */
-  char *pcKeyCopy;
+  /* The bucket being emptied, or the index of the small node being
+     moved. */
+  size_t uBucket;
 
-  /* The node corresponding to the new binding. */
-  struct SymTableNode *psNewNode;
+  /* The current node being moved and the next node to be moved. */
+  struct SymTableNode *psCurrentNode, *psNextNode;
 
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+  /* The new bucket index of the current node. */
+  size_t uHashValue;
 
   assert(oSymTable != NULL);
-  assert(pcKey != NULL);
 
-  /* Check if a binding with the same key already exists in the 
-     SymTable. */
-  if (SymTable_contains(oSymTable, pcKey) == 1)
-    /* If a binding with the same key does exist, put fails and SymTable
-       is unchanged. */
+  psaNewNodeChains = SymTable_newChains(uBucketCount);
+  if (psaNewNodeChains == NULL)
     return 0;
 
-  /* Get the index corresponding to bucket count. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  SymTable_migrate(oSymTable, 0);
+
+  /* The nodes of a small table are hashed as they move. Other nodes
+     keep their hash codes, so moving them reads no keys. */
+  if (oSymTable->psaNodeChains == NULL)
+    for (uBucket = 0; uBucket < oSymTable->uLength; uBucket++) {
+      psCurrentNode = oSymTable->apsSmallNodes[uBucket];
+      psCurrentNode->uHash =
+        SymTable_hash(oSymTable, psCurrentNode->acKey);
+      uHashValue = psCurrentNode->uHash & (uBucketCount - 1);
+      SymTable_pushNode(psaNewNodeChains, uBucketCount, uHashValue,
+                        psCurrentNode);
+    }
 
-  /* Calculate which bucket to add node to. */
-  uHashValue = SymTable_hash(pcKey, auBucketCounts[iBucketSizeIndex]);
+  for (uBucket = 0;
+       oSymTable->psaNodeChains != NULL &&
+         (uBucket = SymTable_nextOccupied(oSymTable->psaNodeChains,
+                      oSymTable->uBucketCount, uBucket,
+                      oSymTable->uBucketCount))
+         < oSymTable->uBucketCount;
+       uBucket++) {
+    for (psCurrentNode = oSymTable->psaNodeChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psNextNode)
+    {
+      psNextNode = psCurrentNode->psNextNode;
+      uHashValue = psCurrentNode->uHash & (uBucketCount - 1);
+      SymTable_pushNode(psaNewNodeChains, uBucketCount, uHashValue,
+                        psCurrentNode);
+    }
+  }
 
-  /* Allocate memory for new node. */
-  psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode));
+  free(oSymTable->psaNodeChains);
+  oSymTable->psaNodeChains = psaNewNodeChains;
+  oSymTable->uBucketCount = uBucketCount;
+  oSymTable->uResizeCount++;
+  return 1;
+}
 
-  /* Check that memory allocation was successful. If not, cannot add 
-     node and put fails. */
-  if (psNewNode == NULL)
-    return 0;
+/*--------------------------------------------------------------------*/
 
-  /* Allocate memory for defensive key copy. */
-  pcKeyCopy = (char *) malloc(sizeof(char) * (strlen(pcKey) + 1)); 
+/* Shrink the buckets array of the SymTable ADT referenced by oSymTable
+   once its load falls below 1/8, down to a load of about 1/2. The gap
+   between the two loads means that a table whose size hovers around
+   a threshold does not shrink and grow over and over. If memory is
+   insufficient the table keeps its buckets. A table that has not
+   reserved any buckets becomes small again once it holds at most half
+   of SYMTABLE_SMALL_CAPACITY bindings, for the same reason. */
+static void SymTable_shrinkIfNecessary(SymTable_T oSymTable) {
+  /* The shrunken bucket count. */
+  size_t uBucketCount;
+
+  /* The bucket being emptied and the number of nodes moved so far. */
+  size_t uBucket, uMoved = 0;
+
+  /* The current node being moved. */
+  struct SymTableNode *psCurrentNode;
 
-  /* Check that memory allocation was successful. If not, then unable to
-     create node, so free the node from memory.*/
-  if (pcKeyCopy == NULL) {
-    free(psNewNode);
-    return 0;
-  }
+  assert(oSymTable != NULL);
 
-  /* Add new node to front of node chain in its bucket. */
-  psNewNode->psNextNode = oSymTable->psaNodeChains[uHashValue];
-  oSymTable->psaNodeChains[uHashValue] = psNewNode;
+  if (oSymTable->psaNodeChains == NULL)
+    return;
 
-  /* Add defensive key copy to new node. */
-  pcKeyCopy = strcpy(pcKeyCopy, pcKey);
-  psNewNode->pcKey = pcKeyCopy;
+  /* Demote the table by moving its nodes into the inline array, which
+     needs no memory. */
+  if (oSymTable->uMinBucketCount == 0 &&
+      oSymTable->uLength <= SYMTABLE_SMALL_CAPACITY / 2) {
+    SymTable_migrate(oSymTable, 0);
+    for (uBucket = SymTable_nextOccupied(oSymTable->psaNodeChains,
+                     oSymTable->uBucketCount, 0,
+                     oSymTable->uBucketCount);
+         uBucket < oSymTable->uBucketCount;
+         uBucket = SymTable_nextOccupied(oSymTable->psaNodeChains,
+                     oSymTable->uBucketCount, uBucket + 1,
+                     oSymTable->uBucketCount))
+      for (psCurrentNode = oSymTable->psaNodeChains[uBucket];
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+        oSymTable->apsSmallNodes[uMoved++] = psCurrentNode;
+    assert(uMoved == oSymTable->uLength);
 
-  /* Initialize its value accordingly. */
-  psNewNode->pvValue = (void *) pvValue;
+    free(oSymTable->psaNodeChains);
+    oSymTable->psaNodeChains = NULL;
+    oSymTable->uBucketCount = 0;
+    oSymTable->uResizeCount++;
+    return;
+  }
 
-  /* Update the total number of bindings in SymTable. */
-  oSymTable->uLength++;
+  if (oSymTable->uLength >= oSymTable->uBucketCount / 8)
+    return;
 
-  /* Resize the hash table accordingly. */
-  SymTable_resizeIfNecessary(oSymTable);
+  uBucketCount = SymTable_bucketCountFor(oSymTable->uLength * 2);
+  if (uBucketCount < oSymTable->uMinBucketCount)
+    uBucketCount = oSymTable->uMinBucketCount;
 
-  /* Put was successful. */
-  return 1;
+  /* The first buckets array is never shrunk, nor is a reserved one. */
+  if (uBucketCount >= oSymTable->uBucketCount)
+    return;
+
+  (void)SymTable_rebucket(oSymTable, uBucketCount);
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_replace(SymTable_T oSymTable,
-  const char *pcKey, const void *pvValue) 
+/* Return the address of the link (a bucket or some node's psNextNode
+   field) that refers to the node in oSymTable, which must not be small,
+   whose key is pcKey, where uHash is the full hash code of pcKey, or
+   NULL if no such node exists. Search both buckets arrays while a
+   resize is in progress. */
+static struct SymTableNode **SymTable_findLink(SymTable_T oSymTable,
+  const char *pcKey, size_t uHash)
 {
-  /* The hash value corresponding to which bucket to add node to. */
-  size_t uHashValue;
+  /* The link currently being examined. */
+  struct SymTableNode **ppsLink;
 
-  /* The node being compared to the target. */
+  /* The node referred to by the current link. */
   struct SymTableNode *psCurrentNode;
 
-  /* The previous value of the target binding before replacing. */
-  void *pvOldValue;
-
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
-
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
 
-  /* The bucket size is tracked in the SymTable "manager" struct. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  assert(oSymTable->psaNodeChains != NULL);
 
-  /* Calculate which bucket to search for target in. */
-  uHashValue = SymTable_hash(pcKey, auBucketCounts[iBucketSizeIndex]);
-  
   /* Iterate only through the one node chain which the target can be 
      found in. */
-  for (psCurrentNode = oSymTable->psaNodeChains[uHashValue];
-    psCurrentNode != NULL;
-    psCurrentNode = psCurrentNode->psNextNode)
+  for (ppsLink = &oSymTable->psaNodeChains[
+         uHash & (oSymTable->uBucketCount - 1)];
+       (psCurrentNode = *ppsLink) != NULL;
+       ppsLink = &psCurrentNode->psNextNode)
   {
-    /* Target hit success when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
-      /* Store the binding's previous value. */
-      pvOldValue = psCurrentNode->pvValue;
+    /* Target hit success when keys match. Nodes with a different hash
+       code cannot match, so their keys are never read. */
+    PROFILE_PROBE();
+    if (psCurrentNode->uHash == uHash &&
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0) 
+      return ppsLink;
+  }
 
-      /* Replace the binding's value. */
-      psCurrentNode->pvValue = (void*)pvValue;
+  /* The target may still be in its not-yet-migrated old bucket. */
+  if (oSymTable->psaOldNodeChains == NULL)
+    return NULL;
 
-      /* Return the previous value that was replaced. */
-      return pvOldValue;
-    }
+  for (ppsLink = &oSymTable->psaOldNodeChains[
+         uHash & (oSymTable->uBucketCount / 2 - 1)];
+       (psCurrentNode = *ppsLink) != NULL;
+       ppsLink = &psCurrentNode->psNextNode)
+  {
+    PROFILE_PROBE();
+    if (psCurrentNode->uHash == uHash &&
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0) 
+      return ppsLink;
   }
 
-  /* Target does not exist in SymTable, no value to replace. */
+  /* Target does not exist in SymTable. */
   return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-  /* The hash value corresponding to which bucket to add node to. */
-  size_t uHashValue;
-
-  /* The node being compared to the target. */
-  struct SymTableNode *psCurrentNode;
-
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+/* Return the address of the element of the inline array of the small
+   SymTable oSymTable that refers to the node whose key is pcKey, or
+   NULL if no such node exists. Like SymTablelist, a small table
+   compares keys without hashing them. */
+static struct SymTableNode **SymTable_findSmall(SymTable_T oSymTable,
+  const char *pcKey)
+{
+  /* The element currently being examined. */
+  struct SymTableNode **ppsLink;
 
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
-
-  /* The bucket size is tracked in the SymTable "manager" struct. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
-
-  /* Calculate which bucket to search for target in. */
-  uHashValue = SymTable_hash(pcKey, auBucketCounts[iBucketSizeIndex]);
-  
-  /* Iterate only through the one node chain which the target can be 
-     found in. */
-  for (psCurrentNode = oSymTable->psaNodeChains[uHashValue];
-    psCurrentNode != NULL;
-    psCurrentNode = psCurrentNode->psNextNode)
-  {
-    /* Target hit success when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0) 
-      /* Target hit success is TRUE (1). */
-      return 1;
+  assert(oSymTable->psaNodeChains == NULL);
+
+  for (ppsLink = oSymTable->apsSmallNodes;
+       ppsLink != oSymTable->apsSmallNodes + oSymTable->uLength;
+       ppsLink++) {
+    PROFILE_PROBE();
+    if ((*ppsLink)->acKey[0] == pcKey[0] &&
+        PROFILE_STRCMP((*ppsLink)->acKey, pcKey) == 0)
+      return ppsLink;
   }
 
-  /* Target hit fail, return FALSE (0). */
-  return 0;
+  return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-  /* The hash value corresponding to which bucket to add node to. */
-  size_t uHashValue;
-
-  /* The node being compared to the target. */
-  struct SymTableNode *psCurrentNode;
+/* Return the full hash code for pcKey under the seed of oSymTable.
+   puHashKey points to the token of pcKey from SymTable_hashKey, or is
+   NULL if pcKey has not been hashed yet. */
+static size_t SymTable_hashWith(SymTable_T oSymTable, const char *pcKey,
+  const size_t *puHashKey)
+{
+  if (puHashKey == NULL)
+    return SymTable_hash(oSymTable, pcKey);
+  return SymTable_seedHash(oSymTable, *puHashKey);
+}
 
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+/*--------------------------------------------------------------------*/
 
+/* Return the address of the link that refers to the node in oSymTable
+   whose key is pcKey, or NULL if no such node exists. puHashKey points
+   to the token of pcKey from SymTable_hashKey, or is NULL if pcKey has
+   not been hashed yet; it is hashed only if oSymTable is not small. */
+static struct SymTableNode **SymTable_find(SymTable_T oSymTable,
+  const char *pcKey, const size_t *puHashKey)
+{
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
 
-  /* The bucket size is tracked in the SymTable "manager" struct. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  if (oSymTable->psaNodeChains == NULL)
+    return SymTable_findSmall(oSymTable, pcKey);
+  return SymTable_findLink(oSymTable, pcKey,
+                           SymTable_hashWith(oSymTable, pcKey,
+                                             puHashKey));
+}
+
+/*--------------------------------------------------------------------*/
 
-  /* Calculate which bucket to search for target in. */
-  uHashValue = SymTable_hash(pcKey, auBucketCounts[iBucketSizeIndex]);
+/* Return the size in bytes of a node whose key has uKeyLength
+   characters. */
+static size_t SymTable_nodeSize(size_t uKeyLength) {
+  return offsetof(struct SymTableNode, acKey) + uKeyLength + 1;
+}
 
-  /* Iterate only through the one node chain which the target can be 
-     found in. */
-  for (psCurrentNode = oSymTable->psaNodeChains[uHashValue];
-    psCurrentNode != NULL;
-    psCurrentNode = psCurrentNode->psNextNode)
-  {
-    /* Target hit success when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0) 
-      /* Give the value of the target binding. */
-      return psCurrentNode->pvValue;
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oSymTable that follows psNode, or its first node
+   if psNode is NULL, or NULL if there is no such node. *puPosition is
+   the index of the bucket (or inline array element) of psNode, and is
+   set to that of the result. No resize may be in progress. */
+static struct SymTableNode *SymTable_nextNode(SymTable_T oSymTable,
+  struct SymTableNode *psNode, size_t *puPosition)
+{
+  assert(oSymTable != NULL);
+  assert(puPosition != NULL);
+  assert(oSymTable->psaOldNodeChains == NULL);
+
+  /* A small table's nodes are the elements of its inline array. */
+  if (oSymTable->psaNodeChains == NULL) {
+    *puPosition = psNode == NULL ? 0 : *puPosition + 1;
+    if (*puPosition < oSymTable->uLength)
+      return oSymTable->apsSmallNodes[*puPosition];
+    return NULL;
   }
 
-  /* Target does not exist in SymTable, nothing to return. */
+  /* Otherwise continue along the chain of psNode, then on to the next
+     nonempty bucket. */
+  if (psNode == NULL)
+    *puPosition = 0;
+  else if (psNode->psNextNode != NULL)
+    return psNode->psNextNode;
+  else
+    (*puPosition)++;
+
+  *puPosition = SymTable_nextOccupied(oSymTable->psaNodeChains,
+                                      oSymTable->uBucketCount,
+                                      *puPosition,
+                                      oSymTable->uBucketCount);
+  if (*puPosition < oSymTable->uBucketCount)
+    return oSymTable->psaNodeChains[*puPosition];
   return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-  /* The hash value corresponding to which bucket to add node to. */
-  size_t uHashValue;
+/* Return the node of oSymTable whose key is pcKey, first inserting a
+   new node with key pcKey and value pvValue if no such node exists, or
+   NULL if insufficient memory is available. puHashKey points to the
+   token of pcKey from SymTable_hashKey, or is NULL if pcKey has not
+   been hashed yet. Set *piInserted to 1 if a new node was inserted, or
+   to 0 otherwise. The bucket of pcKey is searched only once, and pcKey
+   is hashed at most once, and not at all while oSymTable is small. */
+static struct SymTableNode *SymTable_findOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const size_t *puHashKey, const void *pvValue,
+  int *piInserted)
+{
+  /* The link referring to an existing node with key pcKey. */
+  struct SymTableNode **ppsLink;
 
-  /* The node right before the current node being looked at. */
-  struct SymTableNode *psPreviousNode;
+  /* The full hash code of pcKey, or 0 while oSymTable is small. */
+  size_t uHash = 0;
 
-  /* The node being compared to the target. */
-  struct SymTableNode *psCurrentNode;
+  /* The hash value corresponding to which bucket to add node to. */
+  size_t uHashValue;
 
-  /* The value of the target binding before removing. */
-  void *pvReturnValue;
+  /* The length of the new binding's key. */
+  size_t uKeyLength;
 
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+  /* The node corresponding to the new binding. */
+  struct SymTableNode *psNewNode;
 
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
+  assert(piInserted != NULL);
 
-  /* The bucket size is tracked in the SymTable "manager" struct. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
 
-  /* Calculate which bucket to search for target in. */
-  uHashValue = SymTable_hash(pcKey, auBucketCounts[iBucketSizeIndex]);
+  *piInserted = 0;
 
-  /* Iterate through node chain until end of chain is reached or the
-     target node is found. Track the previous node accordingly. */
-  for (psCurrentNode = oSymTable->psaNodeChains[uHashValue], 
-       psPreviousNode = NULL; 
-       psCurrentNode != NULL && 
-       strcmp(psCurrentNode->pcKey, pcKey) != 0;
-       psPreviousNode = psCurrentNode, 
-       psCurrentNode = psCurrentNode->psNextNode);
-
-  /* If the end of the list was reached, there's nothing to remove. */
-  if (psCurrentNode == NULL) {
-    return NULL;
-  }
-  /* If the node before the target is NULL, then the target was at the 
-     start of the node chain. */
-  else if (psPreviousNode == NULL) {
-    /* Remove target node by replacing the first node in the node chain 
-       with the second node in chain. */
-    oSymTable->psaNodeChains[uHashValue] = psCurrentNode->psNextNode;
-  } 
-  /* The target node was in the middle of the chain. */
+  /* Check if a binding with the same key already exists in the 
+     SymTable. */
+  if (oSymTable->psaNodeChains == NULL)
+    ppsLink = SymTable_findSmall(oSymTable, pcKey);
   else {
-    /* Remove target node by connecting the node before the target node 
-       to the node after the target node. */
-    psPreviousNode->psNextNode = psCurrentNode->psNextNode;
+    uHash = SymTable_hashWith(oSymTable, pcKey, puHashKey);
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uHash);
+  }
+  if (ppsLink != NULL)
+    return *ppsLink;
+
+  /* A small table that is full is promoted: its nodes move into a
+     buckets array, and from then on every key is hashed. */
+  if (oSymTable->psaNodeChains == NULL &&
+      oSymTable->uLength == SYMTABLE_SMALL_CAPACITY) {
+    if (! SymTable_rebucket(oSymTable,
+          SymTable_bucketCountFor(SYMTABLE_SMALL_CAPACITY)))
+      return NULL;
+    uHash = SymTable_hashWith(oSymTable, pcKey, puHashKey);
   }
 
-  /* Update the return value to be the target binding's value. */
-  pvReturnValue = psCurrentNode->pvValue;
+  /* Allocate memory for new node, with room for the defensive key
+     copy. */
+  uKeyLength = strlen(pcKey);
+  psNewNode = (struct SymTableNode*)
+    Slab_alloc(&oSymTable->sSlab, SymTable_nodeSize(uKeyLength));
 
-  /* Free the target node's defnesive key copy, then free the target 
-     node itself. */
-  free(psCurrentNode->pcKey);
-  free(psCurrentNode);
+  /* Check that memory allocation was successful. If not, cannot add 
+     node. */
+  if (psNewNode == NULL)
+    return NULL;
 
-  /* Update the length of the linked list accordingly. */
-  oSymTable->uLength--;
+  /* Add defensive key copy to new node. */
+  memcpy(psNewNode->acKey, pcKey, uKeyLength + 1);
 
-  /* Return the value of the binding which was removed. */
-  return pvReturnValue;
-}
+  /* Initialize its hash code and value accordingly. */
+  psNewNode->uHash = uHash;
+  psNewNode->pvValue = (void *) pvValue;
 
-/*--------------------------------------------------------------------*/
+  *piInserted = 1;
 
-void SymTable_map(SymTable_T oSymTable,
-  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
-  const void *pvExtra)
-{
-  /* The current binding to apply pfApply to. */
-  struct SymTableNode *psCurrentNode;
+  /* A small table appends the new node to its inline array. */
+  if (oSymTable->psaNodeChains == NULL) {
+    psNewNode->psNextNode = NULL;
+    oSymTable->apsSmallNodes[oSymTable->uLength++] = psNewNode;
+    return psNewNode;
+  }
 
-  /* Record the current number of buckets in SymTable. */
-  size_t iBucketSizeIndex;
+  /* Otherwise calculate which bucket to add node to. New nodes always
+     go into the current buckets array. */
+  uHashValue = uHash & (oSymTable->uBucketCount - 1);
 
-  /* Incrementor to iterate over all buckets/node chains in SymTable. */
-  size_t i; 
+  /* Add new node to front of node chain in its bucket. */
+  SymTable_pushNode(oSymTable->psaNodeChains, oSymTable->uBucketCount,
+                    uHashValue, psNewNode);
 
-  assert(oSymTable != NULL);
-  assert(pfApply != NULL);
+  /* Update the total number of bindings in SymTable. */
+  oSymTable->uLength++;
 
-  /* The bucket size is tracked in the SymTable "manager" struct. */
-  iBucketSizeIndex = oSymTable->iBucketSizeIndex;
+  /* Resize the hash table accordingly. Nodes never move in memory, so
+     psNewNode stays valid. */
+  SymTable_resizeIfNecessary(oSymTable);
+
+  return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, with pvExtra, to every node in the uBucketCount node
+   chains of psaNodeChains. */
+static void SymTable_mapChains(struct SymTableNode **psaNodeChains,
+  size_t uBucketCount,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The current binding to apply pfApply to. */
+  struct SymTableNode *psCurrentNode;
+
+  /* Incrementor to iterate over all buckets/node chains. */
+  size_t i;
+
+  assert(psaNodeChains != NULL || uBucketCount == 0);
+  assert(pfApply != NULL);
 
   /* Iterate through each bucket and each node in each buckets' node 
      chain and apply pfApply to each node's key/value with pvExtra. */
-  for(i = 0; i < auBucketCounts[iBucketSizeIndex]; i++) {
-    for (psCurrentNode = oSymTable->psaNodeChains[i];
+  for(i = 0; i < uBucketCount; i++) {
+    for (psCurrentNode = psaNodeChains[i];
       psCurrentNode != NULL;
       psCurrentNode = psCurrentNode->psNextNode)
     {
       /* Apply pfApply to the current node. */
-      pfApply(psCurrentNode->pcKey, 
+      pfApply(psCurrentNode->acKey, 
               psCurrentNode->pvValue, 
               (void*)pvExtra);
     }
   }
-}
\ No newline at end of file
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, with pvExtra, to every node in the nonempty buckets
+   of psaNodeChains, a buckets array of uBucketCount buckets or NULL,
+   from uFirst up to but not including uEnd. */
+static void SymTable_mapOccupied(struct SymTableNode **psaNodeChains,
+  size_t uBucketCount, size_t uFirst, size_t uEnd,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The nonempty bucket being walked. */
+  size_t uBucket;
+
+  assert(uFirst <= uEnd && uEnd <= uBucketCount);
+  assert(pfApply != NULL);
+
+  if (psaNodeChains == NULL)
+    return;
+
+  for (uBucket = SymTable_nextOccupied(psaNodeChains, uBucketCount,
+                                       uFirst, uEnd);
+       uBucket < uEnd;
+       uBucket = SymTable_nextOccupied(psaNodeChains, uBucketCount,
+                                       uBucket + 1, uEnd))
+    SymTable_mapChains(psaNodeChains + uBucket, 1, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void) {
+  return SymTable_newWithCapacity(0);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* Reference to struct SymTable "manager" of given SymTable 
+     instance. */
+  SymTable_T oSymTable;
+
+  /* Allocate memory for SymTable "manager". */
+  oSymTable = (SymTable_T) malloc(sizeof(struct SymTable));
+
+  /* Check that memory allocation was successful. */
+  if (oSymTable == NULL) {
+    return NULL;
+  }
+
+  /* A table for few bindings starts small, with no buckets array. */
+  if (uCapacity <= SYMTABLE_SMALL_CAPACITY) {
+    oSymTable->psaNodeChains = NULL;
+    oSymTable->uBucketCount = 0;
+  }
+
+  /* Otherwise allocate memory for buckets array and initialize buckets
+     count to be the smallest bucket count that holds uCapacity
+     bindings. */
+  else {
+    oSymTable->uBucketCount = SymTable_bucketCountFor(uCapacity);
+    oSymTable->psaNodeChains =
+      SymTable_newChains(oSymTable->uBucketCount);
+
+    /* Check that memory allocation for buckets array was successful. If
+       not, SymTable cannot be created either. */
+    if (oSymTable->psaNodeChains == NULL) {
+      free(oSymTable);
+      return NULL;
+    }
+  }
+
+  /* Initialize the length of the new, empty SymTable to be 0. */
+  oSymTable->uLength = 0;
+  oSymTable->uResizeCount = 0;
+
+  /* No resize is in progress. */
+  oSymTable->psaOldNodeChains = NULL;
+  oSymTable->uMigrateIndex = 0;
+
+  /* Removals never shrink the table below its initial size. */
+  oSymTable->uMinBucketCount = oSymTable->uBucketCount;
+
+  /* Choose this table's hash seed. This also draws the process seed,
+     if it has not been drawn yet. */
+  oSymTable->uSeed = StrHash_newSeed(oSymTable);
+
+  PROFILE_INIT(&oSymTable->sProfile);
+
+  /* The table owns no nodes yet. */
+  Slab_init(&oSymTable->sSlab);
+
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  /* Free all nodes, with their key copies, chunk by chunk rather than
+     walking every node chain. */
+  Slab_clear(&oSymTable->sSlab);
+
+  /* Free the old buckets array of a resize in progress. */
+  free(oSymTable->psaOldNodeChains);
+
+  /* All nodes/bindings are freed, so free the buckets and free the 
+     "mananger" struct. */
+  free(oSymTable->psaNodeChains);
+  free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  /* Return the uLength field tracked by the "manager" SymTable 
+     structure. */
+  return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count a chain of uChainLength bindings in *psStats. */
+static void SymTable_countChain(struct SymTableStats *psStats,
+                                size_t uChainLength)
+{
+  assert(psStats != NULL);
+
+  if (uChainLength > psStats->uLongestChain)
+    psStats->uLongestChain = uChainLength;
+  psStats->auChainCounts[uChainLength < SYMTABLE_STATS_CHAINS ?
+                         uChainLength : SYMTABLE_STATS_CHAINS - 1]++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the buckets, chains and keys of psaNodeChains, a buckets array
+   of uBucketCount buckets, to *psStats. */
+static void SymTable_addChains(struct SymTableStats *psStats,
+  struct SymTableNode **psaNodeChains, size_t uBucketCount)
+{
+  /* The nonempty bucket being counted, and the number of them. */
+  size_t uBucket, uOccupied = 0;
+
+  /* The node being counted, and the length of its chain so far. */
+  struct SymTableNode *psCurrentNode;
+  size_t uChainLength;
+
+  assert(psStats != NULL);
+  assert(psaNodeChains != NULL);
+
+  for (uBucket = SymTable_nextOccupied(psaNodeChains, uBucketCount, 0,
+                                       uBucketCount);
+       uBucket < uBucketCount;
+       uBucket = SymTable_nextOccupied(psaNodeChains, uBucketCount,
+                                       uBucket + 1, uBucketCount))
+  {
+    uChainLength = 0;
+    for (psCurrentNode = psaNodeChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psCurrentNode->psNextNode)
+    {
+      psStats->uKeyBytes += strlen(psCurrentNode->acKey) + 1;
+      uChainLength++;
+    }
+    SymTable_countChain(psStats, uChainLength);
+    uOccupied++;
+  }
+
+  /* The empty buckets are counted from the bitmap, unread. */
+  psStats->auChainCounts[0] += uBucketCount - uOccupied;
+  psStats->uBucketCount += uBucketCount;
+  psStats->uBucketBytes += uBucketCount * sizeof(struct SymTableNode *)
+                           + SymTable_bitmapSize(uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  /* Incrementor over the nodes of a small table. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
+
+  memset(psStats, 0, sizeof(struct SymTableStats));
+  psStats->uLength = oSymTable->uLength;
+  psStats->uResizeCount = oSymTable->uResizeCount;
+  psStats->uNodeBytes =
+    oSymTable->uLength * offsetof(struct SymTableNode, acKey);
+
+  /* The inline array of a small table is scanned as one chain. */
+  if (oSymTable->psaNodeChains == NULL) {
+    for (u = 0; u < oSymTable->uLength; u++)
+      psStats->uKeyBytes += strlen(oSymTable->apsSmallNodes[u]->acKey)
+                            + 1;
+    psStats->uBucketCount = 1;
+    SymTable_countChain(psStats, oSymTable->uLength);
+  }
+
+  /* During a resize, lookups search both buckets arrays. */
+  else {
+    SymTable_addChains(psStats, oSymTable->psaNodeChains,
+                       oSymTable->uBucketCount);
+    if (oSymTable->psaOldNodeChains != NULL)
+      SymTable_addChains(psStats, oSymTable->psaOldNodeChains,
+                         oSymTable->uBucketCount / 2);
+  }
+
+  psStats->dLoadFactor =
+    (double)psStats->uLength / (double)psStats->uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
+  assert(oSymTable != NULL);
+  assert(psFile != NULL);
+
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  /* The bucket count that holds uCapacity bindings. */
+  size_t uBucketCount;
+
+  assert(oSymTable != NULL);
+
+  /* A small table may stay small. */
+  if (oSymTable->psaNodeChains == NULL &&
+      uCapacity <= SYMTABLE_SMALL_CAPACITY)
+    return 1;
+
+  /* Removals must not shrink the table below the reserved size. */
+  uBucketCount = SymTable_bucketCountFor(uCapacity);
+  if (uBucketCount > oSymTable->uMinBucketCount)
+    oSymTable->uMinBucketCount = uBucketCount;
+
+  /* A table that already has enough buckets is never shrunk. */
+  if (uBucketCount <= oSymTable->uBucketCount)
+    return 1;
+
+  /* Jump straight to the final bucket count, moving each node once. */
+  return SymTable_rebucket(oSymTable, uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
+  const void *pvValue) 
+{
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  /* The node with key pcKey, found or inserted. */
+  struct SymTableNode *psNode;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, NULL, pvValue,
+                                 &iInserted);
+  PROFILE_END(&oSymTable->sProfile, psNode != NULL && ! iInserted);
+
+  /* If a binding with the same key does exist, put fails and SymTable
+     is unchanged. Put also fails if memory for the new node is 
+     insufficient. */
+  return psNode != NULL && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue) 
+{
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The previous value of the target binding before replacing. */
+  void *pvOldValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REPLACE);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  ppsLink = SymTable_find(oSymTable, pcKey, NULL);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  /* Target does not exist in SymTable, no value to replace. */
+  if (ppsLink == NULL)
+    return NULL;
+
+  /* Store the binding's previous value, then replace it. */
+  pvOldValue = (*ppsLink)->pvValue;
+  (*ppsLink)->pvValue = (void*)pvValue;
+
+  /* Return the previous value that was replaced. */
+  return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  /* Target hit success is TRUE (1), target hit fail is FALSE (0). */
+  return SymTable_find(oSymTable, pcKey, NULL) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  ppsLink = SymTable_find(oSymTable, pcKey, NULL);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  /* Target does not exist in SymTable, nothing to return. */
+  if (ppsLink == NULL)
+    return NULL;
+
+  /* Give the value of the target binding. */
+  return (*ppsLink)->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* The full hash codes of the current group's keys. */
+  size_t auHash[BATCH_GROUP];
+
+  /* The first node of a chain. */
+  struct SymTableNode *psFirstNode;
+
+  /* The index of the first key of the current group, the number of
+     keys in it, and an incrementor over them. */
+  size_t uFirst, uGroupSize, u;
+
+  /* The masks that reduce a hash code to a bucket index in the current
+     and old buckets arrays. */
+  size_t uMask, uOldMask;
+
+  /* The link referring to a target node. */
+  struct SymTableNode **ppsLink;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  /* Advance any resize in progress, once for the whole batch. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  /* The nodes of a small table all share a few cache lines, so there
+     is no latency to overlap. */
+  if (oSymTable->psaNodeChains == NULL) {
+    for (u = 0; u < uCount; u++) {
+      ppsLink = SymTable_findSmall(oSymTable, apcKeys[u]);
+      apvOut[u] = ppsLink == NULL ? NULL : (*ppsLink)->pvValue;
+    }
+    return;
+  }
+
+  uMask = oSymTable->uBucketCount - 1;
+  uOldMask = oSymTable->uBucketCount / 2 - 1;
+
+  for (uFirst = 0; uFirst < uCount; uFirst += uGroupSize) {
+    uGroupSize = uCount - uFirst;
+    if (uGroupSize > BATCH_GROUP)
+      uGroupSize = BATCH_GROUP;
+
+    /* Hash every key and prefetch its buckets. */
+    for (u = 0; u < uGroupSize; u++) {
+      assert(apcKeys[uFirst + u] != NULL);
+      auHash[u] = SymTable_hash(oSymTable, apcKeys[uFirst + u]);
+      SYMTABLE_PREFETCH(&oSymTable->psaNodeChains[auHash[u] & uMask]);
+      if (oSymTable->psaOldNodeChains != NULL)
+        SYMTABLE_PREFETCH(
+          &oSymTable->psaOldNodeChains[auHash[u] & uOldMask]);
+    }
+
+    /* Read every bucket and prefetch the first node of its chain. */
+    for (u = 0; u < uGroupSize; u++) {
+      psFirstNode = oSymTable->psaNodeChains[auHash[u] & uMask];
+      if (psFirstNode != NULL)
+        SYMTABLE_PREFETCH(psFirstNode);
+    }
+
+    /* Walk the chains, whose first nodes should now be cached. */
+    for (u = 0; u < uGroupSize; u++) {
+      ppsLink = SymTable_findLink(oSymTable, apcKeys[uFirst + u],
+                                  auHash[u]);
+      apvOut[uFirst + u] = ppsLink == NULL ? NULL : (*ppsLink)->pvValue;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The node being removed. */
+  struct SymTableNode *psCurrentNode;
+
+  /* The value of the target binding before removing. */
+  void *pvReturnValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REMOVE);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  ppsLink = SymTable_find(oSymTable, pcKey, NULL);
+
+  /* If the target was not found, there's nothing to remove. */
+  if (ppsLink == NULL) {
+    PROFILE_END(&oSymTable->sProfile, 0);
+    return NULL;
+  }
+
+  /* Remove target node by pointing the link that referred to it (the
+     bucket or the previous node) at the node after it. A small table
+     fills the hole with its last node instead. */
+  psCurrentNode = *ppsLink;
+  if (oSymTable->psaNodeChains == NULL)
+    *ppsLink = oSymTable->apsSmallNodes[oSymTable->uLength - 1];
+  else {
+    *ppsLink = psCurrentNode->psNextNode;
+
+    /* The node's bucket, in whichever buckets array held it, may now
+       be empty. */
+    SymTable_noteIfEmpty(oSymTable->psaNodeChains,
+      oSymTable->uBucketCount,
+      psCurrentNode->uHash & (oSymTable->uBucketCount - 1));
+    if (oSymTable->psaOldNodeChains != NULL)
+      SymTable_noteIfEmpty(oSymTable->psaOldNodeChains,
+        oSymTable->uBucketCount / 2,
+        psCurrentNode->uHash & (oSymTable->uBucketCount / 2 - 1));
+  }
+
+  /* Update the return value to be the target binding's value. */
+  pvReturnValue = psCurrentNode->pvValue;
+
+  /* Return the target node, with its defensive key copy, to the
+     slab. */
+  Slab_release(&oSymTable->sSlab, psCurrentNode,
+               SymTable_nodeSize(strlen(psCurrentNode->acKey)));
+
+  /* Update the length of the linked list accordingly. */
+  oSymTable->uLength--;
+
+  /* Give memory back after mass removals. */
+  SymTable_shrinkIfNecessary(oSymTable);
+
+  PROFILE_END(&oSymTable->sProfile, 1);
+
+  /* Return the value of the binding which was removed. */
+  return pvReturnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, NULL, pvValue,
+                                 &iInserted);
+  if (psNode == NULL)
+    return NULL;
+
+  /* Give the address of the binding's value. */
+  return &psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, NULL, pvValue,
+                                 &iInserted);
+  if (psNode == NULL)
+    return 0;
+
+  /* An existing binding's value is combined with pvValue. */
+  if (! iInserted)
+    psNode->pvValue = pfCombine(psNode->acKey, psNode->pvValue,
+                                (void *)pvValue, (void *)pvExtra);
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  return StrHash_hash(pcKey, StrHash_processSeed());
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  /* The node with key pcKey, found or inserted. */
+  struct SymTableNode *psNode;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, &uHashKey, pvValue,
+                                 &iInserted);
+  PROFILE_END(&oSymTable->sProfile, psNode != NULL && ! iInserted);
+
+  /* If a binding with the same key does exist, put fails and SymTable
+     is unchanged. Put also fails if memory for the new node is 
+     insufficient. */
+  return psNode != NULL && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  /* Target hit success is TRUE (1), target hit fail is FALSE (0). */
+  return SymTable_find(oSymTable, pcKey, &uHashKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+
+  /* Advance any resize in progress. */
+  SymTable_migrate(oSymTable, SYMTABLE_REHASH_STEP);
+
+  ppsLink = SymTable_find(oSymTable, pcKey, &uHashKey);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  /* Target does not exist in SymTable, nothing to return. */
+  if (ppsLink == NULL)
+    return NULL;
+
+  /* Give the value of the target binding. */
+  return (*ppsLink)->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The smallest bucket count that holds the bindings, and the buckets
+     array of that size, or NULL if the table becomes small. */
+  size_t uBucketCount;
+  struct SymTableNode **psaNewNodeChains = NULL;
+
+  /* The inline array of the table if it becomes small. */
+  struct SymTableNode *apsNewSmallNodes[SYMTABLE_SMALL_CAPACITY];
+
+  /* The allocator of the copied nodes. */
+  struct Slab sNewSlab;
+
+  /* The node being copied and its copy, and the position of the node
+     being copied. */
+  struct SymTableNode *psCurrentNode, *psNewNode;
+  size_t uPosition;
+
+  /* The size of the node being copied, and the number copied. */
+  size_t uNodeSize, uCopied = 0;
+
+  /* The new bucket index of the copy. */
+  size_t uHashValue;
+
+  assert(oSymTable != NULL);
+
+  SymTable_migrate(oSymTable, 0);
+
+  /* A table with few enough bindings becomes small again. */
+  uBucketCount = 0;
+  if (oSymTable->uLength > SYMTABLE_SMALL_CAPACITY) {
+    uBucketCount = SymTable_bucketCountFor(oSymTable->uLength);
+    psaNewNodeChains = SymTable_newChains(uBucketCount);
+    if (psaNewNodeChains == NULL)
+      return 0;
+  }
+
+  /* Copy every node into a fresh slab, so the chunks that removals
+     left mostly empty are freed along with the old slab. */
+  Slab_init(&sNewSlab);
+  for (psCurrentNode = SymTable_nextNode(oSymTable, NULL, &uPosition);
+       psCurrentNode != NULL;
+       psCurrentNode = SymTable_nextNode(oSymTable, psCurrentNode,
+                                         &uPosition))
+  {
+    uNodeSize = SymTable_nodeSize(strlen(psCurrentNode->acKey));
+    psNewNode = (struct SymTableNode *)Slab_alloc(&sNewSlab, uNodeSize);
+
+    /* Leave the table as it was if the copy cannot be finished. */
+    if (psNewNode == NULL) {
+      Slab_clear(&sNewSlab);
+      free(psaNewNodeChains);
+      return 0;
+    }
+
+    memcpy(psNewNode, psCurrentNode, uNodeSize);
+    if (psaNewNodeChains == NULL) {
+      psNewNode->psNextNode = NULL;
+      apsNewSmallNodes[uCopied++] = psNewNode;
+    }
+    else {
+      uHashValue = psNewNode->uHash & (uBucketCount - 1);
+      SymTable_pushNode(psaNewNodeChains, uBucketCount, uHashValue,
+                        psNewNode);
+    }
+  }
+
+  Slab_clear(&oSymTable->sSlab);
+  oSymTable->sSlab = sNewSlab;
+
+  free(oSymTable->psaNodeChains);
+  oSymTable->psaNodeChains = psaNewNodeChains;
+  if (uBucketCount != oSymTable->uBucketCount)
+    oSymTable->uResizeCount++;
+  oSymTable->uBucketCount = uBucketCount;
+  if (psaNewNodeChains == NULL)
+    memcpy(oSymTable->apsSmallNodes, apsNewSmallNodes,
+           uCopied * sizeof(struct SymTableNode *));
+
+  /* The table is now only as large as it must be. */
+  oSymTable->uMinBucketCount = 0;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* Incrementor over the nodes of a small table. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  /* Apply pfApply to the nodes of a small table. */
+  if (oSymTable->psaNodeChains == NULL)
+    for (u = 0; u < oSymTable->uLength; u++)
+      pfApply(oSymTable->apsSmallNodes[u]->acKey,
+              oSymTable->apsSmallNodes[u]->pvValue, (void *)pvExtra);
+
+  /* Lookups migrate buckets, and pfApply may look up oSymTable, which
+     would move nodes into buckets already walked. Finish any resize in
+     progress first, so that there is nothing left to migrate. */
+  SymTable_migrate(oSymTable, 0);
+
+  /* Apply pfApply to the nonempty node chains. */
+  SymTable_mapOccupied(oSymTable->psaNodeChains,
+                       oSymTable->uBucketCount,
+                       0, oSymTable->uBucketCount,
+                       pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks. */
+
+struct SymTableMapping {
+  /* The table being walked. */
+  SymTable_T oSymTable;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+
+  /* The number of tasks that walk psaNodeChains. The rest walk
+     psaOldNodeChains. */
+  size_t uNewTaskCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the chains of the MAP_CHUNK buckets of task uTask, passing the
+   pvExtra of worker uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+
+  /* The buckets array walked, and its number of buckets. */
+  struct SymTableNode **psaNodeChains;
+  size_t uBucketCount;
+
+  assert(psMapping != NULL);
+
+  if (uTask < psMapping->uNewTaskCount) {
+    psaNodeChains = psMapping->oSymTable->psaNodeChains;
+    uBucketCount = psMapping->oSymTable->uBucketCount;
+  }
+  else {
+    uTask -= psMapping->uNewTaskCount;
+    psaNodeChains = psMapping->oSymTable->psaOldNodeChains;
+    uBucketCount = psMapping->oSymTable->uBucketCount / 2;
+  }
+
+  SymTable_mapOccupied(psaNodeChains, uBucketCount,
+                       uTask * MAP_CHUNK,
+                       uBucketCount - uTask * MAP_CHUNK > MAP_CHUNK ?
+                         (uTask + 1) * MAP_CHUNK : uBucketCount,
+                       psMapping->pfApply,
+                       psMapping->apvExtras == NULL ?
+                         NULL : psMapping->apvExtras[uWorker]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks. */
+  struct SymTableMapping sMapping;
+
+  /* The number of tasks that walk psaOldNodeChains. */
+  size_t uOldTaskCount = 0;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  /* A small table is too small to share out. */
+  if (oSymTable->psaNodeChains == NULL) {
+    SymTable_map(oSymTable, pfApply,
+                 apvExtras == NULL ? NULL : apvExtras[0]);
+    return;
+  }
+
+  /* Walk both buckets arrays of a resize in progress rather than
+     finish it, so that the table is only read. */
+  sMapping.oSymTable = oSymTable;
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  sMapping.uNewTaskCount =
+    (oSymTable->uBucketCount + MAP_CHUNK - 1) / MAP_CHUNK;
+  if (oSymTable->psaOldNodeChains != NULL)
+    uOldTaskCount =
+      (oSymTable->uBucketCount / 2 + MAP_CHUNK - 1) / MAP_CHUNK;
+
+  WorkPool_run(sMapping.uNewTaskCount + uOldTaskCount, uThreadCount,
+               SymTable_mapTask, &sMapping);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator walks the small nodes, or the buckets of psaNodeChains.
+   SymTable_iterBegin finishes any resize in progress, and the table
+   does not change while the iterator is open, so lookups between its
+   calls have nothing to migrate and the buckets array stays put. */
+
+struct SymTableIter {
+  /* The table walked. */
+  SymTable_T oSymTable;
+
+  /* The buckets array being walked, and its number of buckets. */
+  struct SymTableNode **psaNodeChains;
+  size_t uBucketCount;
+
+  /* The next bucket to walk, or the next small node. */
+  size_t uNext;
+
+  /* The next node of the current chain, or NULL at its end. */
+  struct SymTableNode *psNextNode;
+
+  /* The number of bindings not visited yet, so that the walk stops at
+     the last binding rather than at the last bucket. */
+  size_t uLeft;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+
+  /* Lookups migrate buckets, and a lookup between calls of
+     SymTable_iterNext would move nodes past the walk. */
+  SymTable_migrate(oSymTable, 0);
+
+  oIter->oSymTable = oSymTable;
+  oIter->psaNodeChains = oSymTable->psaNodeChains;
+  oIter->uBucketCount = oSymTable->uBucketCount;
+  oIter->uNext = 0;
+  oIter->psNextNode = NULL;
+  oIter->uLeft = oSymTable->uLength;
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The table walked. */
+  SymTable_T oSymTable;
+
+  /* The node visited. */
+  struct SymTableNode *psNode;
+
+  assert(oIter != NULL);
+
+  if (oIter->uLeft == 0)
+    return 0;
+
+  oSymTable = oIter->oSymTable;
+  if (oIter->psaNodeChains == NULL)
+    psNode = oSymTable->apsSmallNodes[oIter->uNext++];
+  else {
+    /* A binding is left, so a chain is found before the end of the
+       buckets array. */
+    assert(oIter->psaNodeChains == oSymTable->psaNodeChains);
+    while (oIter->psNextNode == NULL) {
+      oIter->uNext = SymTable_nextOccupied(oIter->psaNodeChains,
+                                           oIter->uBucketCount,
+                                           oIter->uNext,
+                                           oIter->uBucketCount);
+      assert(oIter->uNext < oIter->uBucketCount);
+      oIter->psNextNode = oIter->psaNodeChains[oIter->uNext++];
+    }
+    psNode = oIter->psNextNode;
+    oIter->psNextNode = psNode->psNextNode;
+  }
+  oIter->uLeft--;
+
+  if (ppcKey != NULL)
+    *ppcKey = psNode->acKey;
+  if (ppvValue != NULL)
+    *ppvValue = psNode->pvValue;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the cursor that follows uCursor in a scan of the buckets
+   whose indices are masked by uMask, one less than a power of two, or
+   0 after the last bucket. Cursors count in reverse binary, carrying
+   from the highest bit of uMask down, so the buckets that a bucket
+   splits into when the bucket count doubles, or merges with when it
+   halves, come next to one another in the order of the scan. */
+static size_t SymTable_nextCursor(size_t uCursor, size_t uMask) {
+  /* The bit being incremented. */
+  size_t uBit = uMask - (uMask >> 1);
+
+  uCursor &= uMask;
+  while ((uCursor & uBit) != 0) {
+    uCursor &= ~uBit;
+    uBit >>= 1;
+  }
+  return uCursor | uBit;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The mask of the bucket indices of psaOldNodeChains, or of
+     psaNodeChains if no resize is in progress. */
+  size_t uMask;
+
+  /* The bucket visited, in the smaller buckets array. */
+  size_t uBucket;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* A small table is scanned whole, as one bucket. */
+  if (oSymTable->psaNodeChains == NULL) {
+    SymTable_map(oSymTable, pfApply, pvExtra);
+    return 0;
+  }
+
+  do {
+    if (oSymTable->psaOldNodeChains == NULL) {
+      uMask = oSymTable->uBucketCount - 1;
+      uBucket = uCursor & uMask;
+      SymTable_mapChains(oSymTable->psaNodeChains + uBucket, 1,
+                         pfApply, pvExtra);
+    }
+    else {
+      /* During a resize, the old bucket and the two new buckets that
+         it splits into hold every key of the old bucket's index. */
+      uMask = oSymTable->uBucketCount / 2 - 1;
+      uBucket = uCursor & uMask;
+      SymTable_mapChains(oSymTable->psaOldNodeChains + uBucket, 1,
+                         pfApply, pvExtra);
+      SymTable_mapChains(oSymTable->psaNodeChains + uBucket, 1,
+                         pfApply, pvExtra);
+      SymTable_mapChains(oSymTable->psaNodeChains + uBucket + uMask + 1,
+                         1, pfApply, pvExtra);
+    }
+    uCursor = SymTable_nextCursor(uBucket, uMask);
+  } while (--uBudget > 0 && uCursor != 0);
+
+  return uCursor;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings with the prefix. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  /* Hashing scatters the keys over the buckets, so the bindings
+     are gathered and sorted by key. */
+  KeyOrder_init(&sOrder, NULL, NULL, pcPrefix);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings in the range. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  KeyOrder_init(&sOrder, pcLow, pcHigh, NULL);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
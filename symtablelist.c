@@ -8,27 +8,43 @@
 #include <assert.h>
 #include <string.h>
 #include "symtable.h"
+#include "slab.h"
+#include "workpool.h"
+#include "keyorder.h"
+#include "profile.h"
+
+/*--------------------------------------------------------------------*/
+
+/* The number of nodes that each task of SymTable_mapParallel
+   visits. */
+enum {MAP_CHUNK = 256};
 
 /*--------------------------------------------------------------------*/
 
 /* Each item stored in a SymTable. SymTableNodes are linked to form a 
-   list. */
+   list. Each node is a single block that ends with the defensive copy
+   of its key. */
 
 struct SymTableNode {
-  /* The string key. */
-  char *pcKey; 
-
   /* The generic value. */
   void *pvValue; 
 
   /* A reference to the next node in the list. */
   struct SymTableNode *psNextNode; 
+
+  /* The number of the node, counting from 1 in the order of insertion,
+     so that the list is in decreasing order of serials. */
+  size_t uSerial;
+
+  /* The string key, stored inline. */
+  char acKey[];
 };
 
 /*--------------------------------------------------------------------*/
 
 /* A SymTable structure is a "manager" structure which tracks the first
-   SymTableNode in the linked list and the length of the list. */
+   SymTableNode in the linked list and the length of the list; it owns
+   the slab from which all of its nodes are allocated. */
 
 struct SymTable {
   /* A reference to the first node in the list. */
@@ -36,10 +52,89 @@ struct SymTable {
 
   /* Length of the list. */
   size_t uLength; 
+
+  /* The serial of the next node inserted. */
+  size_t uNextSerial;
+
+  /* The allocator of this table's nodes. */
+  struct Slab sSlab;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table; see profile.h. */
+  struct Profile sProfile;
+#endif
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Return the size in bytes of a node whose key has uKeyLength
+   characters. */
+static size_t SymTable_nodeSize(size_t uKeyLength) {
+  return offsetof(struct SymTableNode, acKey) + uKeyLength + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oSymTable whose key is pcKey, first inserting a
+   new node with key pcKey and value pvValue at the start of the list
+   if no such node exists, or NULL if insufficient memory is available.
+   Set *piInserted to 1 if a new node was inserted, or to 0 otherwise. 
+   The list is walked only once. */
+static struct SymTableNode *SymTable_findOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue, int *piInserted)
+{
+  /* Current node being compared to target, then the new node. */
+  struct SymTableNode *psCurrentNode;
+
+  /* The length of the new node's key. */
+  size_t uKeyLength;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(piInserted != NULL);
+
+  *piInserted = 0;
+
+  /* Iterate through linked list and stop if target is found. */
+  for (psCurrentNode = oSymTable->psFirstNode;
+    psCurrentNode != NULL;
+    psCurrentNode = psCurrentNode->psNextNode)
+  {
+    PROFILE_PROBE();
+    if (PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0)
+      return psCurrentNode;
+  }
+
+  /* Allocate memory for new node, with room for the defensive key
+     copy, but store/pass by reference. */
+  uKeyLength = strlen(pcKey);
+  psCurrentNode = (struct SymTableNode*)
+    Slab_alloc(&oSymTable->sSlab, SymTable_nodeSize(uKeyLength));
+
+  /* Check that memory allocation for new node was successful. If not,
+     there's nothing to insert. */
+  if (psCurrentNode == NULL) 
+    return NULL;
+
+  /* Make the defensive copy of key and initialize key/value of new
+     node. */
+  memcpy(psCurrentNode->acKey, pcKey, uKeyLength + 1);
+  psCurrentNode->pvValue = (void *) pvValue;
+  psCurrentNode->uSerial = oSymTable->uNextSerial++;
+
+  /* Insert new node at the start of the linked list. */
+  psCurrentNode->psNextNode = oSymTable->psFirstNode;
+  oSymTable->psFirstNode = psCurrentNode;
+
+  /* Update the size of the SymTable. */
+  oSymTable->uLength++;
+
+  *piInserted = 1;
+  return psCurrentNode;
+}
+
+/*--------------------------------------------------------------------*/
+
 SymTable_T SymTable_new(void) {
   /* Allocate memory for SymTable struct, but store/pass a 
      reference to it, not a copy. */
@@ -53,35 +148,29 @@ SymTable_T SymTable_new(void) {
   /* Initialize values of the new, empty SymTable. */
   oSymTable->psFirstNode = NULL;
   oSymTable->uLength = 0;
+  oSymTable->uNextSerial = 1;
+  Slab_init(&oSymTable->sSlab);
+  PROFILE_INIT(&oSymTable->sProfile);
 
   return oSymTable;
 }
 
 /*--------------------------------------------------------------------*/
 
-void SymTable_free(SymTable_T oSymTable) {
-  /* Reference to current node to free. */
-  struct SymTableNode *psCurrentNode; 
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* A list has no buckets to size in advance. */
+  (void)uCapacity;
+  return SymTable_new();
+}
 
-  /* Reference to the next node to free. */
-  struct SymTableNode *psNextNode;
+/*--------------------------------------------------------------------*/
 
+void SymTable_free(SymTable_T oSymTable) {
   assert(oSymTable != NULL);
 
-  /* Iterate through linked list and free all nodes and their 
-     defensive key copies. */
-  for (psCurrentNode = oSymTable->psFirstNode;
-    psCurrentNode != NULL;
-    psCurrentNode = psNextNode)
-  {
-    /* Update to the next node in list. */
-    psNextNode = psCurrentNode->psNextNode;
-
-    /* Free the defensive copy of the the current node's key and free
-       the node itself. */
-    free(psCurrentNode->pcKey);
-    free(psCurrentNode);
-  }
+  /* Free all nodes, with their key copies, chunk by chunk rather than
+     node by node. */
+  Slab_clear(&oSymTable->sSlab);
 
   /* Free the "manager" structure for the SymTable ADT. */
   free(oSymTable);
@@ -99,58 +188,77 @@ size_t SymTable_getLength(SymTable_T oSymTable) {
 
 /*--------------------------------------------------------------------*/
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
-  const void *pvValue) 
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
 {
-  /* The new node to add to linked list. */
-  struct SymTableNode *psNewNode;
+  /* The node whose key is being counted. */
+  struct SymTableNode *psCurrentNode;
 
-  /* A defensive copy of the new node's key. */
-  char *pcKeyCopy;
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
 
+  memset(psStats, 0, sizeof(struct SymTableStats));
+  for (psCurrentNode = oSymTable->psFirstNode;
+       psCurrentNode != NULL;
+       psCurrentNode = psCurrentNode->psNextNode)
+    psStats->uKeyBytes += strlen(psCurrentNode->acKey) + 1;
+
+  /* The list is a single chain that never resizes. */
+  psStats->uLength = oSymTable->uLength;
+  psStats->uBucketCount = 1;
+  psStats->dLoadFactor = (double)oSymTable->uLength;
+  psStats->uLongestChain = oSymTable->uLength;
+  psStats->auChainCounts[oSymTable->uLength < SYMTABLE_STATS_CHAINS ?
+    oSymTable->uLength : SYMTABLE_STATS_CHAINS - 1] = 1;
+  psStats->uNodeBytes =
+    oSymTable->uLength * offsetof(struct SymTableNode, acKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
   assert(oSymTable != NULL);
-  assert(pcKey != NULL);
+  assert(psFile != NULL);
 
-  /* If a binding with the same key already exists in the SymTable, do
-     nothing to SymTable. */
-  if (SymTable_contains(oSymTable, pcKey) == 1)
-    return 0;
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
 
-  /* Allocate memory for new node, but store/pass by reference. */
-  psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode));
+#endif
 
-  /* Check that memory allocation for new node was successful. If not,
-     there's nothing to put. */
-  if (psNewNode == NULL) 
-    return 0;
+/*--------------------------------------------------------------------*/
 
-  /* Allocate memory for defensive key copy with same size as the 
-     original key passed into function. */
-  pcKeyCopy = (char *) malloc(sizeof(char) * (strlen(pcKey) + 1)); 
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  assert(oSymTable != NULL);
 
-  /* Check that memory allocation for defensie key copy was 
-     successful. If not, can't put in the new node. */
-  if (pcKeyCopy == NULL) {
-    free(psNewNode);
-    return 0;
-  }
+  /* A list never resizes, so there is nothing to reserve. */
+  (void)uCapacity;
+  return 1;
+}
 
-  /* Make the defensive copy of key. */
-  pcKeyCopy = strcpy(pcKeyCopy, pcKey);
+/*--------------------------------------------------------------------*/
 
-  /* Initialize key/value of new node. */
-  psNewNode->pcKey = pcKeyCopy;
-  psNewNode->pvValue = (void *) pvValue;
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, 
+  const void *pvValue) 
+{
+  /* Whether a new node was inserted. */
+  int iInserted;
 
-  /* Insert new node at the start of the linked list. */
-  psNewNode->psNextNode = oSymTable->psFirstNode;
-  oSymTable->psFirstNode = psNewNode;
+  /* The node with key pcKey, found or inserted. */
+  struct SymTableNode *psNode;
 
-  /* Update the size of the SymTable. */
-  oSymTable->uLength++;
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
 
-  /* Put was successful. */
-  return 1;
+  PROFILE_BEGIN(PROFILE_PUT);
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  PROFILE_END(&oSymTable->sProfile, psNode != NULL && ! iInserted);
+
+  /* If a binding with the same key already exists in the SymTable, do
+     nothing to SymTable and put fails, as it does if memory for the 
+     new node is insufficient. */
+  return psNode != NULL && iInserted;
 }
 
 /*--------------------------------------------------------------------*/
@@ -167,6 +275,8 @@ void *SymTable_replace(SymTable_T oSymTable,
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
 
+  PROFILE_BEGIN(PROFILE_REPLACE);
+
   /* Iterate through linked list and stop if target is found or end of
     list reached. */
   for (psCurrentNode = oSymTable->psFirstNode;
@@ -174,13 +284,15 @@ void *SymTable_replace(SymTable_T oSymTable,
     psCurrentNode = psCurrentNode->psNextNode)
   {
     /* Target is found when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
+    PROFILE_PROBE();
+    if (PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0) {
       /* Store the binding's old value to be returned at end of
          function. */
       pvOldValue = psCurrentNode->pvValue;
 
       /* Update target binding's value. */
       psCurrentNode->pvValue = (void*)pvValue;
+      PROFILE_END(&oSymTable->sProfile, 1);
 
       /* Function was successful, return binding's old value. */
       return pvOldValue;
@@ -188,6 +300,7 @@ void *SymTable_replace(SymTable_T oSymTable,
   }
 
   /* Function was unsuccessful (target doesn't exist in SymTable). */
+  PROFILE_END(&oSymTable->sProfile, 0);
   return NULL;
 }
 
@@ -207,7 +320,7 @@ int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
     psCurrentNode = psCurrentNode->psNextNode)
   {
     /* Target is found when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0)
+    if (strcmp(psCurrentNode->acKey, pcKey) == 0)
       /* Successful target hit, return TRUE (1). */
       return 1;
   }
@@ -229,6 +342,8 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
 
+  PROFILE_BEGIN(PROFILE_GET);
+
   /* Iterate through linked list and stop if target is found or end of
     list reached. */
   for (psCurrentNode = oSymTable->psFirstNode;
@@ -236,9 +351,13 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
     psCurrentNode = psNextNode)
   {
     /* Target is found when keys match. */
-    if (strcmp(psCurrentNode->pcKey, pcKey) == 0)
+    PROFILE_PROBE();
+    if (PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0) {
+      PROFILE_END(&oSymTable->sProfile, 1);
+
       /* Return the value of target binding. */
       return psCurrentNode->pvValue;
+    }
     
     /* Keep searching through linked list by jumping to next node. */
     psNextNode = psCurrentNode->psNextNode;
@@ -246,11 +365,29 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
 
   /* Target was not found before the end of linked list. No value to 
      return. */
+  PROFILE_END(&oSymTable->sProfile, 0);
   return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* Incrementor over the keys. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  /* Each lookup walks the list, so there is nothing to overlap. */
+  for (u = 0; u < uCount; u++)
+    apvOut[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
   /* The node being compared to target. */
   struct SymTableNode *psCurrentNode;
@@ -264,16 +401,20 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
   assert(oSymTable != NULL);
   assert(pcKey != NULL);
 
+  PROFILE_BEGIN(PROFILE_REMOVE);
+
   /* Iterate through linked list until end of list is reached or the
      target node is found. Track the previous node accordingly. */
   for (psCurrentNode = oSymTable->psFirstNode, psPreviousNode = NULL;
        psCurrentNode != NULL && 
-       strcmp(psCurrentNode->pcKey, pcKey) != 0;
+       (PROFILE_PROBE(),
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) != 0);
        psPreviousNode = psCurrentNode, 
        psCurrentNode = psCurrentNode->psNextNode);
   
   /* If the end of the list was reached, there's nothing to remove. */
   if (psCurrentNode == NULL) {
+    PROFILE_END(&oSymTable->sProfile, 0);
     return NULL;
   }
   /* If the node before the target is NULL, then the target was at the 
@@ -293,20 +434,158 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
   /* Update the return value to be the target binding's value. */
   pvReturnValue = psCurrentNode->pvValue;
 
-  /* Free the target node's defensive key copy, then free the target 
-     node itself. */
-  free(psCurrentNode->pcKey);
-  free(psCurrentNode);
+  /* Return the target node, with its defensive key copy, to the
+     slab. */
+  Slab_release(&oSymTable->sSlab, psCurrentNode,
+               SymTable_nodeSize(strlen(psCurrentNode->acKey)));
 
   /* Update the length of the linked list accordingly. */
   oSymTable->uLength--;
 
+  PROFILE_END(&oSymTable->sProfile, 1);
+
   /* Return the value of the binding which was removed. */
   return pvReturnValue;
 }
 
 /*--------------------------------------------------------------------*/
 
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  if (psNode == NULL)
+    return NULL;
+
+  /* Give the address of the binding's value. */
+  return &psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  psNode = SymTable_findOrInsert(oSymTable, pcKey, pvValue, &iInserted);
+  if (psNode == NULL)
+    return 0;
+
+  /* An existing binding's value is combined with pvValue. */
+  if (! iInserted)
+    psNode->pvValue = pfCombine(psNode->acKey, psNode->pvValue,
+                                (void *)pvValue, (void *)pvExtra);
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  /* The list compares keys directly, so there is nothing to hash. */
+  return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  (void)uHashKey;
+  return SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  (void)uHashKey;
+  return SymTable_contains(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  (void)uHashKey;
+  return SymTable_get(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The allocator of the copied nodes. */
+  struct Slab sNewSlab;
+
+  /* The first copied node, and the link to fill with the next copy. */
+  struct SymTableNode *psNewFirstNode;
+  struct SymTableNode **ppsNewLink;
+
+  /* The node being copied and its copy. */
+  struct SymTableNode *psCurrentNode, *psNewNode;
+
+  /* The size of the node being copied. */
+  size_t uNodeSize;
+
+  assert(oSymTable != NULL);
+
+  /* Copy every node, in order, into a fresh slab, so the chunks that
+     removals left mostly empty are freed along with the old slab. */
+  Slab_init(&sNewSlab);
+  psNewFirstNode = NULL;
+  ppsNewLink = &psNewFirstNode;
+  for (psCurrentNode = oSymTable->psFirstNode;
+       psCurrentNode != NULL;
+       psCurrentNode = psCurrentNode->psNextNode)
+  {
+    uNodeSize = SymTable_nodeSize(strlen(psCurrentNode->acKey));
+    psNewNode = (struct SymTableNode *)Slab_alloc(&sNewSlab, uNodeSize);
+
+    /* Leave the table as it was if the copy cannot be finished. */
+    if (psNewNode == NULL) {
+      Slab_clear(&sNewSlab);
+      return 0;
+    }
+
+    memcpy(psNewNode, psCurrentNode, uNodeSize);
+    psNewNode->psNextNode = NULL;
+    *ppsNewLink = psNewNode;
+    ppsNewLink = &psNewNode->psNextNode;
+  }
+
+  Slab_clear(&oSymTable->sSlab);
+  oSymTable->sSlab = sNewSlab;
+  oSymTable->psFirstNode = psNewFirstNode;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 void SymTable_map(SymTable_T oSymTable,
   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
   const void *pvExtra) 
@@ -324,7 +603,223 @@ void SymTable_map(SymTable_T oSymTable,
        psCurrentNode = psCurrentNode->psNextNode)
   {
     /* Apply pfApply to the current node. */
-    pfApply(psCurrentNode->pcKey, psCurrentNode->pvValue, 
+    pfApply(psCurrentNode->acKey, psCurrentNode->pvValue, 
       (void * ) pvExtra);
   }
-}
\ No newline at end of file
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks. */
+
+struct SymTableMapping {
+  /* The first node of each task; the last task may be short. */
+  struct SymTableNode **ppsStarts;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the MAP_CHUNK nodes of task uTask, passing the pvExtra of worker
+   uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+
+  /* The pvExtra of the worker. */
+  void *pvExtra;
+
+  /* The current node, and the number of nodes left in the task. */
+  struct SymTableNode *psCurrentNode;
+  size_t u;
+
+  assert(psMapping != NULL);
+
+  pvExtra = psMapping->apvExtras == NULL ?
+    NULL : psMapping->apvExtras[uWorker];
+  for (psCurrentNode = psMapping->ppsStarts[uTask], u = MAP_CHUNK;
+       psCurrentNode != NULL && u > 0;
+       psCurrentNode = psCurrentNode->psNextNode, u--)
+    psMapping->pfApply(psCurrentNode->acKey, psCurrentNode->pvValue,
+                       pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks, and their number. */
+  struct SymTableMapping sMapping;
+  size_t uTaskCount;
+
+  /* The current node, and its index in the list. */
+  struct SymTableNode *psCurrentNode;
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  /* A list has no index, so one serial walk first records where each
+     task starts. Without memory for that, walk it all serially. */
+  uTaskCount = (oSymTable->uLength + MAP_CHUNK - 1) / MAP_CHUNK;
+  sMapping.ppsStarts = (struct SymTableNode **)
+    malloc(uTaskCount * sizeof(struct SymTableNode *));
+  if (uTaskCount <= 1 || sMapping.ppsStarts == NULL) {
+    free(sMapping.ppsStarts);
+    SymTable_map(oSymTable, pfApply,
+                 apvExtras == NULL ? NULL : apvExtras[0]);
+    return;
+  }
+
+  for (psCurrentNode = oSymTable->psFirstNode, u = 0;
+       psCurrentNode != NULL;
+       psCurrentNode = psCurrentNode->psNextNode, u++)
+    if (u % MAP_CHUNK == 0)
+      sMapping.ppsStarts[u / MAP_CHUNK] = psCurrentNode;
+
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  WorkPool_run(uTaskCount, uThreadCount, SymTable_mapTask, &sMapping);
+
+  free(sMapping.ppsStarts);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator walks the list in order. */
+
+struct SymTableIter {
+  /* The next node to visit, or NULL once every node was visited. */
+  struct SymTableNode *psNextNode;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+
+  oIter->psNextNode = oSymTable->psFirstNode;
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The node visited. */
+  struct SymTableNode *psNode;
+
+  assert(oIter != NULL);
+
+  psNode = oIter->psNextNode;
+  if (psNode == NULL)
+    return 0;
+  oIter->psNextNode = psNode->psNextNode;
+
+  if (ppcKey != NULL)
+    *ppcKey = psNode->acKey;
+  if (ppvValue != NULL)
+    *ppvValue = psNode->pvValue;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* A list has no buckets, so the budget counts nodes, and a nonzero
+     cursor is the serial of the last node visited. The scan goes on
+     with the nodes of lower serials, which follow the nodes put since
+     and which removals do not reorder. */
+  for (psCurrentNode = oSymTable->psFirstNode;
+       psCurrentNode != NULL && uCursor != 0 &&
+         psCurrentNode->uSerial >= uCursor;
+       psCurrentNode = psCurrentNode->psNextNode)
+    ;
+
+  for (; psCurrentNode != NULL;
+       psCurrentNode = psCurrentNode->psNextNode)
+  {
+    pfApply(psCurrentNode->acKey, psCurrentNode->pvValue,
+            (void *)pvExtra);
+    if (--uBudget == 0)
+      return psCurrentNode->psNextNode == NULL ?
+        0 : psCurrentNode->uSerial;
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings with the prefix. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  /* The list is in insertion order, so the bindings are gathered
+     and sorted by key. */
+  KeyOrder_init(&sOrder, NULL, NULL, pcPrefix);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings in the range. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  KeyOrder_init(&sOrder, pcLow, pcHigh, NULL);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
@@ -0,0 +1,1379 @@
+/*--------------------------------------------------------------------*/
+/* symtablesharded.c                                                  */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* pthread mutexes and posix_memalign() are POSIX functions. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "strhash.h"
+#include "slab.h"
+#include "workpool.h"
+#include "keyorder.h"
+#include "profile.h"
+
+/* A chained hash table that many threads may share, split into
+   SYMTABLE_SHARD_COUNT shards by the high bits of each key's hash
+   code. Each shard is a complete chained table with its own mutex,
+   length, slab and buckets array, and every call locks only the shard
+   of its key, so threads whose keys fall in different shards neither
+   wait for each other nor share cache lines. A shard doubles or
+   shrinks its own buckets array, which blocks only calls on that
+   shard. SymTable_new and SymTable_free must not overlap any other
+   call on the table. */
+
+#ifndef __GNUC__
+#error "symtablesharded.c needs the GCC __atomic builtins"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The number of shards of each table, a power of two. More shards let
+   more writers proceed at once, and cost a mutex, a slab and a small
+   buckets array each. */
+#ifndef SYMTABLE_SHARD_COUNT
+#define SYMTABLE_SHARD_COUNT 16
+#endif
+
+#if SYMTABLE_SHARD_COUNT < 1 || \
+    (SYMTABLE_SHARD_COUNT & (SYMTABLE_SHARD_COUNT - 1)) != 0
+#error "SYMTABLE_SHARD_COUNT must be a power of two"
+#endif
+
+/* The size in bytes of a cache line, to which shards are aligned. */
+enum {CACHE_LINE = 64};
+
+/* The number of tasks of SymTable_mapParallel per shard, each of
+   which walks an even slice of the shard's buckets. */
+enum {MAP_SLICES = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* The smallest bucket count of a shard, and the bucket count of the
+   shards of a new table. Bucket counts are always powers of two, so a
+   hash code is reduced to a bucket index with a mask instead of a
+   division. */
+static const size_t uInitialBucketCount = 16;
+
+/*--------------------------------------------------------------------*/
+
+/* Each item stored in a SymTable. SymTableNodes are linked to form a
+   chain connected to a bucket element in an array of buckets. Each
+   node is a single block that ends with the defensive copy of its
+   key. */
+
+struct SymTableNode {
+  /* The full (unreduced) hash code of acKey. Its high bits select the
+     shard and its low bits the bucket. */
+  size_t uHash;
+
+  /* The generic value. */
+  void *pvValue;
+
+  /* A reference to the next node in the list. */
+  struct SymTableNode *psNextNode;
+
+  /* The string key, stored inline. */
+  char acKey[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* One shard: a chained table of the keys whose hash codes share the
+   same high bits. Every field but uLength is accessed only while the
+   shard's mutex is held. */
+
+struct SymTableShard {
+  /* The lock that every call on the shard holds. */
+  pthread_mutex_t sLock;
+
+  /* The buckets array and its number of buckets, a power of two. */
+  struct SymTableNode **psaNodeChains;
+  size_t uBucketCount;
+
+  /* The bucket count below which removals never shrink the shard, as
+     reserved by SymTable_newWithCapacity or SymTable_reserve. */
+  size_t uMinBucketCount;
+
+  /* The number of bindings in the shard, which SymTable_getLength
+     reads atomically without the lock. */
+  size_t uLength;
+
+  /* The number of times the shard's bucket count has changed. */
+  size_t uResizeCount;
+
+  /* The allocator of the shard's nodes. */
+  struct Slab sSlab;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable structure is a "manager" structure that points to its
+   shards. */
+
+struct SymTable {
+  /* The shards, each in its own cache-line-aligned block. */
+  struct SymTableShard *apsShards[SYMTABLE_SHARD_COUNT];
+
+  /* The seed of this table's hash function, chosen at random when the
+     table is created so that colliding keys cannot be precomputed. */
+  size_t uSeed;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table, shared by its shards; see
+     profile.h. */
+  struct Profile sProfile;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the full hash code under the seed of oSymTable of the key
+   whose token from SymTable_hashKey is uHashKey. */
+static size_t SymTable_seedHash(SymTable_T oSymTable, size_t uHashKey) {
+  assert(oSymTable != NULL);
+
+  return StrHash_mixSeed(uHashKey, oSymTable->uSeed);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the full hash code for pcKey under the seed of oSymTable. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_seedHash(oSymTable, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the shard of oSymTable that holds the key whose full hash
+   code is uHash, chosen by the high bits of uHash, and lock it. */
+static struct SymTableShard *SymTable_lockShard(SymTable_T oSymTable,
+  size_t uHash)
+{
+  /* The shard of the key. */
+  struct SymTableShard *psShard;
+
+  assert(oSymTable != NULL);
+
+#if SYMTABLE_SHARD_COUNT == 1
+  (void)uHash;
+  psShard = oSymTable->apsShards[0];
+#else
+  psShard = oSymTable->apsShards[
+    uHash / ((size_t)-1 / SYMTABLE_SHARD_COUNT + 1)];
+#endif
+
+  pthread_mutex_lock(&psShard->sLock);
+  return psShard;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size in bytes of a node whose key has uKeyLength
+   characters. */
+static size_t SymTable_nodeSize(size_t uKeyLength) {
+  return offsetof(struct SymTableNode, acKey) + uKeyLength + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest bucket count, a power of two that is at least
+   uInitialBucketCount, at which a shard holding uLength bindings does
+   not resize. */
+static size_t SymTable_bucketCountFor(size_t uLength) {
+  /* The candidate bucket count. */
+  size_t uBucketCount = uInitialBucketCount;
+
+  /* Stop doubling before the count overflows; allocating that many
+     buckets fails anyway. */
+  while (uBucketCount <= uLength && uBucketCount <= (size_t)-1 / 4)
+    uBucketCount *= 2;
+
+  return uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings that each shard must hold so that a
+   table holds uCapacity bindings without resizing. Keys spread over
+   the shards only about evenly, so each gets an eighth more than its
+   even share. */
+static size_t SymTable_shareOf(size_t uCapacity) {
+  /* Each shard's even share of uCapacity. */
+  size_t uShare = uCapacity / SYMTABLE_SHARD_COUNT;
+
+  return uShare + uShare / 8 + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every node of psShard into the buckets array psaNewNodeChains
+   of uBucketCount buckets, which replaces its current one. */
+static void SymTable_rebucket(struct SymTableShard *psShard,
+  struct SymTableNode **psaNewNodeChains, size_t uBucketCount)
+{
+  /* The bucket being emptied. */
+  size_t uBucket;
+
+  /* The current node being moved and the next node to be moved. */
+  struct SymTableNode *psCurrentNode, *psNextNode;
+
+  /* The new bucket index of the current node. */
+  size_t uHashValue;
+
+  assert(psShard != NULL);
+  assert(psaNewNodeChains != NULL);
+
+  /* Nodes keep their hash codes, so moving them reads no keys. */
+  for (uBucket = 0; uBucket < psShard->uBucketCount; uBucket++)
+    for (psCurrentNode = psShard->psaNodeChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psNextNode)
+    {
+      psNextNode = psCurrentNode->psNextNode;
+      uHashValue = psCurrentNode->uHash & (uBucketCount - 1);
+      psCurrentNode->psNextNode = psaNewNodeChains[uHashValue];
+      psaNewNodeChains[uHashValue] = psCurrentNode;
+    }
+
+  free(psShard->psaNodeChains);
+  psShard->psaNodeChains = psaNewNodeChains;
+  if (uBucketCount != psShard->uBucketCount)
+    psShard->uResizeCount++;
+  psShard->uBucketCount = uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every node of psShard into a new buckets array of uBucketCount
+   buckets. Return 1 if successful, or 0 if insufficient memory is
+   available, in which case the shard is unchanged. */
+static int SymTable_resizeShard(struct SymTableShard *psShard,
+  size_t uBucketCount)
+{
+  /* The new buckets array. */
+  struct SymTableNode **psaNewNodeChains;
+
+  assert(psShard != NULL);
+
+  psaNewNodeChains = calloc(uBucketCount,
+                            sizeof(struct SymTableNode *));
+  if (psaNewNodeChains == NULL)
+    return 0;
+
+  SymTable_rebucket(psShard, psaNewNodeChains, uBucketCount);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the link (a bucket or some node's psNextNode
+   field) of psShard that refers to the node whose key is pcKey, where
+   uHash is the full hash code of pcKey, or NULL if no such node
+   exists. */
+static struct SymTableNode **SymTable_findLink(
+  struct SymTableShard *psShard, const char *pcKey, size_t uHash)
+{
+  /* The link referring to the current node. */
+  struct SymTableNode **ppsLink;
+
+  /* The current node being examined. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(psShard != NULL);
+  assert(pcKey != NULL);
+
+  ppsLink =
+    &psShard->psaNodeChains[uHash & (psShard->uBucketCount - 1)];
+  while ((psCurrentNode = *ppsLink) != NULL) {
+    PROFILE_PROBE();
+    if (psCurrentNode->uHash == uHash &&
+        PROFILE_STRCMP(psCurrentNode->acKey, pcKey) == 0)
+      return ppsLink;
+    ppsLink = &psCurrentNode->psNextNode;
+  }
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of psShard whose key is pcKey, where uHash is the
+   full hash code of pcKey, first inserting a new node with key pcKey
+   and value pvValue if no such node exists, or NULL if insufficient
+   memory is available. Set *piInserted to 1 if a new node was
+   inserted, or to 0 otherwise. The shard's lock must be held. */
+static struct SymTableNode *SymTable_findOrInsert(
+  struct SymTableShard *psShard, const char *pcKey, size_t uHash,
+  const void *pvValue, int *piInserted)
+{
+  /* The link referring to an existing node with key pcKey. */
+  struct SymTableNode **ppsLink;
+
+  /* The bucket to add the new node to. */
+  size_t uHashValue;
+
+  /* The length of the new binding's key. */
+  size_t uKeyLength;
+
+  /* The node corresponding to the new binding. */
+  struct SymTableNode *psNewNode;
+
+  assert(psShard != NULL);
+  assert(pcKey != NULL);
+  assert(piInserted != NULL);
+
+  *piInserted = 0;
+
+  ppsLink = SymTable_findLink(psShard, pcKey, uHash);
+  if (ppsLink != NULL)
+    return *ppsLink;
+
+  uKeyLength = strlen(pcKey);
+  psNewNode = (struct SymTableNode *)
+    Slab_alloc(&psShard->sSlab, SymTable_nodeSize(uKeyLength));
+  if (psNewNode == NULL)
+    return NULL;
+
+  memcpy(psNewNode->acKey, pcKey, uKeyLength + 1);
+  psNewNode->uHash = uHash;
+  psNewNode->pvValue = (void *)pvValue;
+
+  uHashValue = uHash & (psShard->uBucketCount - 1);
+  psNewNode->psNextNode = psShard->psaNodeChains[uHashValue];
+  psShard->psaNodeChains[uHashValue] = psNewNode;
+  __atomic_store_n(&psShard->uLength, psShard->uLength + 1,
+                   __ATOMIC_RELAXED);
+  *piInserted = 1;
+
+  /* Double the shard's buckets once its bindings reach their number.
+     If memory is insufficient the shard keeps its buckets, and works
+     on with longer chains. Nodes never move in memory, so psNewNode
+     stays valid. */
+  if (psShard->uLength >= psShard->uBucketCount &&
+      psShard->uBucketCount <= (size_t)-1 / 4)
+    (void)SymTable_resizeShard(psShard, psShard->uBucketCount * 2);
+
+  return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock every shard of oSymTable, always in the same order so that two
+   callers cannot deadlock. */
+static void SymTable_lockAll(SymTable_T oSymTable) {
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++)
+    pthread_mutex_lock(&oSymTable->apsShards[u]->sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Unlock every shard of oSymTable. */
+static void SymTable_unlockAll(SymTable_T oSymTable) {
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++)
+    pthread_mutex_unlock(&oSymTable->apsShards[u]->sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free psShard and everything it owns. */
+static void SymTable_freeShard(struct SymTableShard *psShard) {
+  assert(psShard != NULL);
+
+  Slab_clear(&psShard->sSlab);
+  pthread_mutex_destroy(&psShard->sLock);
+  free(psShard->psaNodeChains);
+  free(psShard);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void) {
+  return SymTable_newWithCapacity(0);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* Reference to struct SymTable "manager" of given SymTable
+     instance. */
+  SymTable_T oSymTable;
+
+  /* The shard being created and its memory. */
+  struct SymTableShard *psShard;
+  void *pvMemory;
+
+  /* The bucket count of every shard. */
+  size_t uBucketCount;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+  if (oSymTable == NULL)
+    return NULL;
+
+  uBucketCount = SymTable_bucketCountFor(SymTable_shareOf(uCapacity));
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    /* Align each shard to a cache line, so that threads working in
+       different shards never write to the same line. */
+    psShard = NULL;
+    if (posix_memalign(&pvMemory, CACHE_LINE,
+                       sizeof(struct SymTableShard)) == 0) {
+      psShard = (struct SymTableShard *)pvMemory;
+      psShard->psaNodeChains =
+        calloc(uBucketCount, sizeof(struct SymTableNode *));
+      if (psShard->psaNodeChains == NULL ||
+          pthread_mutex_init(&psShard->sLock, NULL) != 0) {
+        free(psShard->psaNodeChains);
+        free(psShard);
+        psShard = NULL;
+      }
+    }
+
+    /* If any shard cannot be created, neither can the table. */
+    if (psShard == NULL) {
+      while (u > 0)
+        SymTable_freeShard(oSymTable->apsShards[--u]);
+      free(oSymTable);
+      return NULL;
+    }
+
+    psShard->uBucketCount = uBucketCount;
+    psShard->uMinBucketCount = uBucketCount;
+    psShard->uLength = 0;
+    psShard->uResizeCount = 0;
+    Slab_init(&psShard->sSlab);
+    oSymTable->apsShards[u] = psShard;
+  }
+
+  /* Choose this table's hash seed. This also draws the process seed,
+     if it has not been drawn yet. */
+  oSymTable->uSeed = StrHash_newSeed(oSymTable);
+
+  PROFILE_INIT(&oSymTable->sProfile);
+
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable) {
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++)
+    SymTable_freeShard(oSymTable->apsShards[u]);
+  free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  /* The sum of the shards' lengths. */
+  size_t uLength = 0;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  /* While other threads put and remove, the sum is only a snapshot of
+     each shard at a slightly different time. */
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++)
+    uLength += __atomic_load_n(&oSymTable->apsShards[u]->uLength,
+                               __ATOMIC_RELAXED);
+  return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  /* The shard being measured, and its index. */
+  struct SymTableShard *psShard;
+  size_t u;
+
+  /* The bucket being measured, and the length of its chain. */
+  size_t uBucket, uChainLength;
+
+  /* The node being counted. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
+
+  memset(psStats, 0, sizeof(struct SymTableStats));
+
+  /* The shards are measured one at a time, so the sums are snapshots
+     of each shard at a slightly different time, as in
+     SymTable_getLength. */
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    pthread_mutex_lock(&psShard->sLock);
+    for (uBucket = 0; uBucket < psShard->uBucketCount; uBucket++) {
+      uChainLength = 0;
+      for (psCurrentNode = psShard->psaNodeChains[uBucket];
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+      {
+        psStats->uKeyBytes += strlen(psCurrentNode->acKey) + 1;
+        uChainLength++;
+      }
+
+      if (uChainLength > psStats->uLongestChain)
+        psStats->uLongestChain = uChainLength;
+      psStats->auChainCounts[uChainLength < SYMTABLE_STATS_CHAINS ?
+        uChainLength : SYMTABLE_STATS_CHAINS - 1]++;
+    }
+    psStats->uLength += psShard->uLength;
+    psStats->uBucketCount += psShard->uBucketCount;
+    psStats->uResizeCount += psShard->uResizeCount;
+    pthread_mutex_unlock(&psShard->sLock);
+  }
+
+  psStats->dLoadFactor =
+    (double)psStats->uLength / (double)psStats->uBucketCount;
+  psStats->uNodeBytes =
+    psStats->uLength * offsetof(struct SymTableNode, acKey);
+  psStats->uBucketBytes =
+    psStats->uBucketCount * sizeof(struct SymTableNode *);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
+  assert(oSymTable != NULL);
+  assert(psFile != NULL);
+
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  /* The bucket count that each shard needs. */
+  size_t uBucketCount;
+
+  /* The new buckets arrays of the shards that need them, or NULL. */
+  struct SymTableNode **apsaNewNodeChains[SYMTABLE_SHARD_COUNT];
+
+  /* The shard being reserved. */
+  struct SymTableShard *psShard;
+
+  /* Whether every buckets array could be allocated. */
+  int iSuccessful = 1;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  uBucketCount = SymTable_bucketCountFor(SymTable_shareOf(uCapacity));
+
+  /* Allocate every buckets array before moving any node, so that the
+     table is unchanged if memory runs out. */
+  SymTable_lockAll(oSymTable);
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    apsaNewNodeChains[u] = NULL;
+    if (iSuccessful &&
+        uBucketCount > oSymTable->apsShards[u]->uBucketCount) {
+      apsaNewNodeChains[u] =
+        calloc(uBucketCount, sizeof(struct SymTableNode *));
+      if (apsaNewNodeChains[u] == NULL)
+        iSuccessful = 0;
+    }
+  }
+
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    if (! iSuccessful)
+      free(apsaNewNodeChains[u]);
+    else {
+      if (apsaNewNodeChains[u] != NULL)
+        SymTable_rebucket(psShard, apsaNewNodeChains[u], uBucketCount);
+
+      /* Removals never shrink the shard below the reservation. */
+      if (uBucketCount > psShard->uMinBucketCount)
+        psShard->uMinBucketCount = uBucketCount;
+    }
+  }
+  SymTable_unlockAll(oSymTable);
+
+  return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The new buckets arrays, their bucket counts, and the slabs of the
+     copied nodes, of every shard. */
+  struct SymTableNode **apsaNewNodeChains[SYMTABLE_SHARD_COUNT];
+  size_t auBucketCounts[SYMTABLE_SHARD_COUNT];
+  struct Slab asNewSlabs[SYMTABLE_SHARD_COUNT];
+
+  /* The shard being copied. */
+  struct SymTableShard *psShard;
+
+  /* The bucket being copied, and the new bucket index of a copy. */
+  size_t uBucket, uHashValue;
+
+  /* The node being copied, its size, and its copy. */
+  struct SymTableNode *psCurrentNode;
+  size_t uNodeSize;
+  struct SymTableNode *psNewNode;
+
+  /* Whether every copy could be made. */
+  int iSuccessful = 1;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+
+  /* Copy every shard before replacing any, so that the table is
+     unchanged if memory runs out. */
+  SymTable_lockAll(oSymTable);
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    Slab_init(&asNewSlabs[u]);
+    auBucketCounts[u] = SymTable_bucketCountFor(psShard->uLength);
+    apsaNewNodeChains[u] = NULL;
+    if (iSuccessful)
+      apsaNewNodeChains[u] =
+        calloc(auBucketCounts[u], sizeof(struct SymTableNode *));
+    if (apsaNewNodeChains[u] == NULL) {
+      iSuccessful = 0;
+      continue;
+    }
+
+    /* Copy every node into a fresh slab, so the chunks that removals
+       left mostly empty are freed along with the old slab. */
+    for (uBucket = 0; uBucket < psShard->uBucketCount; uBucket++)
+      for (psCurrentNode = psShard->psaNodeChains[uBucket];
+           psCurrentNode != NULL && iSuccessful;
+           psCurrentNode = psCurrentNode->psNextNode)
+      {
+        uNodeSize = SymTable_nodeSize(strlen(psCurrentNode->acKey));
+        psNewNode = (struct SymTableNode *)
+          Slab_alloc(&asNewSlabs[u], uNodeSize);
+        if (psNewNode == NULL) {
+          iSuccessful = 0;
+          break;
+        }
+        memcpy(psNewNode, psCurrentNode, uNodeSize);
+        uHashValue = psNewNode->uHash & (auBucketCounts[u] - 1);
+        psNewNode->psNextNode = apsaNewNodeChains[u][uHashValue];
+        apsaNewNodeChains[u][uHashValue] = psNewNode;
+      }
+  }
+
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    if (! iSuccessful) {
+      Slab_clear(&asNewSlabs[u]);
+      free(apsaNewNodeChains[u]);
+    }
+    else {
+      Slab_clear(&psShard->sSlab);
+      psShard->sSlab = asNewSlabs[u];
+      free(psShard->psaNodeChains);
+      psShard->psaNodeChains = apsaNewNodeChains[u];
+      if (auBucketCounts[u] != psShard->uBucketCount)
+        psShard->uResizeCount++;
+      psShard->uBucketCount = auBucketCounts[u];
+
+      /* The shard is now only as large as it must be. */
+      psShard->uMinBucketCount = 0;
+    }
+  }
+  SymTable_unlockAll(oSymTable);
+
+  return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+  const void *pvValue)
+{
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_putHashed(oSymTable, pcKey, SymTable_hashKey(pcKey),
+                            pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The previous value of the target binding before replacing. */
+  void *pvOldValue = NULL;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REPLACE);
+  uHash = SymTable_hash(oSymTable, pcKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  ppsLink = SymTable_findLink(psShard, pcKey, uHash);
+  if (ppsLink != NULL) {
+    pvOldValue = (*ppsLink)->pvValue;
+    (*ppsLink)->pvValue = (void *)pvValue;
+  }
+  pthread_mutex_unlock(&psShard->sLock);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_containsHashed(oSymTable, pcKey,
+                                 SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_getHashed(oSymTable, pcKey, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* Incrementor over the keys. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  /* The keys of a batch fall in different shards, each with its own
+     lock, so each lookup is made on its own. */
+  for (u = 0; u < uCount; u++)
+    apvOut[u] = SymTable_get(oSymTable, apcKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The node being removed. */
+  struct SymTableNode *psCurrentNode;
+
+  /* The value of the target binding before removing. */
+  void *pvReturnValue = NULL;
+
+  /* The shrunken bucket count of the shard. */
+  size_t uBucketCount;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REMOVE);
+  uHash = SymTable_hash(oSymTable, pcKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  ppsLink = SymTable_findLink(psShard, pcKey, uHash);
+  if (ppsLink != NULL) {
+    psCurrentNode = *ppsLink;
+    *ppsLink = psCurrentNode->psNextNode;
+    pvReturnValue = psCurrentNode->pvValue;
+    Slab_release(&psShard->sSlab, psCurrentNode,
+                 SymTable_nodeSize(strlen(psCurrentNode->acKey)));
+    __atomic_store_n(&psShard->uLength, psShard->uLength - 1,
+                     __ATOMIC_RELAXED);
+
+    /* Shrink the shard's buckets once its load falls below 1/8, down
+       to a load of about 1/2, but never below its reservation. */
+    if (psShard->uLength < psShard->uBucketCount / 8) {
+      uBucketCount = SymTable_bucketCountFor(psShard->uLength * 2);
+      if (uBucketCount < psShard->uMinBucketCount)
+        uBucketCount = psShard->uMinBucketCount;
+      if (uBucketCount < psShard->uBucketCount)
+        (void)SymTable_resizeShard(psShard, uBucketCount);
+    }
+  }
+  pthread_mutex_unlock(&psShard->sLock);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  return pvReturnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  uHash = SymTable_hash(oSymTable, pcKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  psNode = SymTable_findOrInsert(psShard, pcKey, uHash, pvValue,
+                                 &iInserted);
+  pthread_mutex_unlock(&psShard->sLock);
+
+  if (psNode == NULL)
+    return NULL;
+
+  /* Give the address of the binding's value. The shard is unlocked,
+     so a thread that shares the table must not use the address while
+     another thread may call a function on the same key. */
+  return &psNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  /* pfCombine runs under the shard's lock, so combining is atomic with
+     respect to other calls on the key. */
+  uHash = SymTable_hash(oSymTable, pcKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  psNode = SymTable_findOrInsert(psShard, pcKey, uHash, pvValue,
+                                 &iInserted);
+  if (psNode != NULL && ! iInserted)
+    psNode->pvValue = pfCombine(psNode->acKey, psNode->pvValue,
+                                (void *)pvValue, (void *)pvExtra);
+  pthread_mutex_unlock(&psShard->sLock);
+
+  return psNode != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  return StrHash_hash(pcKey, StrHash_processSeed());
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The node of the binding, found or inserted. */
+  struct SymTableNode *psNode;
+
+  /* Whether a new node was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  uHash = SymTable_seedHash(oSymTable, uHashKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  psNode = SymTable_findOrInsert(psShard, pcKey, uHash, pvValue,
+                                 &iInserted);
+  pthread_mutex_unlock(&psShard->sLock);
+  PROFILE_END(&oSymTable->sProfile, psNode != NULL && ! iInserted);
+
+  /* If a binding with the same key does exist, put fails and SymTable
+     is unchanged. Put also fails if memory for the new node is
+     insufficient. */
+  return psNode != NULL && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* Whether the binding exists. */
+  int iFound;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  uHash = SymTable_seedHash(oSymTable, uHashKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  iFound = SymTable_findLink(psShard, pcKey, uHash) != NULL;
+  pthread_mutex_unlock(&psShard->sLock);
+
+  return iFound;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* The full hash code of pcKey, and its shard. */
+  size_t uHash;
+  struct SymTableShard *psShard;
+
+  /* The link referring to the target node. */
+  struct SymTableNode **ppsLink;
+
+  /* The value of the target binding. */
+  void *pvValue = NULL;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+  uHash = SymTable_seedHash(oSymTable, uHashKey);
+  psShard = SymTable_lockShard(oSymTable, uHash);
+  ppsLink = SymTable_findLink(psShard, pcKey, uHash);
+  if (ppsLink != NULL)
+    pvValue = (*ppsLink)->pvValue;
+  pthread_mutex_unlock(&psShard->sLock);
+  PROFILE_END(&oSymTable->sProfile, ppsLink != NULL);
+
+  return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The shard being walked. */
+  struct SymTableShard *psShard;
+
+  /* The bucket being walked. */
+  size_t uBucket;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  /* Each shard is locked while it is walked, so pfApply must not call
+     any function on oSymTable. */
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    pthread_mutex_lock(&psShard->sLock);
+    for (uBucket = 0; uBucket < psShard->uBucketCount; uBucket++)
+      for (psCurrentNode = psShard->psaNodeChains[uBucket];
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+        (*pfApply)(psCurrentNode->acKey, psCurrentNode->pvValue,
+                   (void *)pvExtra);
+    pthread_mutex_unlock(&psShard->sLock);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks. */
+
+struct SymTableMapping {
+  /* The table being walked. */
+  SymTable_T oSymTable;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the chains of slice uTask % MAP_SLICES of shard uTask / MAP_SLICES,
+   passing the pvExtra of worker uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+
+  /* The pvExtra of the worker. */
+  void *pvExtra;
+
+  /* The shard being walked. */
+  struct SymTableShard *psShard;
+
+  /* The bucket being walked, and the end of the slice. */
+  size_t uBucket;
+  size_t uEnd;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(psMapping != NULL);
+
+  pvExtra = psMapping->apvExtras == NULL ?
+    NULL : psMapping->apvExtras[uWorker];
+  psShard = psMapping->oSymTable->apsShards[uTask / MAP_SLICES];
+  uTask %= MAP_SLICES;
+  uEnd = psShard->uBucketCount * (uTask + 1) / MAP_SLICES;
+
+  for (uBucket = psShard->uBucketCount * uTask / MAP_SLICES;
+       uBucket < uEnd; uBucket++)
+    for (psCurrentNode = psShard->psaNodeChains[uBucket];
+         psCurrentNode != NULL;
+         psCurrentNode = psCurrentNode->psNextNode)
+      (*psMapping->pfApply)(psCurrentNode->acKey,
+                            psCurrentNode->pvValue, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks. */
+  struct SymTableMapping sMapping;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  /* Every shard stays locked for the whole walk, so that its buckets
+     array cannot be replaced under a worker; the workers themselves
+     take no locks. */
+  sMapping.oSymTable = oSymTable;
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  SymTable_lockAll(oSymTable);
+  WorkPool_run(SYMTABLE_SHARD_COUNT * MAP_SLICES, uThreadCount,
+               SymTable_mapTask, &sMapping);
+  SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator walks one shard at a time and holds that shard's lock
+   from its first binding until the call after its last one, or until
+   SymTable_iterEnd. Meanwhile the iterating thread must call no other
+   function on the table, and other threads' calls on that shard
+   wait. */
+
+struct SymTableIter {
+  /* The table walked. */
+  SymTable_T oSymTable;
+
+  /* The locked shard being walked, or NULL between shards, and the
+     index of the next shard to walk. */
+  struct SymTableShard *psShard;
+  size_t uNextShard;
+
+  /* The next bucket of psShard to walk. */
+  size_t uNextBucket;
+
+  /* The next node of the current chain, or NULL at its end. */
+  struct SymTableNode *psNextNode;
+
+  /* The number of bindings of psShard not visited yet, so that the
+     walk leaves the shard at its last binding rather than at its last
+     bucket. */
+  size_t uLeft;
+};
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+
+  oIter->oSymTable = oSymTable;
+  oIter->psShard = NULL;
+  oIter->uNextShard = 0;
+  oIter->psNextNode = NULL;
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The node visited. */
+  struct SymTableNode *psNode;
+
+  assert(oIter != NULL);
+
+  while (oIter->psNextNode == NULL) {
+    if (oIter->psShard != NULL && oIter->uLeft == 0) {
+      pthread_mutex_unlock(&oIter->psShard->sLock);
+      oIter->psShard = NULL;
+    }
+
+    if (oIter->psShard == NULL) {
+      if (oIter->uNextShard == SYMTABLE_SHARD_COUNT)
+        return 0;
+      oIter->psShard = oIter->oSymTable->apsShards[oIter->uNextShard++];
+      pthread_mutex_lock(&oIter->psShard->sLock);
+      oIter->uNextBucket = 0;
+      oIter->uLeft = oIter->psShard->uLength;
+    }
+    else
+      oIter->psNextNode =
+        oIter->psShard->psaNodeChains[oIter->uNextBucket++];
+  }
+  psNode = oIter->psNextNode;
+  oIter->psNextNode = psNode->psNextNode;
+  oIter->uLeft--;
+
+  if (ppcKey != NULL)
+    *ppcKey = psNode->acKey;
+  if (ppvValue != NULL)
+    *ppvValue = psNode->pvValue;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  if (oIter->psShard != NULL)
+    pthread_mutex_unlock(&oIter->psShard->sLock);
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the cursor that follows uCursor in a scan of the buckets
+   whose indices are masked by uMask, one less than a power of two, or
+   0 after the last bucket. Cursors count in reverse binary, carrying
+   from the highest bit of uMask down, so the buckets that a bucket
+   splits into when the bucket count doubles, or merges with when it
+   halves, come next to one another in the order of the scan. */
+static size_t SymTable_nextCursor(size_t uCursor, size_t uMask) {
+  /* The bit being incremented. */
+  size_t uBit = uMask - (uMask >> 1);
+
+  uCursor &= uMask;
+  while ((uCursor & uBit) != 0) {
+    uCursor &= ~uBit;
+    uBit >>= 1;
+  }
+  return uCursor | uBit;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The shard being scanned, and its index. */
+  struct SymTableShard *psShard;
+  size_t uShard;
+
+  /* The mask of the bucket indices of psShard. */
+  size_t uMask;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* The shards are scanned in turn, each with its own reverse-binary
+     cursor, since each resizes on its own. The low bits of uCursor
+     hold the shard's index and the rest its cursor. */
+  uShard = uCursor % SYMTABLE_SHARD_COUNT;
+  uCursor /= SYMTABLE_SHARD_COUNT;
+  for (;;) {
+    psShard = oSymTable->apsShards[uShard];
+    pthread_mutex_lock(&psShard->sLock);
+    uMask = psShard->uBucketCount - 1;
+    do {
+      for (psCurrentNode = psShard->psaNodeChains[uCursor & uMask];
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+        (*pfApply)(psCurrentNode->acKey, psCurrentNode->pvValue,
+                   (void *)pvExtra);
+      uCursor = SymTable_nextCursor(uCursor, uMask);
+    } while (--uBudget > 0 && uCursor != 0);
+    pthread_mutex_unlock(&psShard->sLock);
+
+    if (uCursor != 0)
+      return uCursor * SYMTABLE_SHARD_COUNT + uShard;
+    if (++uShard == SYMTABLE_SHARD_COUNT)
+      return 0;
+    if (uBudget == 0)
+      return uShard;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply pfApply, with pvExtra, in increasing key order to the bindings
+   of oSymTable gathered by psOrder, whose range is set. Return 1 if
+   successful, or 0 if insufficient memory is available, in which case
+   pfApply is not called. */
+static int SymTable_mapOrdered(SymTable_T oSymTable,
+  struct KeyOrder *psOrder,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The shard being walked. */
+  struct SymTableShard *psShard;
+
+  /* The bucket being walked. */
+  size_t uBucket;
+
+  /* The current node being visited. */
+  struct SymTableNode *psCurrentNode;
+
+  /* Incrementor over the shards. */
+  size_t u;
+
+  /* Return value. */
+  int iSuccessful;
+
+  assert(oSymTable != NULL);
+  assert(psOrder != NULL);
+  assert(pfApply != NULL);
+
+  /* Hashing scatters the keys over the shards, so the bindings are
+     gathered and sorted by key. Every shard stays locked from the
+     gathering through the applying, so that no gathered node is
+     removed meanwhile, and pfApply must not call any function on
+     oSymTable. */
+  SymTable_lockAll(oSymTable);
+  for (u = 0; u < SYMTABLE_SHARD_COUNT; u++) {
+    psShard = oSymTable->apsShards[u];
+    for (uBucket = 0; uBucket < psShard->uBucketCount; uBucket++)
+      for (psCurrentNode = psShard->psaNodeChains[uBucket];
+           psCurrentNode != NULL;
+           psCurrentNode = psCurrentNode->psNextNode)
+        KeyOrder_collect(psCurrentNode->acKey, psCurrentNode->pvValue,
+                         psOrder);
+  }
+  iSuccessful = KeyOrder_apply(psOrder, pfApply, pvExtra);
+  SymTable_unlockAll(oSymTable);
+  return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings with the prefix. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  KeyOrder_init(&sOrder, NULL, NULL, pcPrefix);
+  return SymTable_mapOrdered(oSymTable, &sOrder, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings in the range. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  KeyOrder_init(&sOrder, pcLow, pcHigh, NULL);
+  return SymTable_mapOrdered(oSymTable, &sOrder, pfApply, pvExtra);
+}
@@ -0,0 +1,1300 @@
+/*--------------------------------------------------------------------*/
+/* symtableswiss.c                                                    */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtable.h"
+#include "strhash.h"
+#include "slab.h"
+#include "workpool.h"
+#include "keyorder.h"
+#include "profile.h"
+
+/* Probe groups with SSE2 when the compiler targets it, unless the
+   portable scalar path is forced with -DSYMTABLE_NO_SIMD. */
+#if defined(__SSE2__) && !defined(SYMTABLE_NO_SIMD)
+#include <emmintrin.h>
+#define SYMTABLE_USE_SSE2
+#endif
+
+/* Hint that the memory at p will be read soon, if the compiler
+   supports it. */
+#ifdef __GNUC__
+#define SYMTABLE_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define SYMTABLE_PREFETCH(p) ((void)(p))
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The number of control bytes (and slots) examined by one group
+   probe. The slot count of a SymTable is always a power of two that is
+   at least GROUP_WIDTH, so groups never straddle the end of the
+   arrays. */
+enum {GROUP_WIDTH = 16};
+
+/* The number of lookups that SymTable_getBatch interleaves. */
+enum {BATCH_GROUP = 16};
+
+/* The number of slots that each task of SymTable_mapParallel
+   visits. */
+enum {MAP_CHUNK = 1024};
+
+/* The control byte of a slot that has never held a binding. A probe
+   for a key stops at the first group that contains one of these. */
+static const unsigned char ucEmpty = 0x80;
+
+/* The control byte of a slot whose binding was removed from a group
+   that had no EMPTY slot (a "tombstone"). Probes continue past it. */
+static const unsigned char ucDeleted = 0xFE;
+
+/* The mask selecting the 7 low bits of a hash code that are stored in
+   the control byte of a full slot. A full slot's control byte
+   therefore always has its high bit clear. */
+static const size_t uTagMask = 0x7F;
+
+/*--------------------------------------------------------------------*/
+
+/* Each binding stored in a SymTable. Slots are stored contiguously in
+   an array parallel to the control bytes, so a lookup only touches a
+   slot (and its key) once that slot's control byte has matched. */
+
+struct SymTableSlot {
+  /* The string key. */
+  char *pcKey;
+
+  /* The generic value. */
+  void *pvValue;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable structure is a "manager" structure which tracks the
+   control byte array and the slot array of an open-addressing hash
+   table; it tracks the number of slots, how many more EMPTY slots may
+   be filled before a rehash, and the total number of bindings. */
+
+struct SymTable {
+  /* Array of uCapacity control bytes: ucEmpty, ucDeleted, or the
+     7-bit tag of the binding held by the corresponding slot. */
+  unsigned char *pucControl;
+
+  /* Array of uCapacity slots. */
+  struct SymTableSlot *psaSlots;
+
+  /* The number of slots, a power of two that is at least
+     GROUP_WIDTH. */
+  size_t uCapacity;
+
+  /* The number of EMPTY slots that can still be filled before the
+     load factor limit of 7/8 is reached. */
+  size_t uGrowthLeft;
+
+  /* The total number of bindings in SymTable. */
+  size_t uLength;
+
+  /* The number of times the slot count has changed since the table
+     was created, for SymTable_getStats. */
+  size_t uResizeCount;
+
+  /* The slot count below which removals never shrink the table, as
+     reserved by SymTable_newWithCapacity or SymTable_reserve. */
+  size_t uMinCapacity;
+
+  /* The seed of this table's hash function, chosen at random when the
+     table is created so that colliding keys cannot be precomputed. */
+  size_t uSeed;
+
+  /* The allocator of this table's defensive key copies. */
+  struct Slab sSlab;
+
+#ifdef SYMTABLE_PROFILE
+  /* The counts of the calls on this table; see profile.h. */
+  struct Profile sProfile;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code under the seed of oSymTable of the key whose
+   token from SymTable_hashKey is uHashKey. Its low 7 bits are the tag
+   of the key and the remaining bits pick the first group to probe. */
+static size_t SymTable_seedHash(SymTable_T oSymTable, size_t uHashKey) {
+  assert(oSymTable != NULL);
+
+  return StrHash_mixSeed(uHashKey, oSymTable->uSeed);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code for pcKey under the seed of oSymTable. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_seedHash(oSymTable, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the maximum number of bindings that a table with uCapacity
+   slots may hold, which is 7/8 of its slots. */
+static size_t SymTable_maxLoad(size_t uCapacity) {
+  return uCapacity - uCapacity / 8;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask with bit i set iff the control byte
+   pucGroup[i] equals ucTag, for the GROUP_WIDTH bytes at pucGroup. */
+static unsigned SymTable_matchTag(const unsigned char *pucGroup,
+  unsigned char ucTag)
+{
+#ifdef SYMTABLE_USE_SSE2
+  __m128i oGroup = _mm_loadu_si128((const __m128i *)pucGroup);
+  return (unsigned)_mm_movemask_epi8(
+    _mm_cmpeq_epi8(oGroup, _mm_set1_epi8((char)ucTag)));
+#else
+  unsigned uMask = 0;
+  int i;
+
+  for (i = 0; i < GROUP_WIDTH; i++)
+    if (pucGroup[i] == ucTag)
+      uMask |= 1u << i;
+
+  return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask with bit i set iff the slot of control byte
+   pucGroup[i] holds no binding (it is EMPTY or DELETED), for the
+   GROUP_WIDTH bytes at pucGroup. */
+static unsigned SymTable_matchFree(const unsigned char *pucGroup)
+{
+#ifdef SYMTABLE_USE_SSE2
+  /* Free control bytes are exactly those with their high bit set. */
+  return (unsigned)_mm_movemask_epi8(
+    _mm_loadu_si128((const __m128i *)pucGroup));
+#else
+  unsigned uMask = 0;
+  int i;
+
+  for (i = 0; i < GROUP_WIDTH; i++)
+    if ((pucGroup[i] & 0x80) != 0)
+      uMask |= 1u << i;
+
+  return uMask;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the lowest set bit of the nonzero uMask. */
+static size_t SymTable_lowestBit(unsigned uMask) {
+  assert(uMask != 0);
+#ifdef __GNUC__
+  return (size_t)__builtin_ctz(uMask);
+#else
+  {
+    size_t uBit = 0;
+    while ((uMask & 1u) == 0) {
+      uMask >>= 1;
+      uBit++;
+    }
+    return uBit;
+  }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the slot in oSymTable holding the binding with
+   key pcKey, whose hash code is uHash, or oSymTable->uCapacity if no
+   such binding exists. */
+static size_t SymTable_findSlot(SymTable_T oSymTable, const char *pcKey,
+  size_t uHash)
+{
+  /* The mask that reduces a group index modulo the group count. */
+  size_t uGroupMask;
+
+  /* The group being probed and the distance of the next probe. */
+  size_t uGroup, uStep;
+
+  /* The tag to look for and the control bytes of the current group. */
+  unsigned char ucTag;
+  const unsigned char *pucGroup;
+
+  /* The control bytes in the current group that match ucTag. */
+  unsigned uMatches;
+
+  /* The index of a slot whose control byte matched. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  uGroupMask = oSymTable->uCapacity / GROUP_WIDTH - 1;
+  ucTag = (unsigned char)(uHash & uTagMask);
+
+  /* Visit groups along the triangular probe sequence. Because the
+     group count is a power of two, the sequence visits every group,
+     and the load factor limit guarantees an EMPTY slot is found. */
+  for (uGroup = (uHash >> 7) & uGroupMask, uStep = 1; ;
+       uGroup = (uGroup + uStep++) & uGroupMask)
+  {
+    pucGroup = oSymTable->pucControl + uGroup * GROUP_WIDTH;
+    PROFILE_PROBE();
+
+    /* Only slots whose tags match need their keys compared. */
+    for (uMatches = SymTable_matchTag(pucGroup, ucTag); uMatches != 0;
+         uMatches &= uMatches - 1)
+    {
+      uSlot = uGroup * GROUP_WIDTH + SymTable_lowestBit(uMatches);
+      if (PROFILE_STRCMP(oSymTable->psaSlots[uSlot].pcKey, pcKey) == 0)
+        return uSlot;
+    }
+
+    /* The key would have been placed in this group if it had room, so
+       an EMPTY slot here ends the search. */
+    if (SymTable_matchTag(pucGroup, ucEmpty) != 0)
+      return oSymTable->uCapacity;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first slot that holds no binding along the
+   probe sequence of hash code uHash in a control byte array of
+   uCapacity bytes at pucControl. */
+static size_t SymTable_findFreeSlot(const unsigned char *pucControl,
+  size_t uCapacity, size_t uHash)
+{
+  /* The mask that reduces a group index modulo the group count. */
+  size_t uGroupMask = uCapacity / GROUP_WIDTH - 1;
+
+  /* The group being probed and the distance of the next probe. */
+  size_t uGroup, uStep;
+
+  /* The free slots in the current group. */
+  unsigned uFree;
+
+  assert(pucControl != NULL);
+
+  for (uGroup = (uHash >> 7) & uGroupMask, uStep = 1; ;
+       uGroup = (uGroup + uStep++) & uGroupMask)
+  {
+    uFree = SymTable_matchFree(pucControl + uGroup * GROUP_WIDTH);
+    if (uFree != 0)
+      return uGroup * GROUP_WIDTH + SymTable_lowestBit(uFree);
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Rebuild the hash table of oSymTable with uNewCapacity slots, which
+   drops all tombstones. Return 1 if successful, or 0 if insufficient
+   memory is available, in which case oSymTable is unchanged. */
+static int SymTable_rehash(SymTable_T oSymTable, size_t uNewCapacity) {
+  /* The new control byte and slot arrays. */
+  unsigned char *pucNewControl;
+  struct SymTableSlot *psaNewSlots;
+
+  /* The slot being moved and its position in the new arrays. */
+  size_t uSlot, uNewSlot;
+
+  /* The hash code of the key being moved. */
+  size_t uHash;
+
+  assert(oSymTable != NULL);
+  assert(uNewCapacity % GROUP_WIDTH == 0);
+  assert(SymTable_maxLoad(uNewCapacity) >= oSymTable->uLength);
+
+  /* The size of the slot array must be representable. */
+  if (uNewCapacity > (size_t)-1 / sizeof(struct SymTableSlot))
+    return 0;
+
+  pucNewControl = (unsigned char *)malloc(uNewCapacity);
+  if (pucNewControl == NULL)
+    return 0;
+
+  psaNewSlots = (struct SymTableSlot *)
+    malloc(uNewCapacity * sizeof(struct SymTableSlot));
+  if (psaNewSlots == NULL) {
+    free(pucNewControl);
+    return 0;
+  }
+
+  memset(pucNewControl, ucEmpty, uNewCapacity);
+
+  /* Move every binding into the first free slot along its probe
+     sequence in the new arrays. No key comparisons are necessary since
+     all keys are already distinct. */
+  for (uSlot = 0; uSlot < oSymTable->uCapacity; uSlot++) {
+    if ((oSymTable->pucControl[uSlot] & 0x80) != 0)
+      continue;
+
+    uHash = SymTable_hash(oSymTable, oSymTable->psaSlots[uSlot].pcKey);
+    uNewSlot = SymTable_findFreeSlot(pucNewControl, uNewCapacity,
+                                     uHash);
+    pucNewControl[uNewSlot] = (unsigned char)(uHash & uTagMask);
+    psaNewSlots[uNewSlot] = oSymTable->psaSlots[uSlot];
+  }
+
+  free(oSymTable->pucControl);
+  free(oSymTable->psaSlots);
+
+  /* A table's first arrays, and a rehash that only clears tombstones,
+     are not resizes. */
+  if (oSymTable->uCapacity != 0 && oSymTable->uCapacity != uNewCapacity)
+    oSymTable->uResizeCount++;
+
+  oSymTable->pucControl = pucNewControl;
+  oSymTable->psaSlots = psaNewSlots;
+  oSymTable->uCapacity = uNewCapacity;
+  oSymTable->uGrowthLeft = SymTable_maxLoad(uNewCapacity) -
+                           oSymTable->uLength;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest slot count, a power of two that is at least
+   GROUP_WIDTH, whose load limit is at least uLength bindings. */
+static size_t SymTable_capacityFor(size_t uLength) {
+  /* The candidate slot count. */
+  size_t uCapacity = GROUP_WIDTH;
+
+  /* Stop doubling before the count overflows; allocating that many
+     slots fails anyway. */
+  while (SymTable_maxLoad(uCapacity) < uLength &&
+         uCapacity <= (size_t)-1 / 4)
+    uCapacity *= 2;
+
+  return uCapacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Shrink the arrays of the SymTable ADT referenced by oSymTable once
+   fewer than 1/16 of its slots are full, down to a load of about 1/2.
+   The gap between the two loads means that a table whose size hovers
+   around a threshold does not shrink and grow over and over. If
+   memory is insufficient the table keeps its arrays. */
+static void SymTable_shrinkIfNecessary(SymTable_T oSymTable) {
+  /* The shrunken slot count. */
+  size_t uNewCapacity;
+
+  assert(oSymTable != NULL);
+
+  if (oSymTable->uCapacity <= oSymTable->uMinCapacity ||
+      oSymTable->uLength >= oSymTable->uCapacity / 16)
+    return;
+
+  uNewCapacity = SymTable_capacityFor(oSymTable->uLength * 2);
+  if (uNewCapacity < oSymTable->uMinCapacity)
+    uNewCapacity = oSymTable->uMinCapacity;
+
+  (void)SymTable_rehash(oSymTable, uNewCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the slot of oSymTable whose key is pcKey, where
+   uHash is the full hash code of pcKey, first inserting a new binding
+   with key pcKey and value pvValue if no such slot exists, or
+   oSymTable->uCapacity if insufficient memory is available. Set
+   *piInserted to 1 if a new binding was inserted, or to 0 otherwise.
+   The table is probed once for the key, and the hash code is computed
+   by the caller. */
+static size_t SymTable_findOrInsert(SymTable_T oSymTable,
+  const char *pcKey, size_t uHash, const void *pvValue, int *piInserted)
+{
+  /* The slot that will hold the new binding. */
+  size_t uSlot;
+
+  /* Defensive copy of the new binding's key, and its length. */
+  char *pcKeyCopy;
+  size_t uKeyLength;
+
+  /* The capacity to rehash to when no EMPTY slot may be filled. */
+  size_t uNewCapacity;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(piInserted != NULL);
+
+  *piInserted = 0;
+
+  /* If a binding with the same key already exists, its slot is the
+     result. */
+  uSlot = SymTable_findSlot(oSymTable, pcKey, uHash);
+  if (uSlot != oSymTable->uCapacity)
+    return uSlot;
+
+  uKeyLength = strlen(pcKey);
+  pcKeyCopy = (char *)Slab_alloc(&oSymTable->sSlab, uKeyLength + 1);
+  if (pcKeyCopy == NULL)
+    return oSymTable->uCapacity;
+  memcpy(pcKeyCopy, pcKey, uKeyLength + 1);
+
+  uSlot = SymTable_findFreeSlot(oSymTable->pucControl,
+                                oSymTable->uCapacity, uHash);
+
+  /* Reusing a tombstone never raises the load, but filling an EMPTY
+     slot when no growth is left requires a rehash first. Double the
+     table unless removals left enough tombstones that rehashing at the
+     same size frees sufficient room. */
+  if (oSymTable->pucControl[uSlot] == ucEmpty &&
+      oSymTable->uGrowthLeft == 0)
+  {
+    uNewCapacity = oSymTable->uCapacity;
+    if (oSymTable->uLength >= SymTable_maxLoad(uNewCapacity) / 2)
+      uNewCapacity *= 2;
+
+    if (! SymTable_rehash(oSymTable, uNewCapacity)) {
+      Slab_release(&oSymTable->sSlab, pcKeyCopy, uKeyLength + 1);
+      return oSymTable->uCapacity;
+    }
+
+    uSlot = SymTable_findFreeSlot(oSymTable->pucControl,
+                                  oSymTable->uCapacity, uHash);
+  }
+
+  if (oSymTable->pucControl[uSlot] == ucEmpty)
+    oSymTable->uGrowthLeft--;
+
+  oSymTable->pucControl[uSlot] = (unsigned char)(uHash & uTagMask);
+  oSymTable->psaSlots[uSlot].pcKey = pcKeyCopy;
+  oSymTable->psaSlots[uSlot].pvValue = (void *)pvValue;
+
+  oSymTable->uLength++;
+
+  *piInserted = 1;
+  return uSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void) {
+  return SymTable_newWithCapacity(0);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  /* Reference to struct SymTable "manager" of given SymTable
+     instance. */
+  SymTable_T oSymTable;
+
+  oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+  if (oSymTable == NULL)
+    return NULL;
+
+  /* Start with no arrays at all and let SymTable_rehash allocate the
+     smallest table that holds uCapacity bindings, at least a single
+     group. */
+  oSymTable->pucControl = NULL;
+  oSymTable->psaSlots = NULL;
+  oSymTable->uCapacity = 0;
+  oSymTable->uLength = 0;
+  oSymTable->uResizeCount = 0;
+  oSymTable->uSeed = StrHash_newSeed(oSymTable);
+  Slab_init(&oSymTable->sSlab);
+  PROFILE_INIT(&oSymTable->sProfile);
+
+  if (! SymTable_rehash(oSymTable, SymTable_capacityFor(uCapacity))) {
+    free(oSymTable);
+    return NULL;
+  }
+
+  /* Removals never shrink the table below its initial size. */
+  oSymTable->uMinCapacity = oSymTable->uCapacity;
+
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  /* Free all defensive key copies chunk by chunk rather than visiting
+     every slot. */
+  Slab_clear(&oSymTable->sSlab);
+
+  free(oSymTable->pucControl);
+  free(oSymTable->psaSlots);
+  free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  assert(oSymTable != NULL);
+
+  /* Return the uLength field tracked by the "manager" SymTable
+     structure. */
+  return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  /* The mask that reduces a group index modulo the group count. */
+  size_t uGroupMask;
+
+  /* The group whose chain is measured, and the group being probed
+     from it and the distance of the next probe. */
+  size_t uHome, uGroup, uStep;
+
+  /* The number of full groups probed from uHome. */
+  size_t uChainLength;
+
+  /* Incrementor over the slots. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(psStats != NULL);
+
+  memset(psStats, 0, sizeof(struct SymTableStats));
+  psStats->uLength = oSymTable->uLength;
+  psStats->uBucketCount = oSymTable->uCapacity / GROUP_WIDTH;
+  psStats->dLoadFactor =
+    (double)oSymTable->uLength / (double)oSymTable->uCapacity;
+  psStats->uResizeCount = oSymTable->uResizeCount;
+  psStats->uBucketBytes = oSymTable->uCapacity *
+    (sizeof(unsigned char) + sizeof(struct SymTableSlot));
+
+  for (uSlot = 0; uSlot < oSymTable->uCapacity; uSlot++)
+    if ((oSymTable->pucControl[uSlot] & 0x80) == 0)
+      psStats->uKeyBytes +=
+        strlen(oSymTable->psaSlots[uSlot].pcKey) + 1;
+
+  /* Follow the probe sequence from each group, as a lookup of a
+     missing key would, to the first group with an EMPTY slot, which
+     the load factor limit guarantees. */
+  uGroupMask = psStats->uBucketCount - 1;
+  for (uHome = 0; uHome < psStats->uBucketCount; uHome++) {
+    uChainLength = 0;
+    for (uGroup = uHome, uStep = 1;
+         SymTable_matchTag(oSymTable->pucControl + uGroup * GROUP_WIDTH,
+                           ucEmpty) == 0;
+         uGroup = (uGroup + uStep++) & uGroupMask)
+      uChainLength++;
+
+    if (uChainLength > psStats->uLongestChain)
+      psStats->uLongestChain = uChainLength;
+    psStats->auChainCounts[uChainLength < SYMTABLE_STATS_CHAINS ?
+                           uChainLength : SYMTABLE_STATS_CHAINS - 1]++;
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+void SymTable_dumpProfile(SymTable_T oSymTable, FILE *psFile) {
+  assert(oSymTable != NULL);
+  assert(psFile != NULL);
+
+  Profile_dump(&oSymTable->sProfile, psFile);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  /* The slot count that holds uCapacity bindings. */
+  size_t uNewCapacity;
+
+  assert(oSymTable != NULL);
+
+  /* Removals must not shrink the table below the reserved size. */
+  uNewCapacity = SymTable_capacityFor(uCapacity);
+  if (uNewCapacity > oSymTable->uMinCapacity)
+    oSymTable->uMinCapacity = uNewCapacity;
+
+  /* Nothing to do if enough EMPTY slots may still be filled. */
+  if (oSymTable->uLength + oSymTable->uGrowthLeft >= uCapacity)
+    return 1;
+
+  /* Otherwise rehash, which also clears every tombstone. A table is
+     never shrunk. */
+  if (uNewCapacity < oSymTable->uCapacity)
+    uNewCapacity = oSymTable->uCapacity;
+
+  return SymTable_rehash(oSymTable, uNewCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+  const void *pvValue)
+{
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_putHashed(oSymTable, pcKey, SymTable_hashKey(pcKey),
+                            pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The slot holding the target binding. */
+  size_t uSlot;
+
+  /* The previous value of the target binding before replacing. */
+  void *pvOldValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REPLACE);
+  uSlot = SymTable_findSlot(oSymTable, pcKey,
+                            SymTable_hash(oSymTable, pcKey));
+  PROFILE_END(&oSymTable->sProfile, uSlot != oSymTable->uCapacity);
+
+  /* Target does not exist in SymTable, no value to replace. */
+  if (uSlot == oSymTable->uCapacity)
+    return NULL;
+
+  pvOldValue = oSymTable->psaSlots[uSlot].pvValue;
+  oSymTable->psaSlots[uSlot].pvValue = (void *)pvValue;
+  return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_containsHashed(oSymTable, pcKey,
+                                 SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_getHashed(oSymTable, pcKey, SymTable_hashKey(pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* The hash codes of the current group's keys, and the first slot of
+     each key's first group whose tag matches, or uCapacity if none. */
+  size_t auHash[BATCH_GROUP];
+  size_t auSlot[BATCH_GROUP];
+
+  /* The index of the first key of the current group, the number of
+     keys in it, and an incrementor over them. */
+  size_t uFirst, uGroupSize, u;
+
+  /* The mask that reduces a group index modulo the group count, and
+     the first group probed for a key. */
+  size_t uGroupMask, uGroup;
+
+  /* The tag matches in a key's first group. */
+  unsigned uMatches;
+
+  /* The slot holding a target binding. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(apcKeys != NULL || uCount == 0);
+  assert(apvOut != NULL || uCount == 0);
+
+  uGroupMask = oSymTable->uCapacity / GROUP_WIDTH - 1;
+
+  for (uFirst = 0; uFirst < uCount; uFirst += uGroupSize) {
+    uGroupSize = uCount - uFirst;
+    if (uGroupSize > BATCH_GROUP)
+      uGroupSize = BATCH_GROUP;
+
+    /* Hash every key and prefetch the control bytes of its first
+       group. */
+    for (u = 0; u < uGroupSize; u++) {
+      assert(apcKeys[uFirst + u] != NULL);
+      auHash[u] = SymTable_hash(oSymTable, apcKeys[uFirst + u]);
+      SYMTABLE_PREFETCH(oSymTable->pucControl +
+                        ((auHash[u] >> 7) & uGroupMask) * GROUP_WIDTH);
+    }
+
+    /* Match every key's tag and prefetch the first matching slot. */
+    for (u = 0; u < uGroupSize; u++) {
+      uGroup = (auHash[u] >> 7) & uGroupMask;
+      uMatches = SymTable_matchTag(
+        oSymTable->pucControl + uGroup * GROUP_WIDTH,
+        (unsigned char)(auHash[u] & uTagMask));
+      auSlot[u] = oSymTable->uCapacity;
+      if (uMatches != 0) {
+        auSlot[u] = uGroup * GROUP_WIDTH + SymTable_lowestBit(uMatches);
+        SYMTABLE_PREFETCH(&oSymTable->psaSlots[auSlot[u]]);
+      }
+    }
+
+    /* Prefetch the key of every matching slot. */
+    for (u = 0; u < uGroupSize; u++)
+      if (auSlot[u] != oSymTable->uCapacity)
+        SYMTABLE_PREFETCH(oSymTable->psaSlots[auSlot[u]].pcKey);
+
+    /* Probe for every key, whose first group, slot, and key should now
+       be cached. */
+    for (u = 0; u < uGroupSize; u++) {
+      uSlot = SymTable_findSlot(oSymTable, apcKeys[uFirst + u],
+                                auHash[u]);
+      apvOut[uFirst + u] = uSlot == oSymTable->uCapacity ?
+        NULL : oSymTable->psaSlots[uSlot].pvValue;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  /* The slot holding the target binding. */
+  size_t uSlot;
+
+  /* The control bytes of the group containing uSlot. */
+  const unsigned char *pucGroup;
+
+  /* The value of the target binding before removing. */
+  void *pvReturnValue;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_REMOVE);
+  uSlot = SymTable_findSlot(oSymTable, pcKey,
+                            SymTable_hash(oSymTable, pcKey));
+
+  /* If the binding does not exist, there's nothing to remove. */
+  if (uSlot == oSymTable->uCapacity) {
+    PROFILE_END(&oSymTable->sProfile, 0);
+    return NULL;
+  }
+
+  pvReturnValue = oSymTable->psaSlots[uSlot].pvValue;
+  Slab_release(&oSymTable->sSlab, oSymTable->psaSlots[uSlot].pcKey,
+               strlen(oSymTable->psaSlots[uSlot].pcKey) + 1);
+
+  /* A group that still has an EMPTY slot has never been full, so no
+     probe ever continued past it and the slot can become EMPTY again.
+     Otherwise some probe may pass through this slot, so it must become
+     a tombstone. */
+  pucGroup = oSymTable->pucControl +
+             (uSlot & ~(size_t)(GROUP_WIDTH - 1));
+  if (SymTable_matchTag(pucGroup, ucEmpty) != 0) {
+    oSymTable->pucControl[uSlot] = ucEmpty;
+    oSymTable->uGrowthLeft++;
+  }
+  else
+    oSymTable->pucControl[uSlot] = ucDeleted;
+
+  oSymTable->uLength--;
+
+  /* Give memory back after mass removals. */
+  SymTable_shrinkIfNecessary(oSymTable);
+
+  PROFILE_END(&oSymTable->sProfile, 1);
+  return pvReturnValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  /* The slot of the binding, found or inserted. */
+  size_t uSlot;
+
+  /* Whether a new binding was inserted. */
+  int iInserted;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  uSlot = SymTable_findOrInsert(oSymTable, pcKey,
+                                SymTable_hash(oSymTable, pcKey),
+                                pvValue, &iInserted);
+  if (uSlot == oSymTable->uCapacity)
+    return NULL;
+
+  /* Slots move when the table is rehashed, so the address is valid
+     only until the next insertion or removal. */
+  return &oSymTable->psaSlots[uSlot].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The slot of the binding, found or inserted. */
+  size_t uSlot;
+
+  /* Whether a new binding was inserted. */
+  int iInserted;
+
+  /* The binding in uSlot. */
+  struct SymTableSlot *psSlot;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+  assert(pfCombine != NULL);
+
+  uSlot = SymTable_findOrInsert(oSymTable, pcKey,
+                                SymTable_hash(oSymTable, pcKey),
+                                pvValue, &iInserted);
+  if (uSlot == oSymTable->uCapacity)
+    return 0;
+
+  /* An existing binding's value is combined with pvValue. */
+  if (! iInserted) {
+    psSlot = &oSymTable->psaSlots[uSlot];
+    psSlot->pvValue = pfCombine(psSlot->pcKey, psSlot->pvValue,
+                                (void *)pvValue, (void *)pvExtra);
+  }
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_hashKey(const char *pcKey) {
+  assert(pcKey != NULL);
+
+  return StrHash_hash(pcKey, StrHash_processSeed());
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  /* Whether a new binding was inserted. */
+  int iInserted;
+
+  /* The slot of the binding, found or inserted. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_PUT);
+  uSlot = SymTable_findOrInsert(oSymTable, pcKey,
+                                SymTable_seedHash(oSymTable, uHashKey),
+                                pvValue, &iInserted);
+  PROFILE_END(&oSymTable->sProfile,
+              uSlot != oSymTable->uCapacity && ! iInserted);
+
+  /* If a binding with the same key already exists, put fails and
+     SymTable is unchanged. */
+  return uSlot != oSymTable->uCapacity && iInserted;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  return SymTable_findSlot(oSymTable, pcKey,
+                           SymTable_seedHash(oSymTable, uHashKey)) !=
+         oSymTable->uCapacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  /* The slot holding the target binding. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(pcKey != NULL);
+
+  PROFILE_BEGIN(PROFILE_GET);
+  uSlot = SymTable_findSlot(oSymTable, pcKey,
+                            SymTable_seedHash(oSymTable, uHashKey));
+  PROFILE_END(&oSymTable->sProfile, uSlot != oSymTable->uCapacity);
+
+  /* Target does not exist in SymTable, nothing to return. */
+  if (uSlot == oSymTable->uCapacity)
+    return NULL;
+
+  return oSymTable->psaSlots[uSlot].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_shrinkToFit(SymTable_T oSymTable) {
+  /* The copies of the keys of the full slots, in slot order. */
+  char **ppcNewKeys;
+
+  /* The allocator of the copied keys. */
+  struct Slab sNewSlab;
+
+  /* Incrementor over the slots, and the number of keys copied. */
+  size_t uSlot, uCopied;
+
+  /* The size of the key being copied. */
+  size_t uKeySize;
+
+  assert(oSymTable != NULL);
+
+  ppcNewKeys = (char **)
+    malloc(sizeof(char *) * (oSymTable->uLength + 1));
+  if (ppcNewKeys == NULL)
+    return 0;
+
+  /* Copy every key into a fresh slab, so the chunks that removals left
+     mostly empty are freed along with the old slab. */
+  Slab_init(&sNewSlab);
+  for (uSlot = 0, uCopied = 0; uSlot < oSymTable->uCapacity; uSlot++) {
+    if ((oSymTable->pucControl[uSlot] & 0x80) != 0)
+      continue;
+
+    uKeySize = strlen(oSymTable->psaSlots[uSlot].pcKey) + 1;
+    ppcNewKeys[uCopied] = (char *)Slab_alloc(&sNewSlab, uKeySize);
+
+    /* Leave the table as it was if the copy cannot be finished. */
+    if (ppcNewKeys[uCopied] == NULL) {
+      Slab_clear(&sNewSlab);
+      free(ppcNewKeys);
+      return 0;
+    }
+
+    memcpy(ppcNewKeys[uCopied++], oSymTable->psaSlots[uSlot].pcKey,
+           uKeySize);
+  }
+
+  for (uSlot = 0, uCopied = 0; uSlot < oSymTable->uCapacity; uSlot++)
+    if ((oSymTable->pucControl[uSlot] & 0x80) == 0)
+      oSymTable->psaSlots[uSlot].pcKey = ppcNewKeys[uCopied++];
+  free(ppcNewKeys);
+
+  Slab_clear(&oSymTable->sSlab);
+  oSymTable->sSlab = sNewSlab;
+
+  /* Rehashing to the smallest sufficient size also clears every
+     tombstone. The table is then only as large as it must be. */
+  oSymTable->uMinCapacity = GROUP_WIDTH;
+  return SymTable_rehash(oSymTable,
+                         SymTable_capacityFor(oSymTable->uLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* Incrementor to visit every slot. */
+  size_t uSlot;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  /* Apply pfApply to the key/value of every full slot with
+     pvExtra. */
+  for (uSlot = 0; uSlot < oSymTable->uCapacity; uSlot++)
+    if ((oSymTable->pucControl[uSlot] & 0x80) == 0)
+      pfApply(oSymTable->psaSlots[uSlot].pcKey,
+              oSymTable->psaSlots[uSlot].pvValue,
+              (void *)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The arguments of a SymTable_mapParallel, shared by its tasks. */
+
+struct SymTableMapping {
+  /* The table being walked. */
+  SymTable_T oSymTable;
+
+  /* The function to apply, and the pvExtra of each worker, or NULL. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  void *const *apvExtras;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the struct SymTableMapping at pvMapping to
+   the full slots among the MAP_CHUNK slots of task uTask, passing the
+   pvExtra of worker uWorker. */
+static void SymTable_mapTask(void *pvMapping, size_t uTask,
+                             size_t uWorker)
+{
+  /* The mapping, and its table. */
+  struct SymTableMapping *psMapping =
+    (struct SymTableMapping *)pvMapping;
+  SymTable_T oSymTable;
+
+  /* The pvExtra of the worker. */
+  void *pvExtra;
+
+  /* Incrementor over the slots of the task, and its end. */
+  size_t uSlot;
+  size_t uEnd;
+
+  assert(psMapping != NULL);
+
+  oSymTable = psMapping->oSymTable;
+  pvExtra = psMapping->apvExtras == NULL ?
+    NULL : psMapping->apvExtras[uWorker];
+  uEnd = (uTask + 1) * MAP_CHUNK;
+  if (uEnd > oSymTable->uCapacity)
+    uEnd = oSymTable->uCapacity;
+
+  for (uSlot = uTask * MAP_CHUNK; uSlot < uEnd; uSlot++)
+    if ((oSymTable->pucControl[uSlot] & 0x80) == 0)
+      psMapping->pfApply(oSymTable->psaSlots[uSlot].pcKey,
+                         oSymTable->psaSlots[uSlot].pvValue,
+                         pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  /* The arguments shared by the tasks. */
+  struct SymTableMapping sMapping;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uThreadCount > 0);
+
+  sMapping.oSymTable = oSymTable;
+  sMapping.pfApply = pfApply;
+  sMapping.apvExtras = apvExtras;
+  WorkPool_run((oSymTable->uCapacity + MAP_CHUNK - 1) / MAP_CHUNK,
+               uThreadCount, SymTable_mapTask, &sMapping);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An iterator walks the slots a group at a time, so a group of free
+   slots costs one probe of its control bytes. */
+
+struct SymTableIter {
+  /* The table walked. */
+  SymTable_T oSymTable;
+
+  /* The first slot of the current group, and a bit mask of its full
+     slots that were not visited yet. */
+  size_t uGroup;
+  unsigned uFullMask;
+
+  /* The number of bindings not visited yet, so that the walk stops at
+     the last binding rather than at the last slot. */
+  size_t uLeft;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask of the full slots of the group at pucGroup. */
+static unsigned SymTable_matchFull(const unsigned char *pucGroup) {
+  return ~SymTable_matchFree(pucGroup) & ((1u << GROUP_WIDTH) - 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter;
+
+  assert(oSymTable != NULL);
+
+  oIter = (SymTableIter_T)malloc(sizeof(struct SymTableIter));
+  if (oIter == NULL)
+    return NULL;
+
+  oIter->oSymTable = oSymTable;
+  oIter->uGroup = 0;
+  oIter->uFullMask = SymTable_matchFull(oSymTable->pucControl);
+  oIter->uLeft = oSymTable->uLength;
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  /* The slot visited. */
+  struct SymTableSlot *psSlot;
+
+  assert(oIter != NULL);
+
+  if (oIter->uLeft == 0)
+    return 0;
+
+  /* A binding is left, so a full slot is found before the end. */
+  while (oIter->uFullMask == 0) {
+    oIter->uGroup += GROUP_WIDTH;
+    assert(oIter->uGroup < oIter->oSymTable->uCapacity);
+    oIter->uFullMask =
+      SymTable_matchFull(oIter->oSymTable->pucControl + oIter->uGroup);
+  }
+
+  psSlot = &oIter->oSymTable->psaSlots[
+    oIter->uGroup + SymTable_lowestBit(oIter->uFullMask)];
+  oIter->uFullMask &= oIter->uFullMask - 1;
+  oIter->uLeft--;
+
+  if (ppcKey != NULL)
+    *ppcKey = psSlot->pcKey;
+  if (ppvValue != NULL)
+    *ppvValue = psSlot->pvValue;
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_iterEnd(SymTableIter_T oIter) {
+  assert(oIter != NULL);
+
+  free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the cursor that follows uCursor in a scan of the groups
+   whose indices are masked by uMask, one less than a power of two, or
+   0 after the last group. Cursors count in reverse binary, carrying
+   from the highest bit of uMask down, so the groups that a group
+   splits into when the slot count doubles, or merges with when it
+   halves, come next to one another in the order of the scan. */
+static size_t SymTable_nextCursor(size_t uCursor, size_t uMask) {
+  /* The bit being incremented. */
+  size_t uBit = uMask - (uMask >> 1);
+
+  uCursor &= uMask;
+  while ((uCursor & uBit) != 0) {
+    uCursor &= ~uBit;
+    uBit >>= 1;
+  }
+  return uCursor | uBit;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The mask that reduces a group index modulo the group count. */
+  size_t uGroupMask;
+
+  /* The home group scanned, the group being probed, and the distance
+     of the next probe. */
+  size_t uHome, uGroup, uStep;
+
+  /* The control bytes of the current group, and its full slots not
+     checked yet. */
+  const unsigned char *pucGroup;
+  unsigned uFull;
+
+  /* A full slot of the current group. */
+  struct SymTableSlot *psSlot;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+  assert(uBudget > 0);
+
+  /* A slot's index says little about its key's hash code, which
+     probing and resizes may move anywhere. So the cursor counts home
+     groups, the first group of a key's probe sequence, which depend
+     only on the low bits of the hash code as bucket indices do. The
+     keys of a home group lie along its probe sequence, no further than
+     the first group with an EMPTY slot, where lookups stop. */
+  uGroupMask = oSymTable->uCapacity / GROUP_WIDTH - 1;
+  do {
+    uHome = uCursor & uGroupMask;
+    for (uGroup = uHome, uStep = 1; ;
+         uGroup = (uGroup + uStep++) & uGroupMask)
+    {
+      pucGroup = oSymTable->pucControl + uGroup * GROUP_WIDTH;
+      for (uFull = SymTable_matchFull(pucGroup); uFull != 0;
+           uFull &= uFull - 1)
+      {
+        psSlot = &oSymTable->psaSlots[
+          uGroup * GROUP_WIDTH + SymTable_lowestBit(uFull)];
+        if (((SymTable_hash(oSymTable, psSlot->pcKey) >> 7)
+             & uGroupMask) == uHome)
+          pfApply(psSlot->pcKey, psSlot->pvValue, (void *)pvExtra);
+      }
+      if (SymTable_matchTag(pucGroup, ucEmpty) != 0)
+        break;
+    }
+    uCursor = SymTable_nextCursor(uHome, uGroupMask);
+  } while (--uBudget > 0 && uCursor != 0);
+
+  return uCursor;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings with the prefix. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pcPrefix != NULL);
+  assert(pfApply != NULL);
+
+  /* Hashing scatters the keys over the groups, so the bindings
+     are gathered and sorted by key. */
+  KeyOrder_init(&sOrder, NULL, NULL, pcPrefix);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  /* The bindings in the range. */
+  struct KeyOrder sOrder;
+
+  assert(oSymTable != NULL);
+  assert(pfApply != NULL);
+
+  KeyOrder_init(&sOrder, pcLow, pcHigh, NULL);
+  SymTable_map(oSymTable, KeyOrder_collect, &sOrder);
+  return KeyOrder_apply(&sOrder, pfApply, pvExtra);
+}
@@ -0,0 +1,735 @@
+/*--------------------------------------------------------------------*/
+/* symtabletrace.c                                                    */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* pthread mutexes are POSIX. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "symtabletrace.h"
+
+/* A recorder of the calls of the SymTable ADT, in the format of
+   symtabletrace.h. Linked with -Wl,--wrap=SymTable_put and the like,
+   it receives the program's calls of each function as calls of its
+   __wrap_ function, which records the call and passes it on to the
+   __real_ function, the implementation linked into the program. Calls
+   that an implementation makes of itself are not seen. The recorder
+   keeps its own bookkeeping in tables of that same implementation,
+   made through the __real_ functions so that they are not recorded.
+   Records are written under one mutex, in the order in which the
+   calls begin, so a program of many threads may be traced, at the
+   cost of serializing the recording. */
+
+/*--------------------------------------------------------------------*/
+
+/* The implementation, as -Wl,--wrap renames it. */
+
+SymTable_T __real_SymTable_new(void);
+SymTable_T __real_SymTable_newWithCapacity(size_t uCapacity);
+void __real_SymTable_free(SymTable_T oSymTable);
+size_t __real_SymTable_getLength(SymTable_T oSymTable);
+void __real_SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats);
+int __real_SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+int __real_SymTable_shrinkToFit(SymTable_T oSymTable);
+int __real_SymTable_put(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+void *__real_SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+int __real_SymTable_contains(SymTable_T oSymTable, const char *pcKey);
+void *__real_SymTable_get(SymTable_T oSymTable, const char *pcKey);
+void __real_SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[]);
+void *__real_SymTable_remove(SymTable_T oSymTable, const char *pcKey);
+void **__real_SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+int __real_SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra);
+size_t __real_SymTable_hashKey(const char *pcKey);
+int __real_SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue);
+int __real_SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey);
+void *__real_SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey);
+void __real_SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+void __real_SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount);
+SymTableIter_T __real_SymTable_iterBegin(SymTable_T oSymTable);
+int __real_SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue);
+void __real_SymTable_iterEnd(SymTableIter_T oIter);
+size_t __real_SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+int __real_SymTable_mapPrefix(SymTable_T oSymTable,
+  const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+int __real_SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* The name of the trace file when SYMTABLE_TRACE is not set. */
+static const char acDefaultPath[] = "symtable.trace";
+
+/*--------------------------------------------------------------------*/
+
+/* The state of the recorder, which only the holder of sLock may
+   touch. */
+
+struct Trace {
+  /* Whether the recorder has been set up by the first call. */
+  int iOpened;
+
+  /* The trace file, or NULL if it could not be opened, or recording
+     has stopped. */
+  FILE *psFile;
+
+  /* The number of each key written so far, as a value, keyed by the
+     key, and the number of keys. */
+  SymTable_T oKeys;
+  size_t uKeyCount;
+
+  /* The number plus one of each live table and iterator, as a value,
+     keyed by its address, and the number of each created so far. */
+  SymTable_T oTables;
+  size_t uTableCount;
+  SymTable_T oIters;
+  size_t uIterCount;
+};
+
+static struct Trace sTrace;
+
+static pthread_mutex_t sLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*--------------------------------------------------------------------*/
+
+/* Stop recording, closing the trace file and freeing the tables of
+   sTrace. The caller must hold sLock. */
+static void Trace_stop(void) {
+  if (sTrace.psFile != NULL)
+    fclose(sTrace.psFile);
+  sTrace.psFile = NULL;
+
+  if (sTrace.oKeys != NULL)
+    __real_SymTable_free(sTrace.oKeys);
+  if (sTrace.oTables != NULL)
+    __real_SymTable_free(sTrace.oTables);
+  if (sTrace.oIters != NULL)
+    __real_SymTable_free(sTrace.oIters);
+  sTrace.oKeys = sTrace.oTables = sTrace.oIters = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Stop recording, as at exit, so that the trace is complete. */
+static void Trace_close(void) {
+  pthread_mutex_lock(&sLock);
+  Trace_stop();
+  pthread_mutex_unlock(&sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Stop recording after writing to stderr why, in pcReason. The
+   records so far stay readable, though the last may be cut short.
+   The caller must hold sLock. */
+static void Trace_fail(const char *pcReason) {
+  assert(pcReason != NULL);
+
+  fprintf(stderr, "symtabletrace: %s; recording stopped\n", pcReason);
+  Trace_stop();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set up the recorder: open the trace file and write its header. The
+   caller must hold sLock. */
+static void Trace_open(void) {
+  /* The name of the trace file. */
+  const char *pcPath;
+
+  sTrace.iOpened = 1;
+
+  pcPath = getenv("SYMTABLE_TRACE");
+  if (pcPath == NULL || *pcPath == '\0')
+    pcPath = acDefaultPath;
+
+  sTrace.oKeys = __real_SymTable_new();
+  sTrace.oTables = __real_SymTable_new();
+  sTrace.oIters = __real_SymTable_new();
+  if (sTrace.oKeys == NULL || sTrace.oTables == NULL ||
+      sTrace.oIters == NULL) {
+    Trace_fail("insufficient memory");
+    return;
+  }
+
+  sTrace.psFile = fopen(pcPath, "wb");
+  if (sTrace.psFile == NULL) {
+    fprintf(stderr, "symtabletrace: cannot write %s; recording "
+            "stopped\n", pcPath);
+    Trace_stop();
+    return;
+  }
+
+  fwrite("SYMTRACE", 1, 8, sTrace.psFile);
+  putc(TRACE_VERSION, sTrace.psFile);
+  atexit(Trace_close);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write u to the trace as a varint. The caller must hold sLock. */
+static void Trace_writeNumber(size_t u) {
+  if (sTrace.psFile == NULL)
+    return;
+
+  while (u >= 0x80) {
+    putc((int)((u & 0x7f) | 0x80), sTrace.psFile);
+    u >>= 7;
+  }
+  putc((int)u, sTrace.psFile);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the key pcKey, which may be NULL, to the trace, with its
+   characters if it has not been written before. The caller must hold
+   sLock. */
+static void Trace_writeKey(const char *pcKey) {
+  /* The number of the key. */
+  size_t uNumber;
+
+  /* The length of the key. */
+  size_t uLength;
+
+  if (sTrace.psFile == NULL)
+    return;
+
+  if (pcKey == NULL) {
+    Trace_writeNumber(0);
+    return;
+  }
+
+  uNumber = (size_t)(uintptr_t)__real_SymTable_get(sTrace.oKeys, pcKey);
+  if (uNumber != 0) {
+    Trace_writeNumber(uNumber);
+    return;
+  }
+
+  uNumber = sTrace.uKeyCount + 1;
+  if (! __real_SymTable_put(sTrace.oKeys, pcKey,
+                            (void *)(uintptr_t)uNumber)) {
+    Trace_fail("insufficient memory");
+    return;
+  }
+  sTrace.uKeyCount = uNumber;
+
+  uLength = strlen(pcKey);
+  Trace_writeNumber(uNumber);
+  Trace_writeNumber(uLength);
+  fwrite(pcKey, 1, uLength, sTrace.psFile);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to acAddress, which has room for 2 * sizeof(uintptr_t) + 1
+   characters, the key under which the address pv is numbered. */
+static void Trace_addressKey(char *acAddress, const void *pv) {
+  /* The digits of the address, lowest first, and an index over
+     them. */
+  uintptr_t uiAddress = (uintptr_t)pv;
+  size_t u = 0;
+
+  assert(acAddress != NULL);
+
+  do {
+    acAddress[u++] = "0123456789abcdef"[uiAddress & 0xf];
+    uiAddress >>= 4;
+  } while (uiAddress != 0);
+  acAddress[u] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Number the table or iterator at pv, the next of the *puCount made
+   so far, in oNumbers, and return its number. Return 0 after stopping
+   if memory is insufficient. The caller must hold sLock. */
+static size_t Trace_addObject(SymTable_T oNumbers, size_t *puCount,
+  const void *pv)
+{
+  /* The key of the address. */
+  char acAddress[2 * sizeof(uintptr_t) + 1];
+
+  /* The number of the object. */
+  size_t uNumber;
+
+  assert(puCount != NULL);
+
+  Trace_addressKey(acAddress, pv);
+  uNumber = (*puCount)++;
+  if (! __real_SymTable_put(oNumbers, acAddress,
+                            (void *)(uintptr_t)(uNumber + 1))) {
+    Trace_fail("insufficient memory");
+    return 0;
+  }
+  return uNumber;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number plus one of the table or iterator at pv in
+   oNumbers, or 0 if it has none, removing it from oNumbers if
+   iRemove is 1. The caller must hold sLock. */
+static size_t Trace_findObject(SymTable_T oNumbers, const void *pv,
+  int iRemove)
+{
+  /* The key of the address. */
+  char acAddress[2 * sizeof(uintptr_t) + 1];
+
+  Trace_addressKey(acAddress, pv);
+  if (iRemove)
+    return (size_t)(uintptr_t)__real_SymTable_remove(oNumbers,
+                                                     acAddress);
+  return (size_t)(uintptr_t)__real_SymTable_get(oNumbers, acAddress);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock the recorder and begin the record of a call of iOperation on
+   oSymTable, or on no table if oSymTable is NULL: write the operation
+   and the table's number. A table that the recorder has never seen
+   made is numbered now, with a record of its making. Return 1 if the
+   call is to be recorded, in which case the caller writes its other
+   fields and calls Trace_end, or 0 if recording has stopped, in which
+   case the recorder is left unlocked. If iFree is 1, the table is
+   being freed, and its address is forgotten. */
+static int Trace_begin(int iOperation, SymTable_T oSymTable,
+  int iFree)
+{
+  /* The number plus one of the table. */
+  size_t uNumber = 0;
+
+  pthread_mutex_lock(&sLock);
+  if (! sTrace.iOpened)
+    Trace_open();
+
+  if (oSymTable != NULL && sTrace.psFile != NULL) {
+    uNumber = Trace_findObject(sTrace.oTables, oSymTable, iFree);
+    if (uNumber == 0) {
+      uNumber = Trace_addObject(sTrace.oTables, &sTrace.uTableCount,
+                                oSymTable) + 1;
+      if (iFree)
+        (void)Trace_findObject(sTrace.oTables, oSymTable, 1);
+      if (sTrace.psFile != NULL) {
+        putc(TRACE_NEW, sTrace.psFile);
+        Trace_writeNumber(uNumber - 1);
+      }
+    }
+  }
+
+  if (sTrace.psFile == NULL) {
+    pthread_mutex_unlock(&sLock);
+    return 0;
+  }
+
+  putc(iOperation, sTrace.psFile);
+  if (oSymTable != NULL)
+    Trace_writeNumber(uNumber - 1);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* End the record that Trace_begin began, and unlock the recorder. */
+static void Trace_end(void) {
+  pthread_mutex_unlock(&sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Record the making of the table oSymTable by a call of iOperation,
+   with the capacity uCapacity if iOperation is
+   TRACE_NEW_WITH_CAPACITY. */
+static void Trace_recordNew(int iOperation, SymTable_T oSymTable,
+  size_t uCapacity)
+{
+  /* The number of the table. */
+  size_t uNumber;
+
+  pthread_mutex_lock(&sLock);
+  if (! sTrace.iOpened)
+    Trace_open();
+
+  if (sTrace.psFile != NULL) {
+    uNumber = Trace_addObject(sTrace.oTables, &sTrace.uTableCount,
+                              oSymTable);
+    if (sTrace.psFile != NULL) {
+      putc(iOperation, sTrace.psFile);
+      Trace_writeNumber(uNumber);
+      if (iOperation == TRACE_NEW_WITH_CAPACITY)
+        Trace_writeNumber(uCapacity);
+    }
+  }
+
+  pthread_mutex_unlock(&sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Record a call of iOperation on the iterator oIter, forgetting its
+   address if iOperation is TRACE_ITER_END. An iterator that the
+   recorder has never seen begun is not recorded. */
+static void Trace_recordIter(int iOperation, SymTableIter_T oIter) {
+  /* The number plus one of the iterator. */
+  size_t uNumber;
+
+  pthread_mutex_lock(&sLock);
+
+  if (sTrace.psFile != NULL) {
+    uNumber = Trace_findObject(sTrace.oIters, oIter,
+                               iOperation == TRACE_ITER_END);
+    if (uNumber != 0) {
+      putc(iOperation, sTrace.psFile);
+      Trace_writeNumber(uNumber - 1);
+    }
+  }
+
+  pthread_mutex_unlock(&sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T __wrap_SymTable_new(void) {
+  /* The new table. */
+  SymTable_T oSymTable = __real_SymTable_new();
+
+  if (oSymTable != NULL)
+    Trace_recordNew(TRACE_NEW, oSymTable, 0);
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T __wrap_SymTable_newWithCapacity(size_t uCapacity) {
+  /* The new table. */
+  SymTable_T oSymTable = __real_SymTable_newWithCapacity(uCapacity);
+
+  if (oSymTable != NULL)
+    Trace_recordNew(TRACE_NEW_WITH_CAPACITY, oSymTable, uCapacity);
+  return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_free(SymTable_T oSymTable) {
+  if (oSymTable != NULL && Trace_begin(TRACE_FREE, oSymTable, 1))
+    Trace_end();
+  __real_SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t __wrap_SymTable_getLength(SymTable_T oSymTable) {
+  if (Trace_begin(TRACE_GET_LENGTH, oSymTable, 0))
+    Trace_end();
+  return __real_SymTable_getLength(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_getStats(SymTable_T oSymTable,
+  struct SymTableStats *psStats)
+{
+  if (Trace_begin(TRACE_GET_STATS, oSymTable, 0))
+    Trace_end();
+  __real_SymTable_getStats(oSymTable, psStats);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  if (Trace_begin(TRACE_RESERVE, oSymTable, 0)) {
+    Trace_writeNumber(uCapacity);
+    Trace_end();
+  }
+  return __real_SymTable_reserve(oSymTable, uCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_shrinkToFit(SymTable_T oSymTable) {
+  if (Trace_begin(TRACE_SHRINK_TO_FIT, oSymTable, 0))
+    Trace_end();
+  return __real_SymTable_shrinkToFit(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_put(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  if (Trace_begin(TRACE_PUT, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *__wrap_SymTable_replace(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  if (Trace_begin(TRACE_REPLACE, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_replace(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  if (Trace_begin(TRACE_CONTAINS, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_contains(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *__wrap_SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  if (Trace_begin(TRACE_GET, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_get(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_getBatch(SymTable_T oSymTable,
+  const char *const apcKeys[], size_t uCount, void *apvOut[])
+{
+  /* Incrementor over the keys. */
+  size_t u;
+
+  if (Trace_begin(TRACE_GET_BATCH, oSymTable, 0)) {
+    Trace_writeNumber(uCount);
+    for (u = 0; u < uCount; u++)
+      Trace_writeKey(apcKeys[u]);
+    Trace_end();
+  }
+  __real_SymTable_getBatch(oSymTable, apcKeys, uCount, apvOut);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *__wrap_SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  if (Trace_begin(TRACE_REMOVE, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_remove(oSymTable, pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void **__wrap_SymTable_getOrInsert(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue)
+{
+  if (Trace_begin(TRACE_GET_OR_INSERT, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_getOrInsert(oSymTable, pcKey, pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_upsertWith(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue,
+  void *(*pfCombine)(const char *pcKey, void *pvOldValue,
+                     void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  if (Trace_begin(TRACE_UPSERT_WITH, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_upsertWith(oSymTable, pcKey, pvValue,
+                                    pfCombine, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t __wrap_SymTable_hashKey(const char *pcKey) {
+  if (Trace_begin(TRACE_HASH_KEY, NULL, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_hashKey(pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey, const void *pvValue)
+{
+  if (Trace_begin(TRACE_PUT_HASHED, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_putHashed(oSymTable, pcKey, uHashKey,
+                                   pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  if (Trace_begin(TRACE_CONTAINS_HASHED, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_containsHashed(oSymTable, pcKey, uHashKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *__wrap_SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, size_t uHashKey)
+{
+  if (Trace_begin(TRACE_GET_HASHED, oSymTable, 0)) {
+    Trace_writeKey(pcKey);
+    Trace_end();
+  }
+  return __real_SymTable_getHashed(oSymTable, pcKey, uHashKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_map(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  if (Trace_begin(TRACE_MAP, oSymTable, 0))
+    Trace_end();
+  __real_SymTable_map(oSymTable, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  void *const apvExtras[], size_t uThreadCount)
+{
+  if (Trace_begin(TRACE_MAP_PARALLEL, oSymTable, 0)) {
+    Trace_writeNumber(uThreadCount);
+    Trace_end();
+  }
+  __real_SymTable_mapParallel(oSymTable, pfApply, apvExtras,
+                              uThreadCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTableIter_T __wrap_SymTable_iterBegin(SymTable_T oSymTable) {
+  /* The new iterator. */
+  SymTableIter_T oIter = __real_SymTable_iterBegin(oSymTable);
+
+  /* Its number. */
+  size_t uNumber;
+
+  if (oIter != NULL && Trace_begin(TRACE_ITER_BEGIN, oSymTable, 0)) {
+    uNumber = Trace_addObject(sTrace.oIters, &sTrace.uIterCount, oIter);
+    Trace_writeNumber(uNumber);
+    Trace_end();
+  }
+  return oIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_iterNext(SymTableIter_T oIter,
+  const char **ppcKey, void **ppvValue)
+{
+  Trace_recordIter(TRACE_ITER_NEXT, oIter);
+  return __real_SymTable_iterNext(oIter, ppcKey, ppvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+void __wrap_SymTable_iterEnd(SymTableIter_T oIter) {
+  Trace_recordIter(TRACE_ITER_END, oIter);
+  __real_SymTable_iterEnd(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t __wrap_SymTable_scan(SymTable_T oSymTable, size_t uCursor,
+  size_t uBudget,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  if (Trace_begin(TRACE_SCAN, oSymTable, 0)) {
+    Trace_writeNumber(uCursor);
+    Trace_writeNumber(uBudget);
+    Trace_end();
+  }
+  return __real_SymTable_scan(oSymTable, uCursor, uBudget, pfApply,
+                              pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_mapPrefix(SymTable_T oSymTable,
+  const char *pcPrefix,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  if (Trace_begin(TRACE_MAP_PREFIX, oSymTable, 0)) {
+    Trace_writeKey(pcPrefix);
+    Trace_end();
+  }
+  return __real_SymTable_mapPrefix(oSymTable, pcPrefix, pfApply,
+                                   pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+int __wrap_SymTable_mapRange(SymTable_T oSymTable,
+  const char *pcLow, const char *pcHigh,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra)
+{
+  if (Trace_begin(TRACE_MAP_RANGE, oSymTable, 0)) {
+    Trace_writeKey(pcLow);
+    Trace_writeKey(pcHigh);
+    Trace_end();
+  }
+  return __real_SymTable_mapRange(oSymTable, pcLow, pcHigh, pfApply,
+                                  pvExtra);
+}
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------*/
+/* symtabletrace.h                                                    */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLETRACE_INCLUDED
+#define SYMTABLETRACE_INCLUDED
+
+/* A trace records the calls that a program makes of the SymTable ADT,
+   so that replaysymtable can make them again on any implementation.
+   symtabletrace.c writes one when it is linked into a program with
+   -Wl,--wrap for each function of symtable.h, as the Makefile's
+   TRACE_WRAP does: each call is then written to the file named by the
+   environment variable SYMTABLE_TRACE, or to symtable.trace, before
+   it is passed on. Values are not recorded, since they are pointers
+   into the recording process.
+
+   A trace is the 8 characters "SYMTRACE", a version byte, and then
+   one record per call: an operation byte, one of the enumerators
+   below, followed by its fields. Each field is a number, written as
+   an unsigned LEB128 varint (7 bits per byte, low bits first, the high
+   bit set on every byte but the last), or a key. A key is a number r:
+   0 for a NULL pointer, r for the r-th distinct key of the trace, or,
+   the first time a key appears, one more than the number of keys so
+   far, followed by the key's length and its characters. Tables and
+   iterators are numbered 0, 1, 2, ... in the order in which they are
+   created, and are named by their numbers. */
+
+/*--------------------------------------------------------------------*/
+
+/* The version of the format described above. */
+enum {TRACE_VERSION = 1};
+
+/* The operations, with the fields that follow each. A table field is
+   a number, as are capacity, count, threads, cursor and budget. */
+enum {
+  TRACE_NEW,                /* table */
+  TRACE_NEW_WITH_CAPACITY,  /* table, capacity */
+  TRACE_FREE,               /* table */
+  TRACE_GET_LENGTH,         /* table */
+  TRACE_GET_STATS,          /* table */
+  TRACE_RESERVE,            /* table, capacity */
+  TRACE_SHRINK_TO_FIT,      /* table */
+  TRACE_PUT,                /* table, key */
+  TRACE_REPLACE,            /* table, key */
+  TRACE_CONTAINS,           /* table, key */
+  TRACE_GET,                /* table, key */
+  TRACE_GET_BATCH,          /* table, count, count keys */
+  TRACE_REMOVE,             /* table, key */
+  TRACE_GET_OR_INSERT,      /* table, key */
+  TRACE_UPSERT_WITH,        /* table, key */
+  TRACE_HASH_KEY,           /* key */
+  TRACE_PUT_HASHED,         /* table, key */
+  TRACE_CONTAINS_HASHED,    /* table, key */
+  TRACE_GET_HASHED,         /* table, key */
+  TRACE_MAP,                /* table */
+  TRACE_MAP_PARALLEL,       /* table, threads */
+  TRACE_ITER_BEGIN,         /* table, iterator */
+  TRACE_ITER_NEXT,          /* iterator */
+  TRACE_ITER_END,           /* iterator */
+  TRACE_SCAN,               /* table, cursor, budget */
+  TRACE_MAP_PREFIX,         /* table, prefix key */
+  TRACE_MAP_RANGE,          /* table, low key, high key */
+  TRACE_OPERATIONS
+};
+
+#endif
@@ -83,6 +83,33 @@ static void printBindingSimple(const char *pcKey, void *pvValue,
 
 /*--------------------------------------------------------------------*/
 
+/* Increment the count of bindings at pvExtra. pcKey and pvValue are
+   unused. */
+
+static void countBindings(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   (void)pvValue;
+
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the visit count, an int, at pvValue and the count of the
+   calling thread, a long, at pvExtra. pcKey is unused. */
+
+static void countVisit(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+
+   (*(int*)pvValue)++;
+   (*(long*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the most basic SymTable functions. */
 
 static void testBasics(void)
@@ -431,6 +458,94 @@ static void testMap(void)
 
 /*--------------------------------------------------------------------*/
 
+/* TEST_LOCKED_WALKS is defined for the sharded table, whose walks hold
+   a shard's lock, so that their thread must not call into the table
+   until they end. */
+
+#ifndef TEST_LOCKED_WALKS
+
+/* A table walked by lookupVisit, and the number of its bindings that
+   were visited with the wrong value. */
+
+struct LookupWalk
+{
+   SymTable_T oSymTable;
+   int iWrong;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the visit count, an int, at pvValue, after looking up
+   pcKey and a missing key in the table of the struct LookupWalk at
+   pvExtra, whose count of wrong bindings grows if pcKey is not bound
+   to pvValue. */
+
+static void lookupVisit(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct LookupWalk *psWalk = (struct LookupWalk*)pvExtra;
+
+   if (SymTable_get(psWalk->oSymTable, pcKey) != pvValue ||
+       SymTable_contains(psWalk->oSymTable, "missing"))
+      psWalk->iWrong++;
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that SymTable_map() visits each binding once when pfApply
+   looks up the table it walks, at sizes around those at which a
+   table resizes. */
+
+static void testMapLookups(void)
+{
+   enum {KEY_COUNT = 1100};
+   static int aiVisits[KEY_COUNT];
+   struct LookupWalk sWalk;
+   char acKey[32];
+   int iSuccessful;
+   int iPower = 1;
+   int iBound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_map() with lookups in pfApply.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sWalk.oSymTable = SymTable_new();
+   ASSURE(sWalk.oSymTable != NULL);
+   sWalk.iWrong = 0;
+   for (iBound = 0; iBound < KEY_COUNT; iBound++)
+   {
+      sprintf(acKey, "key%d", iBound);
+      iSuccessful = SymTable_put(sWalk.oSymTable, acKey,
+         &aiVisits[iBound]);
+      ASSURE(iSuccessful);
+
+      /* Walk the table at the 32 sizes from each power of two, while
+         a resize may be under way. */
+      if (iBound + 1 == 2 * iPower)
+         iPower *= 2;
+      if (iBound + 1 - iPower >= 32)
+         continue;
+      SymTable_map(sWalk.oSymTable, lookupVisit, &sWalk);
+      for (i = 0; i <= iBound; i++)
+      {
+         if (aiVisits[i] != 1)
+            sWalk.iWrong++;
+         aiVisits[i] = 0;
+      }
+   }
+   ASSURE(sWalk.iWrong == 0);
+
+   SymTable_free(sWalk.oSymTable);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
 /* Test a SymTable object that contains no bindings. */
 
 static void testEmptyTable(void)
@@ -696,166 +811,1678 @@ static void testTableOfTables(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to handle collisions.  This
-   test assumes that a SymTable object is implemented as a hash table,
-   that there are 509 buckets in the hash table, and that the
-   implementation uses the hash function provided in the assignment
-   specification. */
+/* Combine the old value pvOldValue of the binding with key pcKey with
+   the new value pvValue by keeping the longer of the two strings.
+   pvExtra points to a count of the calls, which is incremented. */
 
-static void testCollisions(void)
+static void *keepLonger(const char *pcKey, void *pvOldValue,
+   void *pvValue, void *pvExtra)
+{
+   ASSURE(pcKey != NULL);
+   (*(int*)pvExtra)++;
+   if (strlen((char*)pvValue) > strlen((char*)pvOldValue))
+      return pvValue;
+   return pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_getOrInsert() and SymTable_upsertWith()
+   functions, including across the growth of the SymTable. */
+
+static void testGetOrInsert(void)
 {
+   enum {KEY_COUNT = 2000};
    SymTable_T oSymTable;
-   int iSuccessful;
-   char acCenterField[] = "pitcher";
-   char acCatcher[] = "catcher";
-   char acFirstBase[] = "first base";
-   char acRightField[] = "second base";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acFirstBase[] = "First Base";
+   char acKey[32];
+   void **ppvValue;
    char *pcValue;
+   int aiValues[KEY_COUNT];
+   int iCalls = 0;
+   int iSuccessful;
+   int i;
 
    printf("------------------------------------------------------\n");
-   printf("Testing the collision handling of a SymTable object\n");
-   printf("assuming a hash table implementation, and assuming that\n");
-   printf("the implementation uses the hash function from the\n");
-   printf("assignment specification.\n");
+   printf("Testing the SymTable_getOrInsert() and\n");
+   printf("SymTable_upsertWith() functions.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
 
-   /* Note that strings "250", "469", "947", "1303", and "2016" hash
-      to the same bucket -- bucket 123. */
+   /* A missing key is inserted with the given value. */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Jeter", acShortstop);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acShortstop);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
 
-   iSuccessful = SymTable_put(oSymTable, "250", acCenterField);
-   ASSURE(iSuccessful);
+   /* A present key keeps its value. */
+   ppvValue = SymTable_getOrInsert(oSymTable, "Jeter", acFirstBase);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acShortstop);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
 
-   iSuccessful = SymTable_put(oSymTable, "469", acCatcher);
+   /* The value can be changed through the returned address. */
+   *ppvValue = acCenterField;
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acCenterField);
+
+   /* Inserting does not call the combining function. */
+   iSuccessful = SymTable_upsertWith(oSymTable, "Mantle", acFirstBase,
+      keepLonger, &iCalls);
    ASSURE(iSuccessful);
+   ASSURE(iCalls == 0);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acFirstBase);
 
-   iSuccessful = SymTable_put(oSymTable, "947", acFirstBase);
+   /* Updating stores the combined value. */
+   iSuccessful = SymTable_upsertWith(oSymTable, "Mantle", acShortstop,
+      keepLonger, &iCalls);
    ASSURE(iSuccessful);
+   ASSURE(iCalls == 1);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acFirstBase);
 
-   iSuccessful = SymTable_put(oSymTable, "1303", acRightField);
+   iSuccessful = SymTable_upsertWith(oSymTable, "Mantle", acCenterField,
+      keepLonger, &iCalls);
    ASSURE(iSuccessful);
+   ASSURE(iCalls == 2);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acCenterField);
 
-   iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
+   /* Insert enough keys to make the SymTable grow, writing each value
+      through the returned address before the next insertion. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ppvValue = SymTable_getOrInsert(oSymTable, acKey, NULL);
+      ASSURE(ppvValue != NULL);
+      ASSURE(*ppvValue == NULL);
+      *ppvValue = &aiValues[i];
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT + 2);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ppvValue = SymTable_getOrInsert(oSymTable, acKey, NULL);
+      ASSURE(ppvValue != NULL);
+      ASSURE(*ppvValue == &aiValues[i]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT + 2);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_hashKey(), SymTable_putHashed(),
+   SymTable_containsHashed(), and SymTable_getHashed() functions by
+   looking keys up through a chain of nested scopes. */
+
+static void testHashed(void)
+{
+   enum {SCOPE_COUNT = 3};
+   enum {KEY_COUNT = 2000};
+   SymTable_T aoScopes[SCOPE_COUNT];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acKey[32];
+   int aiValues[KEY_COUNT];
+   size_t uHashKey;
+   char *pcValue;
+   int iSuccessful;
+   int iScope;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_hashKey() and hashed lookup\n");
+   printf("functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+   {
+      aoScopes[iScope] = SymTable_new();
+      ASSURE(aoScopes[iScope] != NULL);
+   }
+
+   /* A token is the same for every table. */
+   uHashKey = SymTable_hashKey("Jeter");
+   ASSURE(uHashKey == SymTable_hashKey("Jeter"));
+
+   iSuccessful = SymTable_putHashed(aoScopes[0], "Jeter", uHashKey,
+      acShortstop);
    ASSURE(iSuccessful);
+   iSuccessful = SymTable_putHashed(aoScopes[0], "Jeter", uHashKey,
+      acCenterField);
+   ASSURE(! iSuccessful);
 
-   pcValue = SymTable_get(oSymTable, "250");
+   /* The key falls through the inner scopes to the outermost one. */
+   pcValue = NULL;
+   for (iScope = SCOPE_COUNT - 1; iScope >= 0; iScope--)
+      if (SymTable_containsHashed(aoScopes[iScope], "Jeter", uHashKey))
+      {
+         pcValue = (char*)SymTable_getHashed(aoScopes[iScope], "Jeter",
+            uHashKey);
+         break;
+      }
+   ASSURE(iScope == 0);
+   ASSURE(pcValue == acShortstop);
+
+   /* A binding in an inner scope shadows it. */
+   iSuccessful = SymTable_put(aoScopes[1], "Jeter", acCenterField);
+   ASSURE(iSuccessful);
+   ASSURE(! SymTable_containsHashed(aoScopes[2], "Jeter", uHashKey));
+   pcValue = (char*)SymTable_getHashed(aoScopes[1], "Jeter", uHashKey);
    ASSURE(pcValue == acCenterField);
 
-   pcValue = SymTable_get(oSymTable, "469");
-   ASSURE(pcValue == acCatcher);
+   /* Hashed and unhashed calls agree across the growth of a table. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      uHashKey = SymTable_hashKey(acKey);
+      iSuccessful = SymTable_putHashed(aoScopes[2], acKey, uHashKey,
+         &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      uHashKey = SymTable_hashKey(acKey);
+      ASSURE(SymTable_get(aoScopes[2], acKey) == &aiValues[i]);
+      ASSURE(SymTable_getHashed(aoScopes[2], acKey, uHashKey)
+         == &aiValues[i]);
+      ASSURE(! SymTable_containsHashed(aoScopes[0], acKey, uHashKey));
+   }
+   ASSURE(SymTable_getLength(aoScopes[2]) == KEY_COUNT);
 
-   pcValue = SymTable_get(oSymTable, "947");
-   ASSURE(pcValue == acFirstBase);
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+      SymTable_free(aoScopes[iScope]);
+}
 
-   pcValue = SymTable_get(oSymTable, "1303");
-   ASSURE(pcValue == acRightField);
+/*--------------------------------------------------------------------*/
 
-   pcValue = SymTable_get(oSymTable, "2016");
-   ASSURE(pcValue == acRightField);
+/* Test the SymTable_getBatch() function with batches of various
+   sizes, mixing keys that are present with keys that are not. */
 
-   pcValue = SymTable_remove(oSymTable, "947");
-   ASSURE(pcValue == acFirstBase);
+static void testGetBatch(void)
+{
+   enum {KEY_COUNT = 1000};
+   SymTable_T oSymTable;
+   char aacKeys[2 * KEY_COUNT][32];
+   const char *apcKeys[2 * KEY_COUNT];
+   void *apvOut[2 * KEY_COUNT];
+   int aiValues[KEY_COUNT];
+   size_t auCounts[] = {0, 1, 15, 16, 17, 2 * KEY_COUNT};
+   size_t uCountIndex;
+   size_t u;
+   int iSuccessful;
+   int i;
 
-   pcValue = SymTable_remove(oSymTable, "2016");
-   ASSURE(pcValue == acRightField);
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getBatch() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
 
-   pcValue = SymTable_remove(oSymTable, "250");
-   ASSURE(pcValue == acCenterField);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
 
-   pcValue = SymTable_get(oSymTable, "469");
-   ASSURE(pcValue == acCatcher);
+   /* Even-numbered keys are present and odd-numbered keys are not. */
+   for (i = 0; i < 2 * KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "key%d", i);
+      apcKeys[i] = aacKeys[i];
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i],
+            &aiValues[i / 2]);
+         ASSURE(iSuccessful);
+      }
+   }
 
-   pcValue = SymTable_get(oSymTable, "1303");
-   ASSURE(pcValue == acRightField);
+   for (uCountIndex = 0;
+        uCountIndex < sizeof(auCounts) / sizeof(auCounts[0]);
+        uCountIndex++)
+   {
+      for (u = 0; u < 2 * KEY_COUNT; u++)
+         apvOut[u] = &aiValues[0];
+      SymTable_getBatch(oSymTable, apcKeys, auCounts[uCountIndex],
+         apvOut);
+      for (u = 0; u < auCounts[uCountIndex]; u++)
+         ASSURE(apvOut[u] == SymTable_get(oSymTable, apcKeys[u]));
+      for (u = auCounts[uCountIndex]; u < 2 * KEY_COUNT; u++)
+         ASSURE(apvOut[u] == &aiValues[0]);
+   }
+
+   /* The same key may appear more than once in a batch. */
+   apcKeys[1] = apcKeys[0];
+   SymTable_getBatch(oSymTable, apcKeys, 2, apvOut);
+   ASSURE(apvOut[0] == &aiValues[0]);
+   ASSURE(apvOut[1] == &aiValues[0]);
 
    SymTable_free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to be large, that is, to
-   contain iBindingCount bindings. Write the time consumed to stdout. */
+/* Test the SymTable_newWithCapacity() and SymTable_reserve()
+   functions. */
 
-static void testLargeTable(int iBindingCount)
+static void testReserve(void)
 {
-   enum {MAX_KEY_LENGTH = 10};
-
+   enum {KEY_COUNT = 5000};
    SymTable_T oSymTable;
-   SymTable_T oSymTableSmall;
-   char acKey[MAX_KEY_LENGTH];
-   char *pcValue;
-   int i;
-   int iSmall;
-   int iLarge;
+   char acKey[32];
+   int aiValues[2 * KEY_COUNT];
    int iSuccessful;
-   clock_t iInitialClock;
-   clock_t iFinalClock;
-   size_t uLength = 0;
-   size_t uLength2;
+   int i;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a potentially large SymTable object.\n");
-   printf("No output except CPU time consumed should appear here:\n");
+   printf("Testing the SymTable_newWithCapacity() and\n");
+   printf("SymTable_reserve() functions.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
 
-   /* Note the current time. */
-   iInitialClock = clock();
+   /* A table with no room reserved behaves like a new one. */
+   oSymTable = SymTable_newWithCapacity(0);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "Jeter") == &aiValues[0]);
+   SymTable_free(oSymTable);
 
-   /* Create oSymTableSmall, and put a couple of bindings into it. */
-   oSymTableSmall = SymTable_new();
-   ASSURE(oSymTableSmall != NULL);
-   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   oSymTable = SymTable_newWithCapacity(KEY_COUNT);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Reserving less than is held changes nothing. */
+   iSuccessful = SymTable_reserve(oSymTable, 0);
    ASSURE(iSuccessful);
-   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+   iSuccessful = SymTable_reserve(oSymTable, KEY_COUNT / 2);
    ASSURE(iSuccessful);
 
-   /* Create oSymTable, the primary SymTable object. */
-   oSymTable = SymTable_new();
-   ASSURE(oSymTable != NULL);
+   /* Reserving more keeps every binding. */
+   iSuccessful = SymTable_reserve(oSymTable, 4 * KEY_COUNT);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+   }
 
-   /* Put iBindingCount new bindings into oSymTable.  Each binding's
-      key and value contain the same characters. */
-   for (i = 0; i < iBindingCount; i++)
+   for (i = KEY_COUNT; i < 2 * KEY_COUNT; i++)
    {
-      sprintf(acKey, "%d", i);
-      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
-      ASSURE(pcValue != NULL);
-      strcpy(pcValue, acKey);
-      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      sprintf(acKey, "key%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
       ASSURE(iSuccessful);
-      uLength = SymTable_getLength(oSymTable);
-      ASSURE(uLength == (size_t)(i+1));
+   }
+   for (i = 0; i < 2 * KEY_COUNT; i += 2)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
    }
 
-   /* Get each binding's value, and make sure that it contains
-      the same characters as its key. */
-   iSmall = 0;
-   iLarge = iBindingCount - 1;
-   while (iSmall < iLarge)
+   /* Reserving after removals keeps every remaining binding. */
+   iSuccessful = SymTable_reserve(oSymTable, 2 * KEY_COUNT);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+   for (i = 0; i < 2 * KEY_COUNT; i++)
    {
-      /* Get the smallest of the remaining bindings. */
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iSmall++;
-      /* Get the largest of the remaining bindings. */
-      sprintf(acKey, "%d", iLarge);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iLarge--;
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) ==
+         (i % 2 == 0 ? NULL : &aiValues[i]));
    }
-   /* Get the middle binding -- if there is one. */
-   if (iSmall == iLarge)
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the statistics of oSymTable, whose keys have uKeyBytes
+   bytes with their null characters, are consistent, and return its
+   resize count. */
+
+static size_t checkStats(SymTable_T oSymTable, size_t uKeyBytes)
+{
+   struct SymTableStats sStats;
+   size_t uChains = 0;
+   int i;
+
+   SymTable_getStats(oSymTable, &sStats);
+   ASSURE(sStats.uLength == SymTable_getLength(oSymTable));
+
+   /* Every bucket has one chain, counted once. */
+   for (i = 0; i < SYMTABLE_STATS_CHAINS; i++)
+      uChains += sStats.auChainCounts[i];
+   ASSURE(uChains == sStats.uBucketCount);
+   if (sStats.uBucketCount == 0)
    {
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      ASSURE(sStats.dLoadFactor == 0);
+      ASSURE(sStats.uLongestChain == 0);
+   }
+   else
+   {
+      ASSURE(sStats.dLoadFactor >= 0);
+      ASSURE(sStats.auChainCounts[
+         sStats.uLongestChain < SYMTABLE_STATS_CHAINS ?
+            sStats.uLongestChain : SYMTABLE_STATS_CHAINS - 1] != 0);
+   }
+
+   /* A tree stores shared key prefixes once. */
+   ASSURE(sStats.uKeyBytes <= uKeyBytes);
+   ASSURE((sStats.uKeyBytes == 0) == (uKeyBytes == 0));
+   return sStats.uResizeCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_getStats() function. */
+
+static void testStats(void)
+{
+   enum {KEY_COUNT = 5000};
+   static int aiValues[KEY_COUNT];
+   SymTable_T oSymTable;
+   char acKey[32];
+   size_t uKeyBytes = 0;
+   size_t uResizeCount;
+   size_t uLastResizeCount;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getStats() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   uLastResizeCount = checkStats(oSymTable, 0);
+   ASSURE(uLastResizeCount == 0);
+
+   /* The resize count never falls as the table grows and shrinks. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      uKeyBytes += strlen(acKey) + 1;
+      if (i % 499 == 0)
+      {
+         uResizeCount = checkStats(oSymTable, uKeyBytes);
+         ASSURE(uResizeCount >= uLastResizeCount);
+         uLastResizeCount = uResizeCount;
+      }
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      uKeyBytes -= strlen(acKey) + 1;
+      if (i % 499 == 0)
+      {
+         uResizeCount = checkStats(oSymTable, uKeyBytes);
+         ASSURE(uResizeCount >= uLastResizeCount);
+         uLastResizeCount = uResizeCount;
+      }
+   }
+   (void)checkStats(oSymTable, 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_PROFILE
+
+/* Read the dump of oSymTable's profile, and assure that its line for
+   the operation pcOperation reports ulCalls calls, ulHits of which
+   found their key, each after probing at least one binding. The calls
+   of each operation are made in a row, more of them than the default
+   sampling period, so at least one of them is timed. */
+
+static void checkProfile(SymTable_T oSymTable, const char *pcOperation,
+   unsigned long ulCalls, unsigned long ulHits)
+{
+   FILE *psFile;
+   char acLine[256];
+   char acOperation[16];
+   unsigned long ulReadCalls;
+   unsigned long ulReadHits;
+   unsigned long ulReadMisses;
+   unsigned long ulTimed;
+   double dProbes;
+   double dCompares;
+   int iFound = 0;
+
+   psFile = tmpfile();
+   ASSURE(psFile != NULL);
+   if (psFile == NULL)
+      return;
+   SymTable_dumpProfile(oSymTable, psFile);
+   rewind(psFile);
+
+   while (fgets(acLine, (int)sizeof(acLine), psFile) != NULL)
+   {
+      if (sscanf(acLine, "%15[a-z]: %lu calls, %lu hits, %lu misses, "
+                 "%lf probes/call, %lf compares/call", acOperation,
+                 &ulReadCalls, &ulReadHits, &ulReadMisses, &dProbes,
+                 &dCompares) != 6 ||
+          strcmp(acOperation, pcOperation) != 0)
+         continue;
+      iFound = 1;
+      ASSURE(ulReadCalls == ulCalls);
+      ASSURE(ulReadHits == ulHits);
+      ASSURE(ulReadMisses == ulCalls - ulHits);
+      ASSURE(dProbes >= (double)ulHits / (double)ulCalls - 0.01);
+      ASSURE(dCompares > 0.0);
+
+      /* The latency summary follows. */
+      ASSURE(fgets(acLine, (int)sizeof(acLine), psFile) != NULL);
+      ASSURE(sscanf(acLine, " %lu timed", &ulTimed) == 1);
+      ASSURE(ulTimed >= 1 && ulTimed <= ulCalls);
+   }
+   ASSURE(iFound);
+
+   fclose(psFile);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the counts that a profiled build keeps of each table's
+   calls. */
+
+static void testProfile(void)
+{
+   enum {KEY_COUNT = 100};
+   enum {MISS_COUNT = 50};
+   SymTable_T oSymTable;
+   char acKey[32];
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the profile of a SymTable object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acKey));
+   }
+   for (i = 0; i < KEY_COUNT / 10; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(! SymTable_put(oSymTable, acKey, acKey));
+   }
+
+   for (i = 0; i < KEY_COUNT + MISS_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE((SymTable_get(oSymTable, acKey) != NULL) ==
+             (i < KEY_COUNT));
+   }
+
+   for (i = KEY_COUNT - 10; i < KEY_COUNT + 10; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE((SymTable_replace(oSymTable, acKey, acKey) != NULL) ==
+             (i < KEY_COUNT));
+   }
+
+   for (i = 0; i < KEY_COUNT; i += 4)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) != NULL);
+      ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+   }
+
+   /* Lookups that are not profiled leave the counts alone. */
+   ASSURE(SymTable_contains(oSymTable, "key1"));
+
+   checkProfile(oSymTable, "put", KEY_COUNT + KEY_COUNT / 10,
+                KEY_COUNT / 10);
+   checkProfile(oSymTable, "get", KEY_COUNT + MISS_COUNT, KEY_COUNT);
+   checkProfile(oSymTable, "replace", 20, 10);
+   checkProfile(oSymTable, "remove", KEY_COUNT / 2, KEY_COUNT / 4);
+
+   SymTable_free(oSymTable);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a SymTable object keeps its bindings when mass removals
+   shrink it and when SymTable_shrinkToFit() is called. */
+
+static void testShrink(void)
+{
+   enum {KEY_COUNT = 5000};
+   SymTable_T oSymTable;
+   char acKey[32];
+   int *piValues;
+   int iSuccessful;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing shrinking and SymTable_shrinkToFit().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piValues = (int*)malloc(sizeof(int) * KEY_COUNT);
+   ASSURE(piValues != NULL);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table can be shrunk. */
+   iSuccessful = SymTable_shrinkToFit(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   /* Grow the table, then remove all but every 100th binding, twice,
+      checking the survivors after each round. */
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &piValues[i]);
+         ASSURE(iSuccessful == (iRound == 0 || i % 100 != 0));
+      }
+      ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+      for (i = 0; i < KEY_COUNT; i++)
+         if (i % 100 != 0)
+         {
+            sprintf(acKey, "key%d", i);
+            ASSURE(SymTable_remove(oSymTable, acKey) == &piValues[i]);
+         }
+      ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT / 100);
+
+      if (iRound == 1)
+      {
+         iSuccessful = SymTable_shrinkToFit(oSymTable);
+         ASSURE(iSuccessful);
+      }
+
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) ==
+            (i % 100 == 0 ? &piValues[i] : NULL));
+      }
+   }
+
+   /* A shrunken table still grows. */
+   for (i = 0; i < KEY_COUNT; i++)
+      if (i % 100 != 0)
+      {
+         sprintf(acKey, "key%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &piValues[i]);
+         ASSURE(iSuccessful);
+      }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &piValues[i]);
+   }
+
+   SymTable_free(oSymTable);
+   free(piValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test many SymTable objects with few bindings each, as for the
+   scopes of a program, and a SymTable object whose length crosses
+   the number of bindings that a small table holds. */
+
+static void testSmallTables(void)
+{
+   enum {TABLE_COUNT = 1000};
+   enum {KEY_COUNT = 40};
+   SymTable_T aoSymTables[TABLE_COUNT];
+   SymTable_T oSymTable;
+   char acKey[32];
+   int aiValues[KEY_COUNT];
+   int iCount;
+   int iCycle;
+   int iSuccessful;
+   int iTable;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing many small SymTable objects.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      aoSymTables[iTable] = SymTable_new();
+      ASSURE(aoSymTables[iTable] != NULL);
+      for (i = 0; i < iTable % 4; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         iSuccessful = SymTable_put(aoSymTables[iTable], acKey,
+            &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+   }
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      ASSURE(SymTable_getLength(aoSymTables[iTable])
+         == (size_t)(iTable % 4));
+      for (i = 0; i < 4; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_get(aoSymTables[iTable], acKey) ==
+            (i < iTable % 4 ? &aiValues[i] : NULL));
+      }
+      SymTable_free(aoSymTables[iTable]);
+   }
+
+   /* Grow one binding at a time, checking every binding each time. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      for (iCount = 0; iCount <= i; iCount++)
+      {
+         sprintf(acKey, "key%d", iCount);
+         ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[iCount]);
+      }
+      iCount = 0;
+      SymTable_map(oSymTable, countBindings, &iCount);
+      ASSURE(iCount == i + 1);
+   }
+
+   /* Shrink it one binding at a time, removing from the middle. */
+   for (i = KEY_COUNT - 1; i >= 0; i--)
+   {
+      sprintf(acKey, "key%d", (i * 7) % KEY_COUNT);
+      ASSURE(SymTable_remove(oSymTable, acKey) ==
+         &aiValues[(i * 7) % KEY_COUNT]);
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)i);
+      if (i % 5 == 0)
+      {
+         iSuccessful = SymTable_shrinkToFit(oSymTable);
+         ASSURE(iSuccessful);
+      }
+      iCount = 0;
+      SymTable_map(oSymTable, countBindings, &iCount);
+      ASSURE(iCount == i);
+   }
+
+   /* Grow and shrink it repeatedly by removals alone, so that it
+      crosses between the small and the hashed forms in both
+      directions, mixing plain and pre-hashed lookups. */
+   for (iCycle = 0; iCycle < 3; iCycle++)
+   {
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         iSuccessful = SymTable_putHashed(oSymTable, acKey,
+            SymTable_hashKey(acKey), &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+      for (i = KEY_COUNT - 1; i >= iCycle; i--)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+         for (iCount = 0; iCount < KEY_COUNT; iCount++)
+         {
+            sprintf(acKey, "key%d", iCount);
+            ASSURE(SymTable_getHashed(oSymTable, acKey,
+               SymTable_hashKey(acKey)) ==
+               (iCount < i ? &aiValues[iCount] : NULL));
+            ASSURE(SymTable_contains(oSymTable, acKey) ==
+               (iCount < i));
+         }
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iCycle);
+      for (i = 0; i < iCycle; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      }
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Visit every binding of oSymTable, whose values are the first
+   iBound elements of aiVisits, with SymTable_mapParallel on 1, 2, 4,
+   and 8 threads. Each binding must be visited once per walk, and the
+   per-thread counts must add up to the length. */
+
+static void checkMapParallel(SymTable_T oSymTable, int aiVisits[],
+   int iBound)
+{
+   enum {MAX_THREADS = 8};
+   long alCounts[MAX_THREADS];
+   void *apvExtras[MAX_THREADS];
+   size_t uThreads;
+   long lTotal;
+   int iWrong;
+   int i;
+
+   for (uThreads = 1; uThreads <= MAX_THREADS; uThreads *= 2)
+   {
+      for (i = 0; i < MAX_THREADS; i++)
+      {
+         alCounts[i] = 0;
+         apvExtras[i] = &alCounts[i];
+      }
+      SymTable_mapParallel(oSymTable, countVisit, apvExtras, uThreads);
+
+      lTotal = 0;
+      for (i = 0; i < MAX_THREADS; i++)
+      {
+         ASSURE((size_t)i < uThreads || alCounts[i] == 0);
+         lTotal += alCounts[i];
+      }
+      ASSURE(lTotal == (long)iBound);
+
+      iWrong = 0;
+      for (i = 0; i < iBound; i++)
+      {
+         if (aiVisits[i] != 1)
+            iWrong++;
+         aiVisits[i] = 0;
+      }
+      ASSURE(iWrong == 0);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_mapParallel() function. */
+
+static void testMapParallel(void)
+{
+   enum {KEY_COUNT = 5000};
+   static int aiVisits[KEY_COUNT];
+   static const int aiSizes[] = {0, 1, 10, 100, 1000, KEY_COUNT};
+   SymTable_T oSymTable;
+   char acKey[32];
+   int iSuccessful;
+   int iBound;
+   int iSize;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapParallel() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Grow the table through each size, walking it at each. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iBound = 0;
+   for (iSize = 0; iSize < (int)(sizeof(aiSizes) / sizeof(aiSizes[0]));
+        iSize++)
+   {
+      for (; iBound < aiSizes[iSize]; iBound++)
+      {
+         sprintf(acKey, "key%d", iBound);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+            &aiVisits[iBound]);
+         ASSURE(iSuccessful);
+      }
+      checkMapParallel(oSymTable, aiVisits, iBound);
+   }
+
+   /* Remove most bindings, shrinking the table, and walk the rest. */
+   for (; iBound > KEY_COUNT / 8; iBound--)
+   {
+      sprintf(acKey, "key%d", iBound - 1);
+      ASSURE(SymTable_remove(oSymTable, acKey) ==
+         &aiVisits[iBound - 1]);
+   }
+   checkMapParallel(oSymTable, aiVisits, iBound);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Visit every binding of oSymTable, whose values are the first iBound
+   elements of aiVisits and whose keys are "key0", "key1", ..., with
+   an iterator. Each binding must be visited once, with its own key.
+   Then stop a second iterator at the binding of key number iBound / 2,
+   which must be found. */
+
+static void checkIterator(SymTable_T oSymTable, int aiVisits[],
+   int iBound)
+{
+   SymTableIter_T oIter;
+   const char *pcKey;
+   void *pvValue;
+   char acKey[32];
+   int iCount;
+   int iWrong;
+   int i;
+
+   oIter = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter != NULL);
+   iCount = 0;
+   iWrong = 0;
+   while (SymTable_iterNext(oIter, &pcKey, &pvValue))
+   {
+      sprintf(acKey, "key%d", (int)((int*)pvValue - aiVisits));
+      if (strcmp(pcKey, acKey) != 0)
+         iWrong++;
+      (*(int*)pvValue)++;
+      iCount++;
+   }
+   ASSURE(! SymTable_iterNext(oIter, NULL, NULL));
+   SymTable_iterEnd(oIter);
+   ASSURE(iCount == iBound);
+
+   for (i = 0; i < iBound; i++)
+   {
+      if (aiVisits[i] != 1)
+         iWrong++;
+      aiVisits[i] = 0;
+   }
+   ASSURE(iWrong == 0);
+
+   /* Stop early, as a search for one binding does. */
+   if (iBound == 0)
+      return;
+   oIter = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter != NULL);
+   while (SymTable_iterNext(oIter, NULL, &pvValue) &&
+          pvValue != &aiVisits[iBound / 2])
+      ;
+   ASSURE(pvValue == &aiVisits[iBound / 2]);
+   SymTable_iterEnd(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_iterBegin(), SymTable_iterNext(), and
+   SymTable_iterEnd() functions. */
+
+static void testIterator(void)
+{
+   enum {KEY_COUNT = 5000};
+   static int aiVisits[KEY_COUNT];
+   static const int aiSizes[] = {0, 1, 10, 100, 1000, KEY_COUNT};
+   SymTable_T oSymTable;
+   char acKey[32];
+   int iSuccessful;
+   int iBound;
+   int iSize;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable iterator functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Grow the table through each size, walking it at each. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iBound = 0;
+   for (iSize = 0; iSize < (int)(sizeof(aiSizes) / sizeof(aiSizes[0]));
+        iSize++)
+   {
+      for (; iBound < aiSizes[iSize]; iBound++)
+      {
+         sprintf(acKey, "key%d", iBound);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+            &aiVisits[iBound]);
+         ASSURE(iSuccessful);
+      }
+      checkIterator(oSymTable, aiVisits, iBound);
+   }
+
+   /* Remove bindings, shrinking the table, walking it now and then. */
+   for (; iBound > 0; iBound--)
+   {
+      if (iBound % 701 == 0)
+         checkIterator(oSymTable, aiVisits, iBound);
+      sprintf(acKey, "key%d", iBound - 1);
+      ASSURE(SymTable_remove(oSymTable, acKey) ==
+         &aiVisits[iBound - 1]);
+   }
+   checkIterator(oSymTable, aiVisits, 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifndef TEST_LOCKED_WALKS
+
+/* Test that an iterator visits each binding once when the table it
+   walks is looked up between calls of SymTable_iterNext(), at sizes
+   around those at which a table resizes. */
+
+static void testIteratorLookups(void)
+{
+   enum {KEY_COUNT = 1100};
+   static int aiVisits[KEY_COUNT];
+   SymTable_T oSymTable;
+   SymTableIter_T oIter;
+   const char *pcKey;
+   void *pvValue;
+   char acKey[32];
+   int iSuccessful;
+   int iPower = 1;
+   int iWrong = 0;
+   int iBound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing an iterator with lookups between its calls.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (iBound = 0; iBound < KEY_COUNT; iBound++)
+   {
+      sprintf(acKey, "key%d", iBound);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[iBound]);
+      ASSURE(iSuccessful);
+
+      /* Walk the table at the 32 sizes from each power of two, while
+         a resize may be under way. */
+      if (iBound + 1 == 2 * iPower)
+         iPower *= 2;
+      if (iBound + 1 - iPower >= 32)
+         continue;
+      oIter = SymTable_iterBegin(oSymTable);
+      ASSURE(oIter != NULL);
+      while (SymTable_iterNext(oIter, &pcKey, &pvValue))
+      {
+         if (SymTable_get(oSymTable, pcKey) != pvValue ||
+             SymTable_contains(oSymTable, "missing"))
+            iWrong++;
+         (*(int*)pvValue)++;
+      }
+      SymTable_iterEnd(oIter);
+      for (i = 0; i <= iBound; i++)
+      {
+         if (aiVisits[i] != 1)
+            iWrong++;
+         aiVisits[i] = 0;
+      }
+   }
+   ASSURE(iWrong == 0);
+
+   SymTable_free(oSymTable);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test that the walks of a table with far more room reserved than it
+   holds visit each binding once as bindings come and go. */
+
+static void testSparseTable(void)
+{
+   enum {CAPACITY = 200000};
+   enum {KEY_COUNT = 100};
+   static int aiVisits[KEY_COUNT];
+   SymTable_T oSymTable;
+   char acKey[32];
+   int iSuccessful;
+   int iCount;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a sparse SymTable object.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithCapacity(CAPACITY);
+   ASSURE(oSymTable != NULL);
+   checkIterator(oSymTable, aiVisits, 0);
+
+   for (iRound = 0; iRound < 3; iRound++)
+   {
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+         ASSURE(iSuccessful);
+      }
+      checkIterator(oSymTable, aiVisits, KEY_COUNT);
+      checkMapParallel(oSymTable, aiVisits, KEY_COUNT);
+      iCount = 0;
+      SymTable_map(oSymTable, countBindings, &iCount);
+      ASSURE(iCount == KEY_COUNT);
+
+      /* Emptied buckets must no longer be walked. */
+      for (i = KEY_COUNT - 1; i >= KEY_COUNT / 2; i--)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiVisits[i]);
+      }
+      checkIterator(oSymTable, aiVisits, KEY_COUNT / 2);
+      for (i = KEY_COUNT / 2 - 1; i >= 0; i--)
+      {
+         sprintf(acKey, "key%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiVisits[i]);
+      }
+      iCount = 0;
+      SymTable_map(oSymTable, countBindings, &iCount);
+      ASSURE(iCount == 0);
+      checkIterator(oSymTable, aiVisits, 0);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that each of the first iBound elements of aiVisits is at
+   least iMin and, unless iExact is 0, no more, and reset them to 0. */
+
+static void checkVisits(int aiVisits[], int iBound, int iMin,
+   int iExact)
+{
+   int iWrong = 0;
+   int i;
+
+   for (i = 0; i < iBound; i++)
+   {
+      if (aiVisits[i] < iMin || (iExact && aiVisits[i] > iMin))
+         iWrong++;
+      aiVisits[i] = 0;
+   }
+   ASSURE(iWrong == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_scan() function. */
+
+static void testScan(void)
+{
+   enum {STABLE_COUNT = 1000};
+   enum {KEY_COUNT = 5000};
+   enum {MAX_CALLS = 1000000};
+   static int aiVisits[KEY_COUNT];
+   static const size_t auBudgets[] = {1, 7, KEY_COUNT};
+   SymTable_T oSymTable;
+   SymTable_T oPrefixTable;
+   char acKey[32];
+   size_t uCursor;
+   long lCount;
+   int iSuccessful;
+   int iBound;
+   int iCalls;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_scan() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table is scanned in one call with a large budget. */
+   lCount = 0;
+   ASSURE(SymTable_scan(oSymTable, 0, KEY_COUNT, countVisit, &lCount)
+      == 0);
+   ASSURE(lCount == 0);
+
+   for (iBound = 0; iBound < STABLE_COUNT; iBound++)
+   {
+      sprintf(acKey, "key%d", iBound);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[iBound]);
+      ASSURE(iSuccessful);
+   }
+
+   /* An unchanged table yields each binding once, whatever the
+      budget. */
+   for (i = 0; i < (int)(sizeof(auBudgets) / sizeof(auBudgets[0])); i++)
+   {
+      uCursor = 0;
+      lCount = 0;
+      iCalls = 0;
+      do
+         uCursor = SymTable_scan(oSymTable, uCursor, auBudgets[i],
+            countVisit, &lCount);
+      while (uCursor != 0 && ++iCalls < MAX_CALLS);
+      ASSURE(lCount == STABLE_COUNT);
+      checkVisits(aiVisits, STABLE_COUNT, 1, 1);
+   }
+
+   /* Keys that share a long prefix still take many calls with a
+      budget of 1. */
+   oPrefixTable = SymTable_new();
+   ASSURE(oPrefixTable != NULL);
+   for (i = 0; i < STABLE_COUNT; i++)
+   {
+      sprintf(acKey, "identifier_%d", i);
+      iSuccessful = SymTable_put(oPrefixTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+   lCount = 0;
+   uCursor = SymTable_scan(oPrefixTable, 0, 1, countVisit, &lCount);
+   ASSURE(uCursor != 0);
+   ASSURE(lCount < STABLE_COUNT / 10);
+   iCalls = 0;
+   while (uCursor != 0 && ++iCalls < MAX_CALLS)
+      uCursor = SymTable_scan(oPrefixTable, uCursor, 1, countVisit,
+         &lCount);
+   ASSURE(lCount == STABLE_COUNT);
+   checkVisits(aiVisits, STABLE_COUNT, 1, 1);
+
+   /* A scan goes on after many other scans of the same table. */
+   uCursor = SymTable_scan(oPrefixTable, 0, STABLE_COUNT / 2,
+      countVisit, &lCount);
+   for (i = 0; i < 8; i++)
+      ASSURE(SymTable_scan(oPrefixTable, 0, 1, countVisit, &lCount)
+         != 0);
+   iCalls = 0;
+   while (uCursor != 0 && ++iCalls < MAX_CALLS)
+      uCursor = SymTable_scan(oPrefixTable, uCursor, 7, countVisit,
+         &lCount);
+   checkVisits(aiVisits, STABLE_COUNT, 1, 0);
+   SymTable_free(oPrefixTable);
+
+   /* Grow the table between calls, so that it resizes during the
+      scan. The bindings present throughout must all be visited. */
+   uCursor = 0;
+   iCalls = 0;
+   do
+   {
+      uCursor = SymTable_scan(oSymTable, uCursor, 2, countVisit,
+         &lCount);
+      for (i = 0; i < 8 && iBound < KEY_COUNT; i++, iBound++)
+      {
+         sprintf(acKey, "key%d", iBound);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+            &aiVisits[iBound]);
+         ASSURE(iSuccessful);
+      }
+   } while (uCursor != 0 && ++iCalls < MAX_CALLS);
+   checkVisits(aiVisits, STABLE_COUNT, 1, 0);
+   checkVisits(aiVisits + STABLE_COUNT, iBound - STABLE_COUNT, 0, 0);
+
+   /* Shrink it between calls. */
+   uCursor = 0;
+   iCalls = 0;
+   do
+   {
+      uCursor = SymTable_scan(oSymTable, uCursor, 2, countVisit,
+         &lCount);
+      for (i = 0; i < 32 && iBound > STABLE_COUNT; i++, iBound--)
+      {
+         sprintf(acKey, "key%d", iBound - 1);
+         ASSURE(SymTable_remove(oSymTable, acKey) ==
+            &aiVisits[iBound - 1]);
+      }
+   } while (uCursor != 0 && ++iCalls < MAX_CALLS);
+   checkVisits(aiVisits, STABLE_COUNT, 1, 0);
+   checkVisits(aiVisits + STABLE_COUNT, KEY_COUNT - STABLE_COUNT, 0, 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The longest key of testOrderedMaps, with its terminating null
+   character. */
+enum {ORDERED_KEY_SIZE = 40};
+
+/* The state of an ordered walk of testOrderedMaps. */
+
+struct OrderedWalk {
+   /* The keys of the table, whose values point into aiVisits at the
+      same index, and the visit counts. */
+   char (*pacKeys)[ORDERED_KEY_SIZE];
+   int *aiVisits;
+
+   /* A copy of the last key visited, whether one was, and the number
+      of bindings visited out of order or with a wrong key. */
+   char acLast[ORDERED_KEY_SIZE];
+   int iStarted;
+   int iWrong;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Count a visit of the binding with key pcKey and value pvValue in
+   the struct OrderedWalk at pvExtra, checking that the key is that of
+   the binding and comes after the last key visited. */
+
+static void visitOrdered(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct OrderedWalk *psWalk = (struct OrderedWalk*)pvExtra;
+   int iIndex = (int)((int*)pvValue - psWalk->aiVisits);
+
+   if (strcmp(pcKey, psWalk->pacKeys[iIndex]) != 0 ||
+       (psWalk->iStarted && strcmp(psWalk->acLast, pcKey) >= 0))
+      psWalk->iWrong++;
+   strcpy(psWalk->acLast, pcKey);
+   psWalk->iStarted = 1;
+   psWalk->aiVisits[iIndex]++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Walk oSymTable with SymTable_mapPrefix if pcPrefix is not NULL, and
+   otherwise with SymTable_mapRange from pcLow to pcHigh, checking that
+   exactly the bindings of the first iCount of the keys pacKeys whose
+   aiPresent elements are nonzero and that qualify are visited, once
+   each and in order. */
+
+static void checkOrdered(SymTable_T oSymTable,
+   char (*pacKeys)[ORDERED_KEY_SIZE], int aiVisits[],
+   const int aiPresent[], int iCount, const char *pcLow,
+   const char *pcHigh, const char *pcPrefix)
+{
+   struct OrderedWalk sWalk;
+   int iSuccessful;
+   int iExpected;
+   int i;
+
+   sWalk.pacKeys = pacKeys;
+   sWalk.aiVisits = aiVisits;
+   sWalk.iStarted = 0;
+   sWalk.iWrong = 0;
+   if (pcPrefix != NULL)
+      iSuccessful = SymTable_mapPrefix(oSymTable, pcPrefix,
+         visitOrdered, &sWalk);
+   else
+      iSuccessful = SymTable_mapRange(oSymTable, pcLow, pcHigh,
+         visitOrdered, &sWalk);
+   ASSURE(iSuccessful);
+
+   for (i = 0; i < iCount; i++)
+   {
+      iExpected = aiPresent[i] &&
+         (pcPrefix == NULL ||
+          strncmp(pacKeys[i], pcPrefix, strlen(pcPrefix)) == 0) &&
+         (pcLow == NULL || strcmp(pacKeys[i], pcLow) >= 0) &&
+         (pcHigh == NULL || strcmp(pacKeys[i], pcHigh) < 0);
+      if (aiVisits[i] != iExpected)
+         sWalk.iWrong++;
+      aiVisits[i] = 0;
+   }
+   ASSURE(sWalk.iWrong == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check every walk of testOrderedMaps over oSymTable. */
+
+static void checkAllOrdered(SymTable_T oSymTable,
+   char (*pacKeys)[ORDERED_KEY_SIZE], int aiVisits[],
+   const int aiPresent[], int iCount)
+{
+   static const char *apcPrefixes[] = {"", "a", "ab", "abc", "abd",
+      "scope.", "scope.function.local", "scope.function.localVar1",
+      "n", "\xc3", "z"};
+   static const char *apcBounds[] = {NULL, "", "1", "a", "a1", "ab",
+      "ab17", "n\x7f", "scope.function.local5", "\xc3\xa9", "zz"};
+   int iLow;
+   int iHigh;
+   int i;
+
+   for (i = 0; i < (int)(sizeof(apcPrefixes) / sizeof(apcPrefixes[0]));
+        i++)
+      checkOrdered(oSymTable, pacKeys, aiVisits, aiPresent, iCount,
+         NULL, NULL, apcPrefixes[i]);
+
+   /* Every pair of bounds, empty ranges included. */
+   for (iLow = 0;
+        iLow < (int)(sizeof(apcBounds) / sizeof(apcBounds[0]));
+        iLow++)
+      for (iHigh = 0;
+           iHigh < (int)(sizeof(apcBounds) / sizeof(apcBounds[0]));
+           iHigh++)
+         checkOrdered(oSymTable, pacKeys, aiVisits, aiPresent, iCount,
+            apcBounds[iLow], apcBounds[iHigh], NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_mapPrefix() and SymTable_mapRange() functions. */
+
+static void testOrderedMaps(void)
+{
+   enum {STEM_COUNT = 8};
+   enum {NUMBERED_COUNT = 2000};
+   enum {BYTE_COUNT = 255};
+   enum {KEY_COUNT = NUMBERED_COUNT + BYTE_COUNT};
+   static const char *apcStems[STEM_COUNT] = {"", "a", "ab", "abc",
+      "scope.function.local", "scope.function.localVar", "\xc3\xa9t",
+      "zz"};
+   static char acKeys[KEY_COUNT][ORDERED_KEY_SIZE];
+   static int aiVisits[KEY_COUNT];
+   static int aiPresent[KEY_COUNT];
+   SymTable_T oSymTable;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapPrefix() and SymTable_mapRange()\n");
+   printf("functions. No output should appear here:\n");
+   fflush(stdout);
+
+   /* Numbered keys that share long prefixes, some a prefix of
+      others, and keys "n" followed by each nonzero byte, which fill
+      one node. */
+   for (i = 0; i < NUMBERED_COUNT; i++)
+      if (i < STEM_COUNT)
+         sprintf(acKeys[i], "%s", apcStems[i]);
+      else
+         sprintf(acKeys[i], "%s%d", apcStems[i % STEM_COUNT],
+            i / STEM_COUNT);
+   for (i = 0; i < BYTE_COUNT; i++)
+      sprintf(acKeys[NUMBERED_COUNT + i], "n%c", (char)(i + 1));
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   checkAllOrdered(oSymTable, acKeys, aiVisits, aiPresent, KEY_COUNT);
+
+   /* Put the keys in a scattered order. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, acKeys[i * 7 % KEY_COUNT],
+         &aiVisits[i * 7 % KEY_COUNT]);
+      ASSURE(iSuccessful);
+      aiPresent[i * 7 % KEY_COUNT] = 1;
+      if (i == 1 || i == 50)
+         checkAllOrdered(oSymTable, acKeys, aiVisits, aiPresent,
+            KEY_COUNT);
+   }
+   checkAllOrdered(oSymTable, acKeys, aiVisits, aiPresent, KEY_COUNT);
+
+   /* Remove two keys of every three, which empties nodes and shrinks
+      them. */
+   for (i = 0; i < KEY_COUNT; i++)
+      if (i % 3 != 0)
+      {
+         ASSURE(SymTable_remove(oSymTable, acKeys[i]) == &aiVisits[i]);
+         aiPresent[i] = 0;
+      }
+   ASSURE(SymTable_getLength(oSymTable) == (KEY_COUNT + 2) / 3);
+   checkAllOrdered(oSymTable, acKeys, aiVisits, aiPresent, KEY_COUNT);
+
+   /* A copied table is walked alike. */
+   iSuccessful = SymTable_shrinkToFit(oSymTable);
+   ASSURE(iSuccessful);
+   checkAllOrdered(oSymTable, acKeys, aiVisits, aiPresent, KEY_COUNT);
+
+   for (i = 0; i < KEY_COUNT; i += 3)
+      ASSURE(SymTable_remove(oSymTable, acKeys[i]) == &aiVisits[i]);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* See TEST_LOCKED_WALKS above. */
+
+#ifndef TEST_LOCKED_WALKS
+
+/* Check, in the struct LookupWalk at pvExtra, that a prefix walk and
+   a range walk of its table, started while visiting the binding with
+   key pcKey and value pvValue, leave pcKey unchanged and find the
+   binding. */
+
+static void nestedVisit(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct LookupWalk *psWalk = (struct LookupWalk*)pvExtra;
+   char acKey[32];
+   int iCount = 0;
+
+   strcpy(acKey, pcKey);
+   if (! SymTable_mapPrefix(psWalk->oSymTable, "identifier_1",
+          countBindings, &iCount) ||
+       ! SymTable_mapRange(psWalk->oSymTable, pcKey, NULL,
+          countBindings, &iCount))
+      psWalk->iWrong++;
+   if (strcmp(acKey, pcKey) != 0 ||
+       SymTable_get(psWalk->oSymTable, pcKey) != pvValue)
+      psWalk->iWrong++;
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that walks of a table may be started from the pfApply of
+   another walk of it. */
+
+static void testNestedWalks(void)
+{
+   enum {KEY_COUNT = 200};
+   static int aiVisits[KEY_COUNT];
+   struct LookupWalk sWalk;
+   char acKey[32];
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing walks started from pfApply.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sWalk.oSymTable = SymTable_new();
+   ASSURE(sWalk.oSymTable != NULL);
+   sWalk.iWrong = 0;
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "identifier_%d", i);
+      iSuccessful = SymTable_put(sWalk.oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+
+   SymTable_map(sWalk.oSymTable, nestedVisit, &sWalk);
+   iSuccessful = SymTable_mapPrefix(sWalk.oSymTable, "identifier_",
+      nestedVisit, &sWalk);
+   ASSURE(iSuccessful);
+   for (i = 0; i < KEY_COUNT; i++)
+      if (aiVisits[i] != 2)
+         sWalk.iWrong++;
+   ASSURE(sWalk.iWrong == 0);
+
+   SymTable_free(sWalk.oSymTable);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to handle collisions.  This
+   test assumes that a SymTable object is implemented as a hash table,
+   that there are 509 buckets in the hash table, and that the
+   implementation uses the hash function provided in the assignment
+   specification. */
+
+static void testCollisions(void)
+{
+   SymTable_T oSymTable;
+   int iSuccessful;
+   char acCenterField[] = "pitcher";
+   char acCatcher[] = "catcher";
+   char acFirstBase[] = "first base";
+   char acRightField[] = "second base";
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the collision handling of a SymTable object\n");
+   printf("assuming a hash table implementation, and assuming that\n");
+   printf("the implementation uses the hash function from the\n");
+   printf("assignment specification.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Note that strings "250", "469", "947", "1303", and "2016" hash
+      to the same bucket -- bucket 123. */
+
+   iSuccessful = SymTable_put(oSymTable, "250", acCenterField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "469", acCatcher);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "947", acFirstBase);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "1303", acRightField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
+   ASSURE(iSuccessful);
+
+   pcValue = SymTable_get(oSymTable, "250");
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = SymTable_get(oSymTable, "469");
+   ASSURE(pcValue == acCatcher);
+
+   pcValue = SymTable_get(oSymTable, "947");
+   ASSURE(pcValue == acFirstBase);
+
+   pcValue = SymTable_get(oSymTable, "1303");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_get(oSymTable, "2016");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_remove(oSymTable, "947");
+   ASSURE(pcValue == acFirstBase);
+
+   pcValue = SymTable_remove(oSymTable, "2016");
+   ASSURE(pcValue == acRightField);
+
+   pcValue = SymTable_remove(oSymTable, "250");
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = SymTable_get(oSymTable, "469");
+   ASSURE(pcValue == acCatcher);
+
+   pcValue = SymTable_get(oSymTable, "1303");
+   ASSURE(pcValue == acRightField);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to be large, that is, to
+   contain iBindingCount bindings. Write the time consumed to stdout. */
+
+static void testLargeTable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableSmall;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int iSmall;
+   int iLarge;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+   size_t uLength = 0;
+   size_t uLength2;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a potentially large SymTable object.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   /* Note the current time. */
+   iInitialClock = clock();
+
+   /* Create oSymTableSmall, and put a couple of bindings into it. */
+   oSymTableSmall = SymTable_new();
+   ASSURE(oSymTableSmall != NULL);
+   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+   ASSURE(iSuccessful);
+
+   /* Create oSymTable, the primary SymTable object. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Put iBindingCount new bindings into oSymTable.  Each binding's
+      key and value contain the same characters. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
+      ASSURE(pcValue != NULL);
+      strcpy(pcValue, acKey);
+      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      ASSURE(iSuccessful);
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == (size_t)(i+1));
+   }
+
+   /* Get each binding's value, and make sure that it contains
+      the same characters as its key. */
+   iSmall = 0;
+   iLarge = iBindingCount - 1;
+   while (iSmall < iLarge)
+   {
+      /* Get the smallest of the remaining bindings. */
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iSmall++;
+      /* Get the largest of the remaining bindings. */
+      sprintf(acKey, "%d", iLarge);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iLarge--;
+   }
+   /* Get the middle binding -- if there is one. */
+   if (iSmall == iLarge)
+   {
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
    }
 
    /* Remove each binding. Also free each binding's value. */
@@ -954,11 +2581,35 @@ int main(int argc, char *argv[])
    testKeyOwnership();
    testRemove();
    testMap();
+#ifndef TEST_LOCKED_WALKS
+   testMapLookups();
+#endif
    testEmptyTable();
    testEmptyKey();
    testNullValue();
    testLongKey();
    testTableOfTables();
+   testGetOrInsert();
+   testHashed();
+   testGetBatch();
+   testReserve();
+   testStats();
+#ifdef SYMTABLE_PROFILE
+   testProfile();
+#endif
+   testShrink();
+   testSmallTables();
+   testMapParallel();
+   testIterator();
+#ifndef TEST_LOCKED_WALKS
+   testIteratorLookups();
+#endif
+   testSparseTable();
+   testScan();
+   testOrderedMaps();
+#ifndef TEST_LOCKED_WALKS
+   testNestedWalks();
+#endif
    testCollisions();
    testLargeTable(iBindingCount);
 
@@ -0,0 +1,274 @@
+/*--------------------------------------------------------------------*/
+/* workpool.c                                                         */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+/* pthreads and posix_memalign() are POSIX. */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "workpool.h"
+
+#ifndef __GNUC__
+#error "workpool.c needs the GCC __atomic builtins"
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The size in bytes of a cache line, to which shares are padded. */
+enum {CACHE_LINE = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* The tasks of one worker that no worker has taken yet, alone on a
+   cache line. */
+
+struct WorkPoolShare {
+  /* The first task in the high 32 bits and the task after the last in
+     the low 32 bits, so that the owner (at the front) and thieves (at
+     the back) claim tasks with one compare-and-swap. Read and written
+     atomically. */
+  uint64_t uRange;
+
+  /* Padding up to a whole cache line. */
+  char acPadding[CACHE_LINE - sizeof(uint64_t)];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* One run of tasks. */
+
+struct WorkPool {
+  /* The function that runs a task, and its context. */
+  void (*pfTask)(void *pvContext, size_t uTask, size_t uWorker);
+  void *pvContext;
+
+  /* The number of workers, and their shares. */
+  size_t uWorkerCount;
+  struct WorkPoolShare *psaShares;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The argument of a worker thread. */
+
+struct WorkPoolWorker {
+  /* The run, and the number of the worker. */
+  struct WorkPool *psPool;
+  size_t uWorker;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the range of the tasks from uFirst up to but not including
+   uEnd. */
+static uint64_t WorkPool_range(size_t uFirst, size_t uEnd) {
+  assert(uFirst <= uEnd && uEnd <= WORKPOOL_MAX_TASKS);
+
+  return (uint64_t)uFirst << 32 | (uint64_t)uEnd;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first task, and the task after the last, of uRange. */
+static size_t WorkPool_first(uint64_t uRange) {
+  return (size_t)(uRange >> 32);
+}
+
+static size_t WorkPool_end(uint64_t uRange) {
+  return (size_t)(uRange & 0xffffffffu);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Take the first task of psShare, storing its number in *puTask.
+   Return 1 if successful, or 0 if the share is empty. */
+static int WorkPool_take(struct WorkPoolShare *psShare, size_t *puTask)
+{
+  /* The range of the share as last read. */
+  uint64_t uRange;
+
+  assert(psShare != NULL);
+  assert(puTask != NULL);
+
+  uRange = __atomic_load_n(&psShare->uRange, __ATOMIC_ACQUIRE);
+  do {
+    if (WorkPool_first(uRange) >= WorkPool_end(uRange))
+      return 0;
+  } while (! __atomic_compare_exchange_n(&psShare->uRange, &uRange,
+             WorkPool_range(WorkPool_first(uRange) + 1,
+                            WorkPool_end(uRange)),
+             0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  *puTask = WorkPool_first(uRange);
+  return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the back half of the largest share of psPool, other than that
+   of worker uWorker, into the empty share of worker uWorker. Return 1
+   if successful, or 0 if every share is empty. */
+static int WorkPool_steal(struct WorkPool *psPool, size_t uWorker) {
+  /* The share stolen from, and the size of the largest share. */
+  struct WorkPoolShare *psVictim;
+  size_t uLargest;
+
+  /* The range of a share as last read, and the first stolen task. */
+  uint64_t uRange;
+  size_t uMiddle;
+
+  /* Incrementor over the workers. */
+  size_t u;
+
+  assert(psPool != NULL);
+  assert(uWorker < psPool->uWorkerCount);
+
+  for (;;) {
+    psVictim = NULL;
+    uLargest = 0;
+    for (u = 0; u < psPool->uWorkerCount; u++) {
+      uRange = __atomic_load_n(&psPool->psaShares[u].uRange,
+                               __ATOMIC_RELAXED);
+      if (u != uWorker &&
+          WorkPool_end(uRange) > WorkPool_first(uRange) + uLargest) {
+        uLargest = WorkPool_end(uRange) - WorkPool_first(uRange);
+        psVictim = &psPool->psaShares[u];
+      }
+    }
+
+    /* Tasks are never added, so once every share is empty no task is
+       left to take. */
+    if (psVictim == NULL)
+      return 0;
+
+    /* The victim keeps the front half, which its owner is working
+       through. If the victim changed meanwhile, look again. */
+    uRange = __atomic_load_n(&psVictim->uRange, __ATOMIC_ACQUIRE);
+    if (WorkPool_first(uRange) >= WorkPool_end(uRange))
+      continue;
+    uMiddle = WorkPool_first(uRange)
+              + (WorkPool_end(uRange) - WorkPool_first(uRange)) / 2;
+    if (__atomic_compare_exchange_n(&psVictim->uRange, &uRange,
+          WorkPool_range(WorkPool_first(uRange), uMiddle),
+          0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      /* The own share is empty, so no thief can be changing it. */
+      __atomic_store_n(&psPool->psaShares[uWorker].uRange,
+                       WorkPool_range(uMiddle, WorkPool_end(uRange)),
+                       __ATOMIC_RELEASE);
+      return 1;
+    }
+  }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the tasks of the share of worker uWorker of psPool, then steal
+   and run the tasks of other shares until none are left. */
+static void WorkPool_work(struct WorkPool *psPool, size_t uWorker) {
+  /* The task being run. */
+  size_t uTask;
+
+  assert(psPool != NULL);
+
+  do {
+    while (WorkPool_take(&psPool->psaShares[uWorker], &uTask))
+      (*psPool->pfTask)(psPool->pvContext, uTask, uWorker);
+  } while (WorkPool_steal(psPool, uWorker));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The start function of a worker thread, whose struct WorkPoolWorker
+   is at pvWorker. Return NULL. */
+static void *WorkPool_thread(void *pvWorker) {
+  /* The worker. */
+  struct WorkPoolWorker *psWorker = (struct WorkPoolWorker *)pvWorker;
+
+  assert(psWorker != NULL);
+
+  WorkPool_work(psWorker->psPool, psWorker->uWorker);
+  return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void WorkPool_run(size_t uTaskCount, size_t uWorkerCount,
+  void (*pfTask)(void *pvContext, size_t uTask, size_t uWorker),
+  void *pvContext)
+{
+  /* The run. */
+  struct WorkPool sPool;
+
+  /* The memory of the shares, the threads and their arguments, and
+     whether each thread was created. */
+  void *pvShares = NULL;
+  pthread_t *paThreads;
+  struct WorkPoolWorker *psaWorkers;
+  int *paiCreated;
+
+  /* Incrementor over the tasks or the workers. */
+  size_t u;
+
+  assert(pfTask != NULL);
+  assert(uWorkerCount > 0);
+  assert(uTaskCount <= WORKPOOL_MAX_TASKS);
+
+  /* No worker goes without a task. */
+  if (uWorkerCount > uTaskCount)
+    uWorkerCount = uTaskCount;
+
+  paThreads = (pthread_t *)malloc(uWorkerCount * sizeof(pthread_t));
+  psaWorkers = (struct WorkPoolWorker *)
+    malloc(uWorkerCount * sizeof(struct WorkPoolWorker));
+  paiCreated = (int *)malloc(uWorkerCount * sizeof(int));
+  if (uWorkerCount <= 1 || paThreads == NULL || psaWorkers == NULL ||
+      paiCreated == NULL ||
+      posix_memalign(&pvShares, CACHE_LINE,
+                     uWorkerCount * sizeof(struct WorkPoolShare)) != 0)
+  {
+    /* Run every task on the calling thread. */
+    free(paThreads);
+    free(psaWorkers);
+    free(paiCreated);
+    for (u = 0; u < uTaskCount; u++)
+      (*pfTask)(pvContext, u, 0);
+    return;
+  }
+
+  sPool.pfTask = pfTask;
+  sPool.pvContext = pvContext;
+  sPool.uWorkerCount = uWorkerCount;
+  sPool.psaShares = (struct WorkPoolShare *)pvShares;
+
+  /* Split the tasks evenly. */
+  for (u = 0; u < uWorkerCount; u++)
+    sPool.psaShares[u].uRange =
+      WorkPool_range(uTaskCount * u / uWorkerCount,
+                     uTaskCount * (u + 1) / uWorkerCount);
+
+  /* The share of a worker whose thread cannot be created is stolen by
+     the others. */
+  for (u = 1; u < uWorkerCount; u++) {
+    psaWorkers[u].psPool = &sPool;
+    psaWorkers[u].uWorker = u;
+    paiCreated[u] = pthread_create(&paThreads[u], NULL,
+                                   WorkPool_thread, &psaWorkers[u])
+                    == 0;
+  }
+
+  WorkPool_work(&sPool, 0);
+
+  for (u = 1; u < uWorkerCount; u++)
+    if (paiCreated[u])
+      pthread_join(paThreads[u], NULL);
+
+  free(pvShares);
+  free(paThreads);
+  free(psaWorkers);
+  free(paiCreated);
+}
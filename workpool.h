@@ -0,0 +1,37 @@
+/*--------------------------------------------------------------------*/
+/* workpool.h                                                         */
+/* Author: Connor Brown                                               */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+
+#ifndef WORKPOOL_INCLUDED
+#define WORKPOOL_INCLUDED
+
+/* A WorkPool runs numbered tasks on a few threads for the parallel
+   traversals of the SymTable ADT. Each worker starts with an even,
+   contiguous share of the tasks and takes them from the front of its
+   share. A worker whose share is done steals the back half of the
+   largest share left, so uneven tasks (long chains, costly pfApply
+   calls) still keep every worker busy. The calling thread is worker 0,
+   so no threads are kept between runs. */
+
+/*--------------------------------------------------------------------*/
+
+/* The largest number of tasks of one run. */
+enum {WORKPOOL_MAX_TASKS = 0x7fffffff};
+
+/*--------------------------------------------------------------------*/
+
+/* Call pfTask(pvContext, uTask, uWorker) once for each uTask from 0 to
+   uTaskCount - 1, at most WORKPOOL_MAX_TASKS, on uWorkerCount workers,
+   where uWorker is the number, from 0 to uWorkerCount - 1, of the
+   worker that runs the task. Return once every task has run. If
+   threads or memory for them are unavailable, fewer workers, and at
+   least the calling thread, run the tasks. */
+
+void WorkPool_run(size_t uTaskCount, size_t uWorkerCount,
+  void (*pfTask)(void *pvContext, size_t uTask, size_t uWorker),
+  void *pvContext);
+
+#endif